@@ -0,0 +1,152 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <ngon_generator.h>
+
+/*
+    bench_ngon: CPU n-gon generation throughput, no OpenGL needed.
+
+    Compares the push_back loop the tasks used before NgonGenerator (std::cos/std::sin per vertex,
+    mt19937 colors) with every supported NgonGenerator kernel, single- and multithreaded.
+    Reports vertices/sec and the largest position error against a double precision reference as JSON.
+
+    Usage: bench_ngon [--n N]... [--repeat R] [--threads T]
+*/
+
+typedef std::chrono::steady_clock Clock;
+
+struct Case {
+    std::string name;
+    int threads;
+    double seconds;
+    double maxError;
+};
+
+/// @brief The generation loop of Task6 before NgonGenerator (one fan, random colors)
+static void legacyLoop(int n, float radius, std::vector<float>& vertices, std::vector<float>& colors) {
+    static std::mt19937 gen(12345);
+    static std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+
+    vertices.clear();
+    colors.clear();
+
+    for (int i = 0; i <= n; ++i) {
+        float angle = 2.0f * M_PI * i / n;
+        vertices.push_back(radius * cos(angle));
+        vertices.push_back(radius * sin(angle));
+        vertices.push_back(0.0f);
+
+        colors.push_back(dis(gen));
+        colors.push_back(dis(gen));
+        colors.push_back(dis(gen));
+    }
+}
+
+static double maxPositionError(const std::vector<float>& vertices, int n, float radius) {
+    double maxError = 0.0;
+    for (int i = 0; i <= n; ++i) {
+        double angle = 2.0 * M_PI * i / n;
+        double dx = vertices[i * 3] - radius * std::cos(angle);
+        double dy = vertices[i * 3 + 1] - radius * std::sin(angle);
+        maxError = std::max(maxError, std::max(std::fabs(dx), std::fabs(dy)));
+    }
+    return maxError;
+}
+
+template <class F>
+static double bestOf(int repeat, F fn) {
+    double best = 1e30;
+    for (int r = 0; r < repeat; ++r) {
+        Clock::time_point start = Clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    std::vector<int> sizes;
+    int repeat = 5;
+    int threads = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--n") && hasValue) {
+            sizes.push_back(std::max(3, atoi(argv[++i])));
+        } else if (!strcmp(argv[i], "--repeat") && hasValue) {
+            repeat = std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--threads") && hasValue) {
+            threads = std::max(0, atoi(argv[++i]));
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--n N]... [--repeat R] [--threads T]" << std::endl;
+            return 1;
+        }
+    }
+    if (sizes.empty()) {
+        sizes = {1000, 100000, 1000000, 10000000};
+    }
+
+    const float radius = 0.5f;
+    const NgonGenerator::Kernel kernels[] = {NgonGenerator::SCALAR, NgonGenerator::SSE2, NgonGenerator::AVX2};
+
+    std::cout << "{\n  \"results\": [\n";
+    for (size_t s = 0; s < sizes.size(); ++s) {
+        int n = sizes[s];
+        std::vector<Case> cases;
+        std::vector<float> vertices, colors;
+
+        Case legacy;
+        legacy.name = "legacy_push_back";
+        legacy.threads = 1;
+        legacy.seconds = bestOf(repeat, [&]() { legacyLoop(n, radius, vertices, colors); });
+        legacy.maxError = maxPositionError(vertices, n, radius);
+        cases.push_back(legacy);
+
+        for (NgonGenerator::Kernel kernel : kernels) {
+            if (!NgonGenerator::isSupported(kernel)) continue;
+
+            NgonGenerator single(kernel, 1);
+            NgonGenerator parallel(kernel, threads);
+            NgonGenerator* generators[] = {&single, &parallel};
+
+            for (NgonGenerator* generator : generators) {
+                if (generator == &parallel && parallel.getThreads() == 1) continue;
+
+                Case c;
+                c.name = NgonGenerator::kernelName(kernel);
+                c.threads = generator->getThreads();
+                c.seconds = bestOf(repeat, [&]() {
+                    vertices.resize((size_t)(n + 1) * 3);
+                    colors.resize(vertices.size());
+                    generator->corners(vertices.data(), 3, 0, n + 1, n, glm::vec2(0.0f, 0.0f), radius);
+                    generator->randomColors(colors.data(), n + 1, 12345u);
+                });
+                c.maxError = maxPositionError(vertices, n, radius);
+                cases.push_back(c);
+            }
+        }
+
+        for (size_t i = 0; i < cases.size(); ++i) {
+            const Case& c = cases[i];
+            double verticesPerSec = (n + 1) / c.seconds;
+            std::cout << "    {\"n\": " << n
+                      << ", \"generator\": \"" << c.name << "\""
+                      << ", \"threads\": " << c.threads
+                      << ", \"ms\": " << c.seconds * 1000.0
+                      << ", \"vertices_per_sec\": " << verticesPerSec
+                      << ", \"speedup\": " << legacy.seconds / c.seconds
+                      << ", \"max_error\": " << c.maxError
+                      << "}" << (s + 1 < sizes.size() || i + 1 < cases.size() ? "," : "") << "\n";
+        }
+    }
+    std::cout << "  ]\n}\n";
+
+    return 0;
+}
@@ -0,0 +1,248 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include <model.h>
+#include <software_rasterizer.h>
+
+/*
+    bench_raster: SoftwareRasterizer throughput per thread count, no OpenGL needed.
+
+    Draws every task (and every variant of Task5 / Task8) through Model's software backend
+    for each thread count and reports frame times, primitives and pixels per second as JSON.
+    The default thread counts are 1, 2, 4, ... up to std::thread::hardware_concurrency.
+
+    Options are listed by printUsage.
+*/
+
+struct BenchOptions {
+    int frames = 50;
+    int warmup = 3;
+    int width = 1920;
+    int height = 1080;
+    int ngons = 1;
+    bool indexed = false;
+    bool topology = false;
+    bool gpuColors = false;
+    float zoom = 1.0f;
+    std::vector<int> threads; // empty - powers of two up to the hardware threads
+    std::string outPath;
+};
+
+struct BenchResult {
+    std::string label;
+    int task = 0;
+    int variant = 0;
+    int threads = 0;
+    SoftwareRasterizer::Stats stats; // per frame
+    std::vector<double> frameMs;
+};
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedMs(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+/// @brief Nearest-rank percentile of an already sorted sample
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t rank = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+static void renderFrame(Model& model, SoftwareRasterizer& raster) {
+    raster.clear(glm::vec4(0.5f, 0.5f, 0.5f, 1.0f));
+    model.render();
+}
+
+static BenchResult runTask(Model& model, SoftwareRasterizer& raster, const std::string& label, int task,
+                           int variant, const BenchOptions& options) {
+    BenchResult result;
+    result.label = label;
+    result.task = task;
+    result.variant = variant;
+    result.threads = raster.getThreads();
+
+    // Model prints the current Task5/Task8 mode to stdout; keep it out of the JSON
+    std::streambuf* old = std::cout.rdbuf(nullptr);
+    model.setCurrentTask(task);
+    std::cout.rdbuf(old);
+
+    for (int i = 0; i < options.warmup; ++i) {
+        renderFrame(model, raster);
+    }
+
+    raster.resetStats();
+    result.frameMs.reserve(options.frames);
+    for (int i = 0; i < options.frames; ++i) {
+        Clock::time_point start = Clock::now();
+        renderFrame(model, raster);
+        result.frameMs.push_back(elapsedMs(start, Clock::now()));
+    }
+
+    const SoftwareRasterizer::Stats& total = raster.getStats();
+    result.stats.triangles = total.triangles / options.frames;
+    result.stats.lines = total.lines / options.frames;
+    result.stats.points = total.points / options.frames;
+    result.stats.culled = total.culled / options.frames;
+    result.stats.pixels = total.pixels / options.frames;
+    return result;
+}
+
+static void writeJson(std::ostream& out, const BenchOptions& options, const std::vector<BenchResult>& results) {
+    out << "{\n";
+    out << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+    out << "  \"tile_size\": " << SoftwareRasterizer::TILE_SIZE << ",\n";
+    out << "  \"width\": " << options.width << ",\n";
+    out << "  \"height\": " << options.height << ",\n";
+    out << "  \"frames\": " << options.frames << ",\n";
+    out << "  \"ngons\": " << options.ngons << ",\n";
+    out << "  \"indexed\": " << (options.indexed ? "true" : "false") << ",\n";
+    out << "  \"topology\": " << (options.topology ? "true" : "false") << ",\n";
+    out << "  \"gpu_colors\": " << (options.gpuColors ? "true" : "false") << ",\n";
+    out << "  \"view_zoom\": " << options.zoom << ",\n";
+    out << "  \"tasks\": [\n";
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        std::vector<double> sorted = r.frameMs;
+        std::sort(sorted.begin(), sorted.end());
+
+        double median = percentile(sorted, 50.0);
+        double perSec = median > 0.0 ? 1000.0 / median : 0.0;
+
+        out << "    {\"label\": \"" << r.label << "\""
+            << ", \"task\": " << r.task
+            << ", \"variant\": " << r.variant
+            << ", \"threads\": " << r.threads
+            << ", \"triangles\": " << r.stats.triangles
+            << ", \"lines\": " << r.stats.lines
+            << ", \"points\": " << r.stats.points
+            << ", \"culled\": " << r.stats.culled
+            << ", \"pixels\": " << r.stats.pixels
+            << ", \"min_ms\": " << (sorted.empty() ? 0.0 : sorted.front())
+            << ", \"median_ms\": " << median
+            << ", \"p99_ms\": " << percentile(sorted, 99.0)
+            << ", \"mpixels_per_sec\": " << r.stats.pixels * perSec / 1e6
+            << ", \"triangles_per_sec\": " << r.stats.triangles * perSec
+            << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+
+    out << "  ]\n";
+    out << "}\n";
+}
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --threads LIST    comma-separated thread counts (1,2,4,... up to the hardware threads)\n"
+              << "  --frames N        measured frames per task (50)\n"
+              << "  --warmup N        unmeasured frames per task (3)\n"
+              << "  --width W         color buffer width (1920)\n"
+              << "  --height H        color buffer height (1080)\n"
+              << "  --ngons N         n-gons drawn by Task1/Task2/Task6 (1)\n"
+              << "  --indexed         indexed geometry for triangle-list tasks\n"
+              << "  --topology        convert triangle lists to strips/fans with primitive restart\n"
+              << "  --gpu-colors      vertex colors hashed from the vertex index, as the shader does\n"
+              << "  --zoom Z          view zoom of every task, 1 shows [-1, 1] (1)\n"
+              << "  --out FILE        write JSON to FILE instead of stdout" << std::endl;
+}
+
+static bool parseArgs(int argc, char** argv, BenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (!strcmp(arg, "--threads") && hasValue) {
+            std::stringstream list(argv[++i]);
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                options.threads.push_back(std::max(1, atoi(item.c_str())));
+            }
+        } else if (!strcmp(arg, "--frames") && hasValue) {
+            options.frames = std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(arg, "--warmup") && hasValue) {
+            options.warmup = std::max(0, atoi(argv[++i]));
+        } else if (!strcmp(arg, "--width") && hasValue) {
+            options.width = std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(arg, "--height") && hasValue) {
+            options.height = std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(arg, "--ngons") && hasValue) {
+            options.ngons = std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(arg, "--indexed")) {
+            options.indexed = true;
+        } else if (!strcmp(arg, "--topology")) {
+            options.topology = true;
+        } else if (!strcmp(arg, "--gpu-colors")) {
+            options.gpuColors = true;
+        } else if (!strcmp(arg, "--zoom") && hasValue) {
+            options.zoom = (float)atof(argv[++i]);
+        } else if (!strcmp(arg, "--out") && hasValue) {
+            options.outPath = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        return 1;
+    }
+
+    if (options.threads.empty()) {
+        int hardware = (int)std::max(1u, std::thread::hardware_concurrency());
+        for (int threads = 1; threads < hardware; threads *= 2) {
+            options.threads.push_back(threads);
+        }
+        options.threads.push_back(hardware);
+    }
+
+    // Task5 cycles TRIANGLES -> TRIANGLE_STRIP -> TRIANGLE_FAN, Task8 cycles GL_POINT -> GL_LINE
+    const int variants[] = {1, 1, 1, 1, 3, 1, 1, 2, 1};
+
+    std::vector<BenchResult> results;
+    for (int threads : options.threads) {
+        SoftwareRasterizer raster(threads);
+        raster.resize(options.width, options.height);
+
+        // one pass cycles Task5/Task8 through all their variants, the next starts from the first again
+        Model model;
+        model.setSoftwareRasterizer(&raster);
+        model.setIndexedGeometry(options.indexed);
+        model.setNgonCount(options.ngons);
+        model.setGpuColors(options.gpuColors);
+        model.setTopologyOptimization(options.topology);
+        model.setView(glm::vec2(0.0f, 0.0f), options.zoom);
+
+        for (int task = 1; task <= 9; ++task) {
+            for (int variant = 0; variant < variants[task - 1]; ++variant) {
+                std::string label = "task" + std::to_string(task);
+                if (variants[task - 1] > 1) label += (char)('a' + variant);
+                results.push_back(runTask(model, raster, label, task, variant, options));
+            }
+        }
+    }
+
+    if (options.outPath.empty()) {
+        writeJson(std::cout, options, results);
+    } else {
+        std::ofstream out(options.outPath);
+        if (!out.is_open()) {
+            std::cerr << "Could not open " << options.outPath << std::endl;
+            return 1;
+        }
+        writeJson(out, options, results);
+    }
+    return 0;
+}
@@ -0,0 +1,554 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <frame_capture.h>
+#include <functions.h>
+#include <headless.h>
+#include <model.h>
+
+#ifndef SHADER_DIR
+#define SHADER_DIR "../shader"
+#endif
+
+/*
+    bench_render: headless per-task frame-time benchmark.
+
+    Renders every task (and every variant of Task5 / Task8, which cycle on each
+    setCurrentTask call) into an offscreen FBO and reports frame time statistics
+    and draw throughput as JSON.
+
+    Options are listed by printUsage.
+*/
+
+struct BenchOptions {
+    int frames = 200;
+    int warmup = 10;
+    int width = 1920;
+    int height = 1080;
+    bool indexed = false;
+    bool atlas = false;
+    DrawBatch::SubmitMode batch = DrawBatch::MULTI_DRAW;
+    bool procedural = false;
+    bool compute = false;         // procedural n-gons expanded by the compute shader, indirect draw
+    int tessellation = 0;         // compute path: Task6 as center fans split into N^2 triangles each
+    int ngons = 1;
+    bool topology = false;
+    VertexFormat::Format vertexFormat = VertexFormat::FLOAT;
+    bool async = false;           // tasks generated on the build thread while frames keep rendering
+    int thickLines = 0;           // 0 - GL_LINES, 1 - quads with miter joins, 2 - round joins
+    bool gpuColors = false;       // colors hashed in the vertex shader, positions-only vertex buffers
+    std::string programCacheDir;  // empty - compile from source
+    std::string profilePath;      // empty - no per-pass timer queries
+    std::string meshPath;         // empty - tasks only, else the mesh is benchmarked after them
+    size_t meshBudgetMb = 512;
+    float zoom = 1.0f;            // Model::setView for every task
+    float centerX = 0.0f;
+    float centerY = 0.0f;
+    std::string captureDir;       // empty - no capture, else every frame is read back and written there
+    FrameCapture::Format captureFormat = FrameCapture::PNG;
+    int captureSlots = 6;
+    std::string outPath;
+};
+
+struct BenchResult {
+    std::string label;
+    int task = 0;
+    int variant = 0;
+    double switchMs = 0.0;
+    int switchFrames = 0;            // async: frames rendered until the task was shown
+    double switchMaxFrameMs = 0.0;   // async: slowest of those frames
+    size_t geometryAllocations = 0;  // vertex arena (re)allocations caused by the switch
+    int drawsPerFrame = 0;
+    int vertices = 0;
+    int indices = 0;
+    VertexFormat::Format vertexFormat = VertexFormat::FLOAT; // as resolved for the task
+    bool vertexColors = true;        // false if the buffer holds positions only (--gpu-colors)
+    double stateCallsIssued = 0.0;   // per frame, through Model's RenderState
+    double stateCallsElided = 0.0;
+    Stripifier::Report topology = Stripifier::Report(); // triangles == 0 - not converted
+    size_t visibleChunks = 0;        // mesh only: chunks inside the view
+    size_t lineSegments = 0;         // segments drawn by the thick line renderer, 0 with GL_LINES
+    double captureMs = 0.0;          // --capture: render-thread time in FrameCapture::capture per frame
+    uint64_t captureDropped = 0;     // --capture: measured frames not captured
+    std::vector<double> frameMs;
+};
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedMs(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+/// @brief Nearest-rank percentile of an already sorted sample
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t rank = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+/// @brief Model prints the current Task5/Task8 mode to stdout; keep it out of the JSON
+static void setTaskQuiet(Model& model, int task) {
+    std::streambuf* old = std::cout.rdbuf(nullptr);
+    model.setCurrentTask(task);
+    std::cout.rdbuf(old);
+}
+
+static void renderFrame(Model& model, Profiler* profiler, FrameCapture* capture) {
+    if (profiler) profiler->beginFrame();
+    glClearColor(0.5f, 0.5f, 0.5f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    model.render();
+    if (capture) {
+        Profiler::Scope scope(profiler, "capture");
+        capture->capture();
+    }
+    glFinish(); // without it we would only measure command submission
+    if (profiler) profiler->endFrame();
+}
+
+static BenchResult runTask(Model& model, const std::string& label, int task, int variant, 
+                           const BenchOptions& options, Profiler* profiler, FrameCapture* capture) {
+    BenchResult result;
+    result.label = label;
+    result.task = task;
+    result.variant = variant;
+
+    size_t allocationsBefore = model.getGeometryAllocations();
+    glFinish();
+    Clock::time_point switchStart = Clock::now();
+    if (options.async) {
+        // the worker prints Task5/Task8 modes while frames render, keep it out of the JSON
+        std::streambuf* old = std::cout.rdbuf(nullptr);
+        model.setCurrentTask(task);
+        while (model.isBuildPending()) {
+            Clock::time_point frameStart = Clock::now();
+            renderFrame(model, profiler, capture);
+            result.switchMaxFrameMs = std::max(result.switchMaxFrameMs, elapsedMs(frameStart, Clock::now()));
+            result.switchFrames++;
+        }
+        std::cout.rdbuf(old);
+    } else {
+        setTaskQuiet(model, task);
+    }
+    glFinish();
+    result.switchMs = elapsedMs(switchStart, Clock::now());
+    result.geometryAllocations = model.getGeometryAllocations() - allocationsBefore;
+
+    for (int i = 0; i < options.warmup; ++i) {
+        renderFrame(model, profiler, capture);
+    }
+
+    RenderState& state = Model::getRenderState();
+    state.resetCounters();
+    FrameCapture::Stats captureBefore = capture ? capture->getStats() : FrameCapture::Stats();
+
+    result.frameMs.reserve(options.frames);
+    for (int i = 0; i < options.frames; ++i) {
+        Clock::time_point start = Clock::now();
+        renderFrame(model, profiler, capture);
+        result.frameMs.push_back(elapsedMs(start, Clock::now()));
+    }
+    if (capture) {
+        FrameCapture::Stats captureAfter = capture->getStats();
+        result.captureMs = (captureAfter.captureMs - captureBefore.captureMs) / options.frames;
+        result.captureDropped = captureAfter.dropped - captureBefore.dropped;
+    }
+    result.drawsPerFrame = model.getDrawCalls();
+    result.stateCallsIssued = (double)state.getIssuedCalls() / options.frames;
+    result.stateCallsElided = (double)state.getElidedCalls() / options.frames;
+    result.vertices = model.getNumVertices();
+    result.indices = model.getNumIndices();
+    result.vertexFormat = model.getVertexFormat();
+    result.vertexColors = model.hasVertexColors();
+    if (!options.atlas) result.topology = model.getTopologyReport();
+    if (task == Model::MESH_TASK) result.visibleChunks = model.getMesh().getVisibleChunks();
+    result.lineSegments = model.getThickLineSegments();
+
+    return result;
+}
+
+/// @brief Model::loadMesh of --mesh
+struct MeshLoadResult {
+    double ms = 0.0;         // map + upload (resident) or map only (streamed), up to glFinish
+    bool streamed = false;
+    size_t chunks = 0;
+    size_t gpuBytes = 0;
+    size_t fileBytes = 0;
+};
+
+/// @brief Shader program creation measured once per run
+struct StartupResult {
+    double ms = 0.0;         // initialize/initializeNgon return, variants may still be compiling
+    double readyMs = 0.0;    // every variant linked
+    int cacheHits = 0;
+    int cacheMisses = 0;
+};
+
+static void writeJson(std::ostream& out, const BenchOptions& options, const StartupResult& startup,
+                      const MeshLoadResult& meshLoad, const FrameCapture::Stats& capture,
+                      const std::vector<BenchResult>& results) {
+    out << "{\n";
+    out << "  \"renderer\": \"" << (const char*)glGetString(GL_RENDERER) << "\",\n";
+    out << "  \"version\": \"" << (const char*)glGetString(GL_VERSION) << "\",\n";
+    out << "  \"width\": " << options.width << ",\n";
+    out << "  \"height\": " << options.height << ",\n";
+    out << "  \"frames\": " << options.frames << ",\n";
+    out << "  \"indexed\": " << (options.indexed ? "true" : "false") << ",\n";
+    out << "  \"atlas\": " << (options.atlas ? "true" : "false") << ",\n";
+    const char* batchModes[] = {"loop", "multi", "indirect"};
+    out << "  \"batch\": \"" << batchModes[options.batch] << "\",\n";
+    out << "  \"procedural\": " << (options.procedural ? "true" : "false") << ",\n";
+    out << "  \"compute\": " << (options.compute ? "true" : "false") << ",\n";
+    out << "  \"tessellation\": " << options.tessellation << ",\n";
+    out << "  \"ngons\": " << options.ngons << ",\n";
+    out << "  \"topology\": " << (options.topology ? "true" : "false") << ",\n";
+    out << "  \"vertex_format\": \"" << VertexFormat::formatName(options.vertexFormat) << "\",\n";
+    out << "  \"async\": " << (options.async ? "true" : "false") << ",\n";
+    const char* lineModes[] = {"off", "miter", "round"};
+    out << "  \"thick_lines\": \"" << lineModes[options.thickLines] << "\",\n";
+    out << "  \"gpu_colors\": " << (options.gpuColors ? "true" : "false") << ",\n";
+    out << "  \"view_zoom\": " << options.zoom << ",\n";
+    out << "  \"view_center\": [" << options.centerX << ", " << options.centerY << "],\n";
+    out << "  \"program_cache\": " << (options.programCacheDir.empty() ? "false" : "true") << ",\n";
+    out << "  \"startup_ms\": " << startup.ms << ",\n";
+    out << "  \"programs_ready_ms\": " << startup.readyMs << ",\n";
+    out << "  \"program_cache_hits\": " << startup.cacheHits << ",\n";
+    out << "  \"program_cache_misses\": " << startup.cacheMisses << ",\n";
+    if (!options.meshPath.empty()) {
+        out << "  \"mesh\": \"" << options.meshPath << "\",\n";
+        out << "  \"mesh_budget_mb\": " << options.meshBudgetMb << ",\n";
+        out << "  \"mesh_file_bytes\": " << meshLoad.fileBytes << ",\n";
+        out << "  \"mesh_load_ms\": " << meshLoad.ms << ",\n";
+        out << "  \"mesh_streamed\": " << (meshLoad.streamed ? "true" : "false") << ",\n";
+        out << "  \"mesh_chunks\": " << meshLoad.chunks << ",\n";
+        out << "  \"mesh_gpu_bytes\": " << meshLoad.gpuBytes << ",\n";
+    }
+    if (!options.captureDir.empty()) {
+        out << "  \"capture_format\": \"" << FrameCapture::formatName(options.captureFormat) << "\",\n";
+        out << "  \"capture_slots\": " << options.captureSlots << ",\n";
+        out << "  \"capture_frames\": " << capture.captured << ",\n";
+        out << "  \"capture_written\": " << capture.written << ",\n";
+        out << "  \"capture_failed\": " << capture.failed << ",\n";
+        out << "  \"capture_dropped\": " << capture.dropped << ",\n";
+        out << "  \"capture_encode_ms\": " << (capture.written ? capture.encodeMs / capture.written : 0.0) << ",\n";
+    }
+    out << "  \"tasks\": [\n";
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        std::vector<double> sorted = r.frameMs;
+        std::sort(sorted.begin(), sorted.end());
+
+        double total = 0.0;
+        for (double ms : sorted) total += ms;
+        double mean = sorted.empty() ? 0.0 : total / sorted.size();
+        double drawsPerSec = total > 0.0 ? (double)r.drawsPerFrame * sorted.size() / (total / 1000.0) : 0.0;
+
+        out << "    {\"label\": \"" << r.label << "\""
+            << ", \"task\": " << r.task
+            << ", \"variant\": " << r.variant
+            << ", \"switch_ms\": " << r.switchMs;
+        if (options.async) {
+            out << ", \"switch_frames\": " << r.switchFrames
+                << ", \"switch_max_frame_ms\": " << r.switchMaxFrameMs;
+        }
+        out << ", \"geometry_allocations\": " << r.geometryAllocations;
+        if (r.task == Model::MESH_TASK) out << ", \"visible_chunks\": " << r.visibleChunks;
+        if (r.lineSegments > 0) out << ", \"line_segments\": " << r.lineSegments;
+        if (!options.captureDir.empty()) {
+            out << ", \"capture_ms\": " << r.captureMs
+                << ", \"capture_dropped\": " << r.captureDropped;
+        }
+        out << ", \"draws_per_frame\": " << r.drawsPerFrame
+            << ", \"vertices\": " << r.vertices
+            << ", \"indices\": " << r.indices
+            << ", \"vertex_format\": \"" << VertexFormat::formatName(r.vertexFormat) << "\""
+            << ", \"vertex_bytes\": " << r.vertices * VertexFormat::stride(r.vertexFormat, r.vertexColors)
+            << ", \"state_calls_issued\": " << r.stateCallsIssued
+            << ", \"state_calls_elided\": " << r.stateCallsElided
+            << ", \"min_ms\": " << (sorted.empty() ? 0.0 : sorted.front())
+            << ", \"median_ms\": " << percentile(sorted, 50.0)
+            << ", \"p99_ms\": " << percentile(sorted, 99.0)
+            << ", \"mean_ms\": " << mean
+            << ", \"draws_per_sec\": " << drawsPerSec;
+        if (r.topology.triangles > 0) {
+            const Stripifier::Report& t = r.topology;
+            out << ", \"topology\": \"" << Stripifier::topologyName(t.chosen) << "\""
+                << ", \"vertices_per_triangle\": {\"list\": " << t.listVerticesPerTriangle
+                << ", \"strip\": " << t.stripVerticesPerTriangle
+                << ", \"fan\": " << t.fanVerticesPerTriangle << "}"
+                << ", \"acmr\": {\"before\": " << t.acmrBefore
+                << ", \"list\": " << t.listAcmr
+                << ", \"strip\": " << t.stripAcmr
+                << ", \"fan\": " << t.fanAcmr << "}";
+        }
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+
+    out << "  ]\n";
+    out << "}\n";
+}
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --frames N        measured frames per task (200)\n"
+              << "  --warmup N        unmeasured frames per task (10)\n"
+              << "  --width W         offscreen framebuffer width (1920)\n"
+              << "  --height H        offscreen framebuffer height (1080)\n"
+              << "  --indexed         indexed geometry for triangle-list tasks\n"
+              << "  --atlas           draw every task from the prebuilt geometry atlas\n"
+              << "  --batch MODE      multi-range submission: loop, multi (default), indirect\n"
+              << "  --procedural      Task1/Task2/Task6 n-gons from gl_VertexID, one instanced draw\n"
+              << "  --compute         procedural n-gons expanded by a compute shader, one indirect draw (implies --procedural)\n"
+              << "  --tessellation N  with --compute: Task6 as center fans with every triangle split into N^2 (0)\n"
+              << "  --thick-lines J   Task2-Task4 as instanced quads instead of GL_LINES, J: miter or round joins\n"
+              << "  --gpu-colors      vertex colors hashed in the shader from gl_VertexID, not stored in the buffer\n"
+              << "  --ngons N         n-gons drawn by Task1/Task2/Task6 (1)\n"
+              << "  --topology        convert triangle lists to strips/fans with primitive restart\n"
+              << "  --vertex-format F float (default), half, snorm16 or auto\n"
+              << "  --async           generate tasks on the build thread, switch_ms then spans the frames drawn meanwhile\n"
+              << "  --program-cache DIR  load/store linked program binaries in DIR\n"
+              << "  --mesh FILE       also benchmark a .mesh file (mesh_convert) as task \"mesh\"\n"
+              << "  --mesh-budget MB  GPU memory the mesh may keep resident before it is streamed (512)\n"
+              << "  --zoom Z          view zoom of every task, 1 shows [-1, 1] (1)\n"
+              << "  --center X Y      view center (0 0)\n"
+              << "  --profile FILE    per-pass CPU/GPU timings of every frame, CSV if FILE ends in .csv, else JSON\n"
+              << "  --capture DIR     read every frame back through pixel buffers and write it to DIR\n"
+              << "  --capture-format F  png (default) or raw RGBA\n"
+              << "  --capture-slots N frames in flight before captures are dropped (6)\n"
+              << "  --out FILE        write JSON to FILE instead of stdout" << std::endl;
+}
+
+static bool parseArgs(int argc, char** argv, BenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (!strcmp(arg, "--frames") && hasValue) {
+            options.frames = std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(arg, "--warmup") && hasValue) {
+            options.warmup = std::max(0, atoi(argv[++i]));
+        } else if (!strcmp(arg, "--width") && hasValue) {
+            options.width = std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(arg, "--height") && hasValue) {
+            options.height = std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(arg, "--indexed")) {
+            options.indexed = true;
+        } else if (!strcmp(arg, "--atlas")) {
+            options.atlas = true;
+        } else if (!strcmp(arg, "--batch") && hasValue) {
+            const char* mode = argv[++i];
+            if (!strcmp(mode, "loop")) options.batch = DrawBatch::LOOP;
+            else if (!strcmp(mode, "multi")) options.batch = DrawBatch::MULTI_DRAW;
+            else if (!strcmp(mode, "indirect")) options.batch = DrawBatch::INDIRECT;
+            else {
+                std::cerr << "Unknown batch mode: " << mode << std::endl;
+                return false;
+            }
+        } else if (!strcmp(arg, "--procedural")) {
+            options.procedural = true;
+        } else if (!strcmp(arg, "--compute")) {
+            options.procedural = true;
+            options.compute = true;
+        } else if (!strcmp(arg, "--tessellation") && hasValue) {
+            options.tessellation = std::max(0, atoi(argv[++i]));
+        } else if (!strcmp(arg, "--thick-lines") && hasValue) {
+            const char* join = argv[++i];
+            if (!strcmp(join, "miter")) options.thickLines = 1;
+            else if (!strcmp(join, "round")) options.thickLines = 2;
+            else {
+                std::cerr << "Unknown line join: " << join << std::endl;
+                return false;
+            }
+        } else if (!strcmp(arg, "--gpu-colors")) {
+            options.gpuColors = true;
+        } else if (!strcmp(arg, "--ngons") && hasValue) {
+            options.ngons = std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(arg, "--program-cache") && hasValue) {
+            options.programCacheDir = argv[++i];
+        } else if (!strcmp(arg, "--vertex-format") && hasValue) {
+            const char* name = argv[++i];
+            bool known = false;
+            for (int f = VertexFormat::FLOAT; f <= VertexFormat::AUTO; ++f) {
+                if (!strcmp(name, VertexFormat::formatName((VertexFormat::Format)f))) {
+                    options.vertexFormat = (VertexFormat::Format)f;
+                    known = true;
+                }
+            }
+            if (!known) {
+                printUsage(argv[0]);
+                return false;
+            }
+        } else if (!strcmp(arg, "--async")) {
+            options.async = true;
+        } else if (!strcmp(arg, "--topology")) {
+            options.topology = true;
+        } else if (!strcmp(arg, "--mesh") && hasValue) {
+            options.meshPath = argv[++i];
+        } else if (!strcmp(arg, "--mesh-budget") && hasValue) {
+            options.meshBudgetMb = (size_t)std::max(1L, atol(argv[++i]));
+        } else if (!strcmp(arg, "--zoom") && hasValue) {
+            options.zoom = (float)atof(argv[++i]);
+        } else if (!strcmp(arg, "--center") && i + 2 < argc) {
+            options.centerX = (float)atof(argv[++i]);
+            options.centerY = (float)atof(argv[++i]);
+        } else if (!strcmp(arg, "--profile") && hasValue) {
+            options.profilePath = argv[++i];
+        } else if (!strcmp(arg, "--capture") && hasValue) {
+            options.captureDir = argv[++i];
+        } else if (!strcmp(arg, "--capture-format") && hasValue) {
+            const char* name = argv[++i];
+            if (!strcmp(name, "png")) options.captureFormat = FrameCapture::PNG;
+            else if (!strcmp(name, "raw")) options.captureFormat = FrameCapture::RAW;
+            else {
+                std::cerr << "Unknown capture format: " << name << std::endl;
+                return false;
+            }
+        } else if (!strcmp(arg, "--capture-slots") && hasValue) {
+            options.captureSlots = std::max(2, atoi(argv[++i]));
+        } else if (!strcmp(arg, "--out") && hasValue) {
+            options.outPath = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        return 1;
+    }
+
+    if (!InitHeadless(options.width, options.height)) {
+        std::cerr << "Failed to create headless OpenGL context" << std::endl;
+        return 1;
+    }
+
+    std::vector<BenchResult> results;
+    StartupResult startup;
+    MeshLoadResult meshLoad;
+    FrameCapture::Stats captureStats;
+    {
+        Model model;
+        ProgramCache programCache(options.programCacheDir);
+        if (!options.programCacheDir.empty()) model.setProgramCache(&programCache);
+
+        std::streambuf* oldCout = std::cout.rdbuf(nullptr);
+        Clock::time_point start = Clock::now();
+        model.initialize(SHADER_DIR "/vertex_shader.glsl", SHADER_DIR "/fragment_shader.glsl");
+        model.initializeNgon(SHADER_DIR "/ngon_vertex_shader.glsl", SHADER_DIR "/fragment_shader.glsl");
+        if (options.compute) model.initializeCompute(SHADER_DIR "/ngon_compute_shader.glsl");
+        if (options.thickLines) {
+            model.initializeLines(SHADER_DIR "/line_vertex_shader.glsl", SHADER_DIR "/fragment_shader.glsl");
+        }
+        startup.ms = elapsedMs(start, Clock::now());
+        model.finishPrograms();
+        startup.readyMs = elapsedMs(start, Clock::now());
+        startup.cacheHits = programCache.getHits();
+        startup.cacheMisses = programCache.getMisses();
+        std::cout.rdbuf(oldCout);
+
+        model.setIndexedGeometry(options.indexed);
+        model.setBatchMode(options.batch);
+        model.setNgonCount(options.ngons);
+        model.setProceduralNgons(options.procedural);
+        model.setComputeNgons(options.compute);
+        model.setNgonTessellation(options.tessellation);
+        model.setThickLines(options.thickLines != 0, options.thickLines == 2 ? LineRenderer::ROUND : LineRenderer::MITER);
+        model.setGpuColors(options.gpuColors);
+        model.setTopologyOptimization(options.topology);
+        model.setAsyncBuild(options.async);
+        model.setVertexFormat(options.vertexFormat);
+        model.setView(glm::vec2(options.centerX, options.centerY), options.zoom);
+        // frames end with glFinish, a short ring is enough
+        Profiler profiler(2, (size_t)(options.frames + options.warmup) * 16);
+        if (!options.profilePath.empty()) model.setProfiler(&profiler);
+        Profiler* frameProfiler = options.profilePath.empty() ? nullptr : &profiler;
+        FrameCapture capture(options.captureSlots);
+        FrameCapture* frameCapture = nullptr;
+        if (!options.captureDir.empty()) {
+            if (!capture.start(options.captureDir, options.captureFormat, options.width, options.height)) {
+                std::cerr << "Could not capture to " << options.captureDir << std::endl;
+                TerminateHeadless();
+                return 1;
+            }
+            frameCapture = &capture;
+        }
+        if (options.atlas) {
+            std::streambuf* old = std::cout.rdbuf(nullptr);
+            model.setAtlasMode(true);
+            std::cout.rdbuf(old);
+        }
+
+        // Task5 cycles TRIANGLES -> TRIANGLE_STRIP -> TRIANGLE_FAN, Task8 cycles GL_POINT -> GL_LINE
+        const int variants[] = {1, 1, 1, 1, 3, 1, 1, 2, 1};
+
+        for (int task = 1; task <= 9; ++task) {
+            for (int variant = 0; variant < variants[task - 1]; ++variant) {
+                std::string label = "task" + std::to_string(task);
+                if (variants[task - 1] > 1) label += (char)('a' + variant);
+                results.push_back(runTask(model, label, task, variant, options, frameProfiler, frameCapture));
+            }
+        }
+
+        if (!options.meshPath.empty()) {
+            model.setMeshMemoryBudget(options.meshBudgetMb << 20);
+            glFinish();
+            Clock::time_point start = Clock::now();
+            std::streambuf* old = std::cout.rdbuf(nullptr);
+            bool loaded = model.loadMesh(options.meshPath);
+            std::cout.rdbuf(old);
+            glFinish();
+            meshLoad.ms = elapsedMs(start, Clock::now());
+
+            if (loaded) {
+                const MeshStream& mesh = model.getMesh();
+                meshLoad.streamed = mesh.isStreamed();
+                meshLoad.chunks = mesh.getChunkCount();
+                meshLoad.gpuBytes = mesh.getGpuBytes();
+                std::ifstream file(options.meshPath, std::ios::binary | std::ios::ate);
+                meshLoad.fileBytes = (size_t)file.tellg();
+                results.push_back(runTask(model, "mesh", Model::MESH_TASK, 0, options, frameProfiler, frameCapture));
+            } else {
+                std::cerr << "Could not load " << options.meshPath << std::endl;
+            }
+        }
+
+        capture.finish();
+        captureStats = capture.getStats();
+
+        if (frameProfiler) {
+            profiler.flush();
+            const std::string& path = options.profilePath;
+            bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+            if (!(csv ? profiler.writeCsv(path) : profiler.writeJson(path))) {
+                std::cerr << "Could not write " << path << std::endl;
+            }
+        }
+    }
+
+    if (options.outPath.empty()) {
+        writeJson(std::cout, options, startup, meshLoad, captureStats, results);
+    } else {
+        std::ofstream out(options.outPath);
+        if (!out.is_open()) {
+            std::cerr << "Could not open " << options.outPath << std::endl;
+            TerminateHeadless();
+            return 1;
+        }
+        writeJson(out, options, startup, meshLoad, captureStats, results);
+    }
+
+    TerminateHeadless();
+    return 0;
+}
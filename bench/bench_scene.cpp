@@ -0,0 +1,175 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <functions.h>
+#include <headless.h>
+#include <render_state.h>
+#include <scene.h>
+
+#ifndef SHADER_DIR
+#define SHADER_DIR "../shader"
+#endif
+
+/*
+    bench_scene: thousands of independent shapes in one Scene, headless.
+
+    Fills a Scene with random regular n-gons of mixed styles (points, lines, line loops, fans,
+    indexed triangles, wireframe), then every frame removes and re-adds a share of them before
+    drawing, so the suballocator sees steady churn. Reports frame time, draw calls per frame
+    against the shape count, and the buffer statistics (bytes in use, capacity, fragmentation)
+    as JSON.
+
+    Usage: bench_scene [--shapes N] [--frames F] [--churn FRACTION] [--width W] [--height H]
+*/
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedMs(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+/// @brief Adds a random n-gon with one of the styles below
+static Scene::ShapeId addShape(Scene& scene, std::mt19937& gen) {
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_int_distribution<int> corners(3, 12);
+    std::uniform_int_distribution<int> kind(0, 5);
+
+    int n = corners(gen);
+    float x = unit(gen) * 1.8f - 0.9f, y = unit(gen) * 1.8f - 0.9f;
+    float radius = 0.01f + unit(gen) * 0.04f;
+
+    std::vector<float> positions, colors;
+    for (int i = 0; i < n; ++i) {
+        float angle = 2.0f * 3.14159265f * i / n;
+        positions.insert(positions.end(), {x + radius * std::cos(angle), y + radius * std::sin(angle), 0.0f});
+        colors.insert(colors.end(), {unit(gen), unit(gen), unit(gen)});
+    }
+
+    Scene::Style style;
+    std::vector<uint32_t> indices;
+    switch (kind(gen)) {
+        case 0:
+            style.primitive = GL_POINTS;
+            style.pointSize = 4.0f;
+            break;
+        case 1:
+            style.primitive = GL_LINE_LOOP;
+            style.lineWidth = 2.0f;
+            break;
+        case 2:
+            style.primitive = GL_TRIANGLE_FAN;
+            break;
+        case 3:
+            style.primitive = GL_TRIANGLE_FAN;
+            style.flatShading = false;
+            break;
+        case 4:
+            style.primitive = GL_TRIANGLE_FAN;
+            style.polygonMode = GL_LINE;
+            style.lineWidth = 2.0f;
+            break;
+        default:
+            style.primitive = GL_TRIANGLES;
+            for (int i = 1; i + 1 < n; ++i) indices.insert(indices.end(), {0u, (uint32_t)i, (uint32_t)i + 1});
+            break;
+    }
+    return scene.add(style, positions.data(), colors.data(), (size_t)n,
+                     indices.empty() ? nullptr : indices.data(), indices.size());
+}
+
+int main(int argc, char** argv) {
+    int shapeCount = 10000;
+    int frames = 100;
+    double churn = 0.05;
+    int width = 1920, height = 1080;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--shapes") && hasValue) {
+            shapeCount = std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--frames") && hasValue) {
+            frames = std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--churn") && hasValue) {
+            churn = std::min(1.0, std::max(0.0, atof(argv[++i])));
+        } else if (!strcmp(argv[i], "--width") && hasValue) {
+            width = std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--height") && hasValue) {
+            height = std::max(1, atoi(argv[++i]));
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--shapes N] [--frames F] [--churn FRACTION] [--width W] [--height H]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (!InitHeadless(width, height)) {
+        std::cerr << "Failed to create headless OpenGL context" << std::endl;
+        return 1;
+    }
+
+    std::vector<double> frameMs;
+    std::vector<double> churnMs;
+    int drawCalls = 0;
+    Scene::Stats stats;
+    {
+        RenderState state;
+        // small on purpose: the first fill also measures the growth path
+        Scene scene(state, 1024, 1024);
+        scene.initialize(SHADER_DIR "/vertex_shader.glsl", SHADER_DIR "/fragment_shader.glsl");
+
+        std::mt19937 gen(12345);
+        std::vector<Scene::ShapeId> ids;
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < shapeCount; ++i) ids.push_back(addShape(scene, gen));
+        double fillMs = elapsedMs(start, Clock::now());
+
+        int replaced = (int)(shapeCount * churn);
+        for (int frame = 0; frame < frames; ++frame) {
+            start = Clock::now();
+            for (int i = 0; i < replaced; ++i) {
+                size_t slot = gen() % ids.size();
+                scene.remove(ids[slot]);
+                ids[slot] = addShape(scene, gen);
+            }
+            Clock::time_point drawStart = Clock::now();
+            churnMs.push_back(elapsedMs(start, drawStart));
+
+            glClear(GL_COLOR_BUFFER_BIT);
+            drawCalls = scene.draw(glm::vec3(0.0f, 0.0f, 1.0f));
+            glFinish();
+            frameMs.push_back(elapsedMs(drawStart, Clock::now()));
+        }
+        stats = scene.getStats();
+        std::cerr << "fill: " << fillMs << " ms" << std::endl;
+    }
+
+    std::sort(frameMs.begin(), frameMs.end());
+    std::sort(churnMs.begin(), churnMs.end());
+
+    std::cout << "{\n";
+    std::cout << "  \"renderer\": \"" << (const char*)glGetString(GL_RENDERER) << "\",\n";
+    std::cout << "  \"shapes\": " << stats.shapes << ",\n";
+    std::cout << "  \"frames\": " << frames << ",\n";
+    std::cout << "  \"churn\": " << churn << ",\n";
+    std::cout << "  \"median_ms\": " << frameMs[frameMs.size() / 2] << ",\n";
+    std::cout << "  \"churn_median_ms\": " << churnMs[churnMs.size() / 2] << ",\n";
+    std::cout << "  \"draw_calls\": " << drawCalls << ",\n";
+    std::cout << "  \"vertex_bytes\": " << stats.vertexBytes << ",\n";
+    std::cout << "  \"vertex_capacity_bytes\": " << stats.vertexCapacityBytes << ",\n";
+    std::cout << "  \"index_bytes\": " << stats.indexBytes << ",\n";
+    std::cout << "  \"index_capacity_bytes\": " << stats.indexCapacityBytes << ",\n";
+    std::cout << "  \"free_blocks\": " << stats.freeBlocks << ",\n";
+    std::cout << "  \"vertex_fragmentation\": " << stats.vertexFragmentation << ",\n";
+    std::cout << "  \"index_fragmentation\": " << stats.indexFragmentation << ",\n";
+    std::cout << "  \"grows\": " << stats.grows << "\n";
+    std::cout << "}" << std::endl;
+
+    TerminateHeadless();
+    return 0;
+}
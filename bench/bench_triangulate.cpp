@@ -0,0 +1,149 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <triangulator.h>
+
+/*
+    bench_triangulate: Triangulator throughput on concave outlines, no OpenGL needed.
+
+    Outlines: the Task4 shape (8 corners), star polygons (alternating radius, every other corner reflex)
+    and combs (teeth up, every valley is a merge vertex for the sweep) from 16 to 1M corners.
+    Every result is checked: n - 2 triangles, all with the outline's winding, areas summing to the outline's area.
+
+    Usage: bench_triangulate [--max N] [--ear-max N] [--repeat R]
+*/
+
+typedef std::chrono::steady_clock Clock;
+
+static std::vector<glm::vec2> task4Outline() {
+    return {
+        {-0.7f, 0.8f}, {0.7f, 0.8f}, {0.2f, 0.5f}, {0.2f, 0.0f},
+        {0.6f, 0.0f}, {0.6f, -0.4f}, {-0.6f, -0.4f}, {-0.1358f, 0.2985f},
+    };
+}
+
+static std::vector<glm::vec2> starOutline(int n) {
+    std::vector<glm::vec2> outline(n);
+    for (int i = 0; i < n; ++i) {
+        double angle = 2.0 * M_PI * i / n;
+        double radius = (i % 2 == 0) ? 0.9 : 0.4 + 0.3 * ((i * 7919) % 101) / 100.0;
+        outline[i] = glm::vec2((float)(radius * std::cos(angle)), (float)(radius * std::sin(angle)));
+    }
+    return outline;
+}
+
+static std::vector<glm::vec2> combOutline(int n) {
+    // counter-clockwise: bottom edge left to right, then teeth from right to left
+    int teeth = std::max(1, (n - 2) / 2);
+    std::vector<glm::vec2> outline;
+    outline.reserve(n);
+    outline.push_back(glm::vec2(-1.0f, -1.0f));
+    outline.push_back(glm::vec2(1.0f, -1.0f));
+    for (int t = teeth - 1; t >= 0 && (int)outline.size() < n; --t) {
+        float x = -1.0f + 2.0f * (t + 1) / teeth;
+        float height = 0.5f + 0.4f * (float)((t * 7919) % 101) / 100.0f;
+        outline.push_back(glm::vec2(x - 1.0f / teeth, height));
+        if ((int)outline.size() < n) outline.push_back(glm::vec2(x - 2.0f / teeth, -0.5f));
+    }
+    return outline;
+}
+
+static double signedArea(const std::vector<glm::vec2>& outline) {
+    double area = 0.0;
+    for (size_t i = 0; i < outline.size(); ++i) {
+        const glm::vec2& a = outline[i];
+        const glm::vec2& b = outline[(i + 1) % outline.size()];
+        area += (double)a.x * b.y - (double)b.x * a.y;
+    }
+    return area * 0.5;
+}
+
+static bool validate(const std::vector<glm::vec2>& outline, const std::vector<glm::ivec3>& triangles) {
+    if (triangles.size() != outline.size() - 2) return false;
+
+    double area = signedArea(outline);
+    double sum = 0.0;
+    for (const auto& tri : triangles) {
+        glm::dvec2 a(outline[tri.x]), b(outline[tri.y]), c(outline[tri.z]);
+        double triangleArea = 0.5 * ((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x));
+        if (triangleArea * area < 0.0) return false;
+        sum += triangleArea;
+    }
+    return std::fabs(sum - area) <= 1e-6 * std::fabs(area);
+}
+
+int main(int argc, char** argv) {
+    int maxVertices = 1 << 20;
+    int earMax = 1 << 14;
+    int repeat = 3;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--max") && hasValue) {
+            maxVertices = std::max(8, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--ear-max") && hasValue) {
+            earMax = std::max(0, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--repeat") && hasValue) {
+            repeat = std::max(1, atoi(argv[++i]));
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--max N] [--ear-max N] [--repeat R]" << std::endl;
+            return 1;
+        }
+    }
+
+    struct Shape {
+        std::string name;
+        std::vector<glm::vec2> outline;
+    };
+    std::vector<Shape> shapes;
+    shapes.push_back({"task4", task4Outline()});
+    for (int n = 16; n <= maxVertices; n *= 16) {
+        shapes.push_back({"star", starOutline(n)});
+        shapes.push_back({"comb", combOutline(n)});
+    }
+
+    const Triangulator::Method methods[] = {Triangulator::EAR_CLIPPING, Triangulator::MONOTONE, Triangulator::AUTO};
+    bool allValid = true;
+    bool first = true;
+
+    std::cout << "{\n  \"ear_clipping_max_vertices\": " << Triangulator::EAR_CLIPPING_MAX_VERTICES
+              << ",\n  \"results\": [\n";
+
+    for (const Shape& shape : shapes) {
+        size_t n = shape.outline.size();
+        for (Triangulator::Method method : methods) {
+            Triangulator triangulator(method);
+            if (triangulator.methodFor(n) == Triangulator::EAR_CLIPPING && (int)n > earMax) continue;
+
+            std::vector<glm::ivec3> triangles;
+            double best = 1e30;
+            for (int r = 0; r < repeat; ++r) {
+                Clock::time_point start = Clock::now();
+                triangulator.triangulate(shape.outline, triangles);
+                best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+            }
+
+            bool valid = validate(shape.outline, triangles);
+            allValid = allValid && valid;
+
+            std::cout << (first ? "" : ",\n")
+                      << "    {\"shape\": \"" << shape.name << "\""
+                      << ", \"vertices\": " << n
+                      << ", \"method\": \"" << Triangulator::methodName(method) << "\""
+                      << ", \"used\": \"" << Triangulator::methodName(triangulator.methodFor(n)) << "\""
+                      << ", \"ms\": " << best * 1000.0
+                      << ", \"triangles_per_sec\": " << triangles.size() / best
+                      << ", \"valid\": " << (valid ? "true" : "false") << "}";
+            first = false;
+        }
+    }
+    std::cout << "\n  ]\n}\n";
+
+    return allValid ? 0 : 2;
+}
@@ -0,0 +1,161 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <functions.h>
+#include <headless.h>
+#include <vertex_format.h>
+
+#ifndef SHADER_DIR
+#define SHADER_DIR "../shader"
+#endif
+
+/*
+    bench_vertex_format: cost of every VertexFormat layout on a large mesh, headless.
+
+    For N random 2D vertices (z = 0, positions in [-1, 1], colors in [0, 1]) reports per format:
+    pack time on the CPU, upload time and bandwidth of glBufferData (+ glFinish), and the vertex
+    fetch cost: drawing every vertex as a point with GL_RASTERIZER_DISCARD, so only attribute fetch
+    and the vertex shader run. Reports JSON.
+
+    Usage: bench_vertex_format [--n N]... [--repeat R]
+*/
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedMs(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+struct Case {
+    size_t n;
+    VertexFormat::Format format;
+    size_t bytes;
+    double packMs;
+    double uploadMs;
+    double fetchMs;
+};
+
+static Case runCase(size_t n, VertexFormat::Format format, const std::vector<float>& vertices,
+                    const std::vector<float>& colors, GLuint program, int repeat) {
+    Case result;
+    result.n = n;
+    result.format = VertexFormat::resolve(format, vertices.data(), n);
+    result.bytes = n * VertexFormat::stride(result.format);
+    result.packMs = result.uploadMs = result.fetchMs = 1e30;
+
+    std::vector<char> packed(result.bytes);
+    GLuint vao = 0, vbo = 0;
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glUseProgram(program);
+    glEnable(GL_RASTERIZER_DISCARD);
+
+    // best of `repeat`, the minimum is the least disturbed by the rest of the system
+    for (int r = 0; r < repeat; ++r) {
+        Clock::time_point start = Clock::now();
+        VertexFormat::pack(result.format, vertices.data(), colors.data(), n, packed.data());
+        result.packMs = std::min(result.packMs, elapsedMs(start, Clock::now()));
+
+        glFinish();
+        start = Clock::now();
+        glBufferData(GL_ARRAY_BUFFER, packed.size(), packed.data(), GL_STATIC_DRAW);
+        glFinish();
+        result.uploadMs = std::min(result.uploadMs, elapsedMs(start, Clock::now()));
+
+        VertexFormat::setAttributes(result.format);
+        glDrawArrays(GL_POINTS, 0, (GLsizei)n); // warm up
+        glFinish();
+        start = Clock::now();
+        glDrawArrays(GL_POINTS, 0, (GLsizei)n);
+        glFinish();
+        result.fetchMs = std::min(result.fetchMs, elapsedMs(start, Clock::now()));
+    }
+
+    glDisable(GL_RASTERIZER_DISCARD);
+    glBindVertexArray(0);
+    glDeleteBuffers(1, &vbo);
+    glDeleteVertexArrays(1, &vao);
+    return result;
+}
+
+int main(int argc, char** argv) {
+    std::vector<size_t> sizes;
+    int repeat = 5;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--n") && hasValue) {
+            sizes.push_back((size_t)std::max(1L, atol(argv[++i])));
+        } else if (!strcmp(argv[i], "--repeat") && hasValue) {
+            repeat = std::max(1, atoi(argv[++i]));
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--n N]... [--repeat R]" << std::endl;
+            return 1;
+        }
+    }
+    if (sizes.empty()) sizes = {1 << 20, 1 << 23};
+
+    if (!InitHeadless(64, 64)) {
+        std::cerr << "Failed to create headless OpenGL context" << std::endl;
+        return 1;
+    }
+
+    GLuint program = createShaderProgram(SHADER_DIR "/vertex_shader.glsl", SHADER_DIR "/fragment_shader.glsl");
+    if (program == 0) {
+        TerminateHeadless();
+        return 1;
+    }
+
+    std::vector<Case> cases;
+    std::mt19937 gen(12345);
+    std::uniform_real_distribution<float> position(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> color(0.0f, 1.0f);
+
+    for (size_t n : sizes) {
+        std::vector<float> vertices(n * 3);
+        std::vector<float> colors(n * 3);
+        for (size_t i = 0; i < n; ++i) {
+            vertices[i * 3] = position(gen);
+            vertices[i * 3 + 1] = position(gen);
+            vertices[i * 3 + 2] = 0.0f;
+            colors[i * 3] = color(gen);
+            colors[i * 3 + 1] = color(gen);
+            colors[i * 3 + 2] = color(gen);
+        }
+
+        for (VertexFormat::Format format : {VertexFormat::FLOAT, VertexFormat::HALF, VertexFormat::SNORM16}) {
+            cases.push_back(runCase(n, format, vertices, colors, program, repeat));
+        }
+    }
+
+    std::cout << "{\n";
+    std::cout << "  \"renderer\": \"" << (const char*)glGetString(GL_RENDERER) << "\",\n";
+    std::cout << "  \"repeat\": " << repeat << ",\n";
+    std::cout << "  \"cases\": [\n";
+    for (size_t i = 0; i < cases.size(); ++i) {
+        const Case& c = cases[i];
+        double megabytes = c.bytes / (1024.0 * 1024.0);
+        std::cout << "    {\"n\": " << c.n
+                  << ", \"format\": \"" << VertexFormat::formatName(c.format) << "\""
+                  << ", \"stride\": " << VertexFormat::stride(c.format)
+                  << ", \"mb\": " << megabytes
+                  << ", \"pack_ms\": " << c.packMs
+                  << ", \"upload_ms\": " << c.uploadMs
+                  << ", \"upload_mb_per_s\": " << (c.uploadMs > 0.0 ? megabytes / (c.uploadMs / 1000.0) : 0.0)
+                  << ", \"fetch_ms\": " << c.fetchMs
+                  << ", \"vertices_per_sec\": " << (c.fetchMs > 0.0 ? c.n / (c.fetchMs / 1000.0) : 0.0)
+                  << "}" << (i + 1 < cases.size() ? "," : "") << "\n";
+    }
+    std::cout << "  ]\n}" << std::endl;
+
+    glDeleteProgram(program);
+    TerminateHeadless();
+    return 0;
+}
@@ -1,27 +1,41 @@
 #version 460 core
 out vec4 FragColor;
 
+// FLAT_SHADING and POINT_AA are defined per program variant (ShaderVariants, Model::currentVariant),
+// THICK_LINE when linked with line_vertex_shader.glsl
+
 in vec3 ourColor;
 flat in vec3 flatColor; 
 
-uniform int u_flatMode;
-uniform int u_smoothMode;
+#ifdef THICK_LINE
+noperspective in vec2 linePosition;
+flat in vec3 lineShape; // length, half width, round ends (1 - start, 2 - end)
+#endif
 
 void main() {
-    
-    if (u_flatMode == 1) {
-        FragColor = vec4(flatColor, 1.0); 
-    } else {
-        FragColor = vec4(ourColor, 1.0);  
-    }
-    
-    if (u_smoothMode == 1) {
-        if (gl_PointCoord.x > 0.0) {
-            float dist = length(gl_PointCoord - 0.5);
-            float alpha = 1.0 - smoothstep(0.5, 0.5, dist);
-            if (alpha <= 0.0) discard;
-            FragColor.a = alpha;
-        }
-    }
+
+#ifdef FLAT_SHADING
+    FragColor = vec4(flatColor, 1.0); 
+#else
+    FragColor = vec4(ourColor, 1.0);  
+#endif
+
+#ifdef POINT_AA
+    // round point with a soft edge about one pixel wide
+    // (smoothstep(0.5, 0.5, dist) is undefined: edge0 must be below edge1)
+    float dist = length(gl_PointCoord - 0.5);
+    float alpha = 1.0 - smoothstep(0.5 - fwidth(dist), 0.5, dist);
+    if (alpha <= 0.0) discard;
+    FragColor.a = alpha;
+#endif
+
+#ifdef THICK_LINE
+    // an end extended past the segment is cut to a half disc
+    int roundEnds = int(lineShape.z);
+    bool beforeStart = linePosition.x < 0.0;
+    float beyond = beforeStart ? -linePosition.x : linePosition.x - lineShape.x;
+    bool round = (roundEnds & (beforeStart ? 1 : 2)) != 0;
+    if (round && beyond > 0.0 && length(vec2(beyond, linePosition.y)) > lineShape.y) discard;
+#endif
 
 }
\ No newline at end of file
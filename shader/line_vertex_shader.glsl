@@ -0,0 +1,76 @@
+#version 460 core
+// Thick lines as screen-space quads: one instance per segment (LineRenderer::Segment), the four
+// corners of a triangle strip from gl_VertexID. An end shared with the neighboring segment gets a
+// miter join; ends without a neighbor, joins sharper than MITER_LIMIT and every end with u_join = 1
+// are extended by half the width and cut to a half disc in the fragment shader.
+layout (location = 0) in vec2 aPrev;       // start of the previous segment, == aStart if there is none
+layout (location = 1) in vec2 aStart;
+layout (location = 2) in vec2 aEnd;
+layout (location = 3) in vec2 aNext;       // end of the next segment, == aEnd if there is none
+layout (location = 4) in vec4 aStartColor;
+layout (location = 5) in vec4 aEndColor;
+layout (location = 6) in float aWidth;     // in multiples of the line width
+
+layout (location = 1) uniform vec3 u_view = vec3(0.0, 0.0, 1.0); // as in vertex_shader.glsl
+layout (location = 2) uniform vec3 u_line;   // viewport width, height and line width, in pixels
+layout (location = 3) uniform int u_join;    // 0 - miter, 1 - round
+
+out vec3 ourColor;
+flat out vec3 flatColor;
+noperspective out vec2 linePosition; // pixels along the segment from its start and across from its axis
+flat out vec3 lineShape;             // length, half width, round ends (1 - start, 2 - end)
+
+const float MITER_LIMIT = 4.0; // longest miter in half widths
+
+vec2 toPixels(vec2 position) {
+    return (position - u_view.xy) * u_view.z * 0.5 * u_line.xy;
+}
+
+// offset of the corner on the +normal side of one end of the segment, round set for a round end
+vec2 endOffset(vec2 dir, vec2 normal, vec2 neighborDir, float halfWidth, float outward, out bool round) {
+    round = true;
+    if (u_join == 0 && dot(neighborDir, neighborDir) > 0.0) {
+        vec2 sum = normalize(neighborDir) + dir;
+        if (dot(sum, sum) > 1e-6) {
+            vec2 tangent = normalize(sum);
+            vec2 miter = vec2(-tangent.y, tangent.x);
+            float cosine = dot(miter, normal); // miter length is halfWidth / cosine
+            if (cosine * MITER_LIMIT > 1.0) {
+                round = false;
+                return miter * (halfWidth / cosine);
+            }
+        }
+    }
+    return normal * halfWidth + dir * (halfWidth * outward);
+}
+
+void main() {
+    vec2 start = toPixels(aStart);
+    vec2 end = toPixels(aEnd);
+    float len = length(end - start);
+    vec2 dir = len > 0.0 ? (end - start) / len : vec2(1.0, 0.0);
+    vec2 normal = vec2(-dir.y, dir.x);
+    float halfWidth = 0.5 * max(aWidth * u_line.z, 1.0);
+
+    // both ends on every corner: the flat lineShape comes from whichever corner is provoking
+    bool roundStart, roundEnd;
+    vec2 startCorner = endOffset(dir, normal, start - toPixels(aPrev), halfWidth, -1.0, roundStart);
+    vec2 endCorner = endOffset(dir, normal, toPixels(aNext) - end, halfWidth, 1.0, roundEnd);
+
+    bool atEnd = gl_VertexID >= 2;
+    bool round = atEnd ? roundEnd : roundStart;
+    float side = (gl_VertexID & 1) == 0 ? -1.0 : 1.0;
+    vec2 offset = atEnd ? endCorner : startCorner;
+    // mirrored to the -normal side: a miter flips as a whole, a round end keeps its extension
+    offset = round ? dir * dot(offset, dir) + normal * (dot(offset, normal) * side) : offset * side;
+
+    vec2 position = (atEnd ? end : start) + offset;
+    gl_Position = vec4(position / (0.5 * u_line.xy), 0.0, 1.0);
+
+    linePosition = vec2(dot(position - start, dir), dot(position - start, normal));
+    lineShape = vec3(len, halfWidth, (roundStart ? 1.0 : 0.0) + (roundEnd ? 2.0 : 0.0));
+
+    vec3 color = atEnd ? aEndColor.rgb : aStartColor.rgb;
+    ourColor = color;
+    flatColor = aEndColor.rgb; // the last vertex of a segment, as with GL_LINES
+}
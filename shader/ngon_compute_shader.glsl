@@ -0,0 +1,121 @@
+#version 460 core
+// Regular n-gons expanded on the GPU: one invocation per polygon reserves its vertices with an
+// atomic counter, writes them in the layout of vertex_shader.glsl (x, y, z, r, g, b floats) and
+// the indirect draw command of the polygon. Commands stay in polygon order, so the drawing order
+// does not depend on which invocation reserved its vertices first.
+layout (local_size_x = 64) in;
+
+// 5 words per polygon, the per-instance attributes of ngon_vertex_shader.glsl:
+// center x, y, radius, sides (int bits), color seed (uint bits, 0 - white)
+layout (std430, binding = 0) readonly buffer Polygons { float polygons[]; };
+layout (std430, binding = 1) writeonly buffer Vertices { float vertices[]; };
+// DrawArraysIndirectCommand per polygon: count, instanceCount, first, baseInstance
+layout (std430, binding = 2) writeonly buffer Commands { uint commands[]; };
+// rejected: polygons that did not fit into u_capacity, read back by ComputeGenerator
+layout (std430, binding = 3) buffer Counter { uint nextVertex; uint rejected; };
+
+layout (location = 0) uniform int u_expansion;    // 0 - POINTS, 1 - LINES, 2 - TRIANGLE_FAN, 3 - TRIANGLES
+layout (location = 1) uniform int u_subdivisions; // TRIANGLES: every center-fan triangle split into u_subdivisions^2
+layout (location = 2) uniform uint u_polygons;
+layout (location = 3) uniform uint u_capacity;    // vertices in the buffer, polygons past it are not drawn
+
+const float TWO_PI = 6.28318530718;
+
+uint hash(uint x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+uint seed;
+vec2 center;
+float radius;
+int sides;
+
+vec2 corner(int k) {
+    float angle = TWO_PI * float(k) / float(sides);
+    return center + radius * vec2(cos(angle), sin(angle));
+}
+
+// `local` numbers the vertex inside its polygon, as gl_VertexID does in ngon_vertex_shader.glsl
+void emit(uint index, uint local, vec2 position) {
+    vec3 color = vec3(1.0);
+    if (seed != 0u) {
+        uint h = hash(seed ^ hash(local));
+        color = vec3(h & 0xFFu, (h >> 8) & 0xFFu, (h >> 16) & 0xFFu) / 255.0;
+    }
+    uint base = index * 6u;
+    vertices[base] = position.x;
+    vertices[base + 1u] = position.y;
+    vertices[base + 2u] = 0.0;
+    vertices[base + 3u] = color.r;
+    vertices[base + 4u] = color.g;
+    vertices[base + 5u] = color.b;
+}
+
+// point (row, column) of the subdivided triangle center, a, b: row 0 is the center, row n the edge a-b
+vec2 lattice(vec2 a, vec2 b, int row, int column, int n) {
+    return center + (float(row - column) * (a - center) + float(column) * (b - center)) / float(n);
+}
+
+void main() {
+    uint polygon = gl_GlobalInvocationID.x;
+    if (polygon >= u_polygons) return;
+
+    uint word = polygon * 5u;
+    center = vec2(polygons[word], polygons[word + 1u]);
+    radius = polygons[word + 2u];
+    sides = max(floatBitsToInt(polygons[word + 3u]), 3);
+    seed = floatBitsToUint(polygons[word + 4u]);
+
+    int n = max(u_subdivisions, 1);
+    uint count = uint(sides);
+    if (u_expansion == 1) count = uint(2 * sides);
+    else if (u_expansion == 2) count = uint(sides + 1);
+    else if (u_expansion == 3) count = uint(3 * sides * n * n);
+
+    // compare-and-swap instead of atomicAdd: a polygon that does not fit leaves the counter alone,
+    // so it cannot wrap around and smaller polygons after it still get the space that is left
+    uint first = atomicAdd(nextVertex, 0u);
+    bool fits = false;
+    while (first + count <= u_capacity && first + count >= first) {
+        uint seen = atomicCompSwap(nextVertex, first, first + count);
+        if (seen == first) { fits = true; break; }
+        first = seen;
+    }
+    if (!fits) atomicAdd(rejected, 1u);
+    commands[polygon * 4u] = fits ? count : 0u;
+    commands[polygon * 4u + 1u] = 1u;
+    commands[polygon * 4u + 2u] = fits ? first : 0u;
+    commands[polygon * 4u + 3u] = 0u;
+    if (!fits) return;
+
+    if (u_expansion == 0) {
+        for (int k = 0; k < sides; ++k) emit(first + uint(k), uint(k), corner(k));
+    } else if (u_expansion == 1) {
+        // segment k is corner k -> corner k + 1
+        for (int k = 0; k < 2 * sides; ++k) emit(first + uint(k), uint(k), corner(k / 2 + k % 2));
+    } else if (u_expansion == 2) {
+        for (int k = 0; k <= sides; ++k) emit(first + uint(k), uint(k), corner(k));
+    } else {
+        // every sector center, corner k, corner k + 1 as n rows of 2 * row + 1 triangles, counter-clockwise
+        uint local = 0u;
+        for (int k = 0; k < sides; ++k) {
+            vec2 a = corner(k), b = corner(k + 1);
+            for (int row = 0; row < n; ++row) {
+                for (int column = 0; column <= row; ++column) {
+                    emit(first + local, local, lattice(a, b, row, column, n)); local++;
+                    emit(first + local, local, lattice(a, b, row + 1, column, n)); local++;
+                    emit(first + local, local, lattice(a, b, row + 1, column + 1, n)); local++;
+                    if (column == row) continue;
+                    emit(first + local, local, lattice(a, b, row, column, n)); local++;
+                    emit(first + local, local, lattice(a, b, row + 1, column + 1, n)); local++;
+                    emit(first + local, local, lattice(a, b, row, column + 1, n)); local++;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#version 460 core
+// Regular n-gons without vertex data: corner positions come from gl_VertexID,
+// everything else from per-instance attributes.
+layout (location = 0) in vec2 iCenter;
+layout (location = 1) in float iRadius;
+layout (location = 2) in int iSides;
+layout (location = 3) in uint iSeed;    // 0 - white, else seed of per-vertex colors
+
+layout (location = 0) uniform int u_primitive; // 0 - POINTS, 1 - LINES, 2 - TRIANGLE_FAN, same location in every variant
+layout (location = 1) uniform vec3 u_view = vec3(0.0, 0.0, 1.0); // as in vertex_shader.glsl
+
+out vec3 ourColor;
+flat out vec3 flatColor;
+
+const float TWO_PI = 6.28318530718;
+
+uint hash(uint x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+void main() {
+    int corner = gl_VertexID;
+    bool unused = false;
+
+    if (u_primitive == 1) {
+        // segment k is corner k -> corner k + 1
+        corner = gl_VertexID / 2 + gl_VertexID % 2;
+        unused = gl_VertexID >= 2 * iSides;
+    } else if (u_primitive == 2) {
+        // extra vertices of smaller polygons collapse onto the last one: zero-area triangles
+        corner = min(gl_VertexID, iSides);
+    } else {
+        unused = gl_VertexID >= iSides;
+    }
+
+    float angle = TWO_PI * float(corner) / float(iSides);
+    vec2 pos = iCenter + iRadius * vec2(cos(angle), sin(angle));
+
+    // z outside [-w, w]: clipped away
+    gl_Position = unused ? vec4(0.0, 0.0, 2.0, 1.0) : vec4((pos - u_view.xy) * u_view.z, 0.0, 1.0);
+
+    vec3 color = vec3(1.0);
+    if (iSeed != 0u) {
+        uint h = hash(iSeed ^ hash(uint(gl_VertexID)));
+        color = vec3(h & 0xFFu, (h >> 8) & 0xFFu, (h >> 16) & 0xFFu) / 255.0;
+    }
+
+    ourColor = color;
+    flatColor = color;
+}
@@ -2,11 +2,32 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aColor;
 
+layout (location = 1) uniform vec3 u_view = vec3(0.0, 0.0, 1.0); // center x, y and zoom, set by Model
+// 0 - aColor, else a color per vertex from the seed and gl_VertexID (Model::setGpuColors),
+// the same hash as NgonGenerator::randomColors
+layout (location = 2) uniform int u_colorSeed = 0;
+
 out vec3 ourColor;
 flat out vec3 flatColor;
 
+uint hash(uint x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
 void main() {
-    gl_Position = vec4(aPos, 1.0);
-    ourColor = aColor;
-    flatColor = aColor;    
-}
\ No newline at end of file
+    gl_Position = vec4((aPos.xy - u_view.xy) * u_view.z, aPos.z, 1.0);
+
+    vec3 color = aColor;
+    if (u_colorSeed != 0) {
+        // indexed draws pass the index: a shared vertex keeps one color, as with the attribute
+        uint h = hash(uint(u_colorSeed) ^ hash(uint(gl_VertexID)));
+        color = vec3(h & 0xFFu, (h >> 8) & 0xFFu, (h >> 16) & 0xFFu) / 255.0;
+    }
+    ourColor = color;
+    flatColor = color;
+}
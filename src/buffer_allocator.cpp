@@ -0,0 +1,96 @@
+#include <buffer_allocator.h>
+#include <iterator>
+
+BufferAllocator::BufferAllocator(size_t capacity) {
+    this->capacity = 0;
+    used = 0;
+    grow(capacity);
+}
+
+size_t BufferAllocator::allocate(size_t size) {
+    if (size == 0) return INVALID;
+
+    auto fit = freeBySize.lower_bound(size);
+    if (fit == freeBySize.end()) return INVALID;
+
+    size_t offset = fit->second;
+    size_t blockSize = fit->first;
+    eraseFree(freeByOffset.find(offset));
+    if (blockSize > size) insertFree(offset + size, blockSize - size);
+
+    allocated[offset] = size;
+    used += size;
+    return offset;
+}
+
+void BufferAllocator::free(size_t offset) {
+    auto block = allocated.find(offset);
+    if (block == allocated.end()) return;
+
+    size_t size = block->second;
+    allocated.erase(block);
+    used -= size;
+
+    // merge with the free block after and the one before
+    auto next = freeByOffset.find(offset + size);
+    if (next != freeByOffset.end()) {
+        size += next->second;
+        eraseFree(next);
+    }
+    auto previous = freeByOffset.lower_bound(offset);
+    if (previous != freeByOffset.begin()) {
+        --previous;
+        if (previous->first + previous->second == offset) {
+            offset = previous->first;
+            size += previous->second;
+            eraseFree(previous);
+        }
+    }
+    insertFree(offset, size);
+}
+
+void BufferAllocator::grow(size_t capacity) {
+    if (capacity <= this->capacity) return;
+
+    size_t offset = this->capacity;
+    size_t size = capacity - this->capacity;
+    this->capacity = capacity;
+
+    auto last = freeByOffset.empty() ? freeByOffset.end() : std::prev(freeByOffset.end());
+    if (last != freeByOffset.end() && last->first + last->second == offset) {
+        offset = last->first;
+        size += last->second;
+        eraseFree(last);
+    }
+    insertFree(offset, size);
+}
+
+void BufferAllocator::reset() {
+    freeByOffset.clear();
+    freeBySize.clear();
+    allocated.clear();
+    used = 0;
+    if (capacity > 0) insertFree(0, capacity);
+}
+
+double BufferAllocator::getFragmentation() const {
+    size_t freeUnits = capacity - used;
+    if (freeUnits == 0) return 0.0;
+    return 1.0 - (double)getLargestFree() / (double)freeUnits;
+}
+
+void BufferAllocator::insertFree(size_t offset, size_t size) {
+    freeByOffset[offset] = size;
+    freeBySize.emplace(size, offset);
+}
+
+void BufferAllocator::eraseFree(std::map<size_t, size_t>::iterator block) {
+    auto range = freeBySize.equal_range(block->second);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == block->first) {
+            freeBySize.erase(it);
+            break;
+        }
+    }
+    freeByOffset.erase(block);
+}
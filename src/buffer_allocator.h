@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+/// @brief Free-list suballocator of one buffer, in units chosen by the caller (vertices, indices).
+///        Only the bookkeeping: the caller owns the GL buffer and grows it when allocate fails.
+///        Best fit from a size-ordered index of the free blocks, freed blocks merge with their
+///        free neighbours, so holes only remain between blocks still in use.
+class BufferAllocator {
+    public:
+        static constexpr size_t INVALID = SIZE_MAX;
+
+        /// @param capacity Units available at first
+        BufferAllocator(size_t capacity = 0);
+
+        /// @brief Reserves `size` contiguous units
+        /// @return Offset of the block, INVALID if no free block is large enough (or size is 0)
+        size_t allocate(size_t size);
+
+        /// @brief Returns a block from allocate, unknown offsets are ignored
+        void free(size_t offset);
+
+        /// @brief Adds capacity at the end, merged with a free block ending there
+        /// @param capacity New capacity, smaller values are ignored
+        void grow(size_t capacity);
+
+        /// @brief Forgets every block, the whole capacity is free again
+        void reset();
+
+        size_t getCapacity() const { return capacity; }
+
+        /// @brief Units in allocated blocks
+        size_t getUsed() const { return used; }
+
+        size_t getAllocations() const { return allocated.size(); }
+        size_t getFreeBlocks() const { return freeByOffset.size(); }
+        size_t getLargestFree() const { return freeBySize.empty() ? 0 : freeBySize.rbegin()->first; }
+
+        /// @brief 1 - largest free block / free units: 0 if the free space is one block, close to 1
+        ///        if it is scattered in small holes
+        double getFragmentation() const;
+
+    private:
+        void insertFree(size_t offset, size_t size);
+        void eraseFree(std::map<size_t, size_t>::iterator block);
+
+        size_t capacity;
+        size_t used;
+        std::map<size_t, size_t> freeByOffset;      // offset -> size, neighbours for merging
+        std::multimap<size_t, size_t> freeBySize;   // size -> offset, best fit
+        std::map<size_t, size_t> allocated;         // offset -> size
+};
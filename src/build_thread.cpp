@@ -0,0 +1,56 @@
+#include <build_thread.h>
+
+BuildThread::BuildThread() : state(IDLE) {
+    quit = false;
+}
+
+BuildThread::~BuildThread() {
+    if (!thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+bool BuildThread::submit(std::function<void()> job) {
+    if (state.load(std::memory_order_acquire) != IDLE) return false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->job = std::move(job);
+        state.store(BUILDING, std::memory_order_release);
+    }
+    if (!thread.joinable()) thread = std::thread(&BuildThread::run, this);
+    wake.notify_one();
+    return true;
+}
+
+void BuildThread::acknowledge() {
+    int ready = READY;
+    state.compare_exchange_strong(ready, IDLE, std::memory_order_acq_rel);
+}
+
+void BuildThread::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    wake.wait(lock, [this] { return state.load(std::memory_order_acquire) != BUILDING; });
+}
+
+void BuildThread::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return quit || state.load(std::memory_order_acquire) == BUILDING; });
+        if (state.load(std::memory_order_acquire) == BUILDING) {
+            std::function<void()> current = std::move(job);
+            lock.unlock();
+            current();
+            lock.lock();
+            // release: everything the job wrote is visible to whoever sees READY
+            state.store(READY, std::memory_order_release);
+            wake.notify_all();
+        } else if (quit) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/// @brief One worker thread running one job at a time, for CPU work that must not stall the frame.
+///        The owner polls the state once per frame: IDLE -> submit -> BUILDING -> READY -> acknowledge -> IDLE.
+///        The state is a single atomic, the result written by the job is visible once isReady
+///        returns true, so the frame loop never takes a lock or waits for the job.
+class BuildThread {
+    public:
+        BuildThread();
+
+        /// @brief Waits for the running job and stops the thread
+        ~BuildThread();
+
+        /// @brief Starts the job on the worker (the thread itself is started on first use)
+        /// @return false if the previous job is still running or not acknowledged
+        bool submit(std::function<void()> job);
+
+        /// @brief No job running and no result waiting
+        bool isIdle() const { return state.load(std::memory_order_acquire) == IDLE; }
+
+        /// @brief The job finished, its results may be read until acknowledge
+        bool isReady() const { return state.load(std::memory_order_acquire) == READY; }
+
+        /// @brief The results were taken, allows the next submit
+        void acknowledge();
+
+        /// @brief Blocks until the running job finished (shutdown, benchmarks)
+        void wait();
+
+    private:
+        enum State {
+            IDLE,
+            BUILDING,
+            READY
+        };
+
+        void run();
+
+        std::atomic<int> state;
+        std::function<void()> job;
+        std::mutex mutex;             // only guards waking the worker up
+        std::condition_variable wake;
+        bool quit;
+        std::thread thread;
+};
@@ -0,0 +1,181 @@
+#include <compute_generator.h>
+#include <functions.h>
+#include <vertex_format.h>
+#include <algorithm>
+#include <iostream>
+
+// layout (location = N) uniforms of ngon_compute_shader.glsl
+static const GLint EXPANSION_LOCATION = 0;
+static const GLint SUBDIVISIONS_LOCATION = 1;
+static const GLint POLYGONS_LOCATION = 2;
+static const GLint CAPACITY_LOCATION = 3;
+
+// local_size_x of ngon_compute_shader.glsl
+static const GLuint WORKGROUP_SIZE = 64;
+
+static const size_t VERTEX_STRIDE = 24; // VertexFormat::FLOAT with colors
+static const size_t COMMAND_BYTES = 4 * sizeof(GLuint); // DrawArraysIndirectCommand
+static const size_t COUNTER_BYTES = 2 * sizeof(GLuint);   // next vertex, rejected polygons
+
+static_assert(sizeof(ComputeGenerator::Polygon) == 5 * 4, "read as 5 words per polygon by the shader");
+
+ComputeGenerator::ComputeGenerator(RenderState& state) : state(state) {
+    program = 0;
+    vao = 0;
+    polygonBuffer = 0; vertexBuffer = 0; commandBuffer = 0; counterBuffer = 0;
+    polygonBytes = 0; vertexBytes = 0; commandBytes = 0;
+    expansion = POINTS;
+    polygonCount = 0;
+    vertexCount = 0;
+    maxVertices = 0;
+    maxPolygons = 0;
+    rejectedPolygons = 0;
+}
+
+ComputeGenerator::~ComputeGenerator() {
+    release();
+}
+
+void ComputeGenerator::release() {
+    GLuint buffers[] = {polygonBuffer, vertexBuffer, commandBuffer, counterBuffer};
+    for (GLuint buffer : buffers) {
+        if (buffer != 0) glDeleteBuffers(1, &buffer);
+    }
+    if (vao != 0) {
+        state.vertexArrayDeleted(vao);
+        glDeleteVertexArrays(1, &vao);
+    }
+    if (program != 0) {
+        state.programDeleted(program);
+        glDeleteProgram(program);
+    }
+    program = 0;
+    vao = 0;
+    polygonBuffer = 0; vertexBuffer = 0; commandBuffer = 0; counterBuffer = 0;
+    polygonBytes = 0; vertexBytes = 0; commandBytes = 0;
+    polygonCount = 0;
+    vertexCount = 0;
+    rejectedPolygons = 0;
+}
+
+bool ComputeGenerator::initialize(const char* computePath) {
+    release();
+    if (!GLEW_VERSION_4_3 && !(GLEW_ARB_compute_shader && GLEW_ARB_multi_draw_indirect)) {
+        std::cout << "Compute n-gons: needs GL 4.3 or GL_ARB_compute_shader + GL_ARB_multi_draw_indirect" << std::endl;
+        return false;
+    }
+
+    program = createComputeProgram(computePath);
+    if (program == 0) return false;
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &polygonBuffer);
+    glGenBuffers(1, &vertexBuffer);
+    glGenBuffers(1, &commandBuffer);
+    glGenBuffers(1, &counterBuffer);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, counterBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, COUNTER_BYTES, nullptr, GL_DYNAMIC_DRAW);
+
+    // the shader writes the vertices as one storage block, larger buffers would be written out of bounds
+    GLint64 maxBlockBytes = 0;
+    glGetInteger64v(GL_MAX_SHADER_STORAGE_BLOCK_SIZE, &maxBlockBytes);
+    maxVertices = std::min((size_t)maxBlockBytes / VERTEX_STRIDE, (size_t)UINT32_MAX);
+    maxPolygons = (size_t)maxBlockBytes / sizeof(Polygon);
+
+    // the attributes read the shader's output buffer, they stay valid when it is reallocated
+    state.bindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    VertexFormat::setAttributes(VertexFormat::FLOAT);
+    state.bindVertexArray(0);
+    return true;
+}
+
+size_t ComputeGenerator::verticesPerPolygon(int sides, Expansion expansion, int subdivisions) {
+    size_t n = (size_t)std::max(sides, 3);
+    size_t s = (size_t)std::max(subdivisions, 1);
+    switch (expansion) {
+        case LINES: return 2 * n;
+        case TRIANGLE_FAN: return n + 1;
+        case TRIANGLES: return 3 * n * s * s;
+        default: return n;
+    }
+}
+
+GLenum ComputeGenerator::primitiveOf(Expansion expansion) {
+    switch (expansion) {
+        case LINES: return GL_LINES;
+        case TRIANGLE_FAN: return GL_TRIANGLE_FAN;
+        case TRIANGLES: return GL_TRIANGLES;
+        default: return GL_POINTS;
+    }
+}
+
+void ComputeGenerator::reserve(GLenum target, GLuint buffer, size_t& capacityBytes, size_t bytes) {
+    glBindBuffer(target, buffer);
+    if (bytes <= capacityBytes) return;
+    glBufferData(target, (GLsizeiptr)bytes, nullptr, GL_DYNAMIC_DRAW);
+    capacityBytes = bytes;
+}
+
+void ComputeGenerator::generate(const std::vector<Polygon>& polygons, Expansion expansion, int subdivisions) {
+    if (program == 0) return;
+
+    this->expansion = expansion;
+    polygonCount = std::min(polygons.size(), maxPolygons);
+    rejectedPolygons = polygons.size() - polygonCount;
+    // exact size from the parameters, the shader only decides where each polygon goes
+    vertexCount = 0;
+    for (size_t i = 0; i < polygonCount; ++i) {
+        vertexCount += verticesPerPolygon(polygons[i].sides, expansion, subdivisions);
+    }
+    if (polygonCount == 0) return;
+    // polygons past the vertex limit get an empty command from the shader
+    bool overflow = vertexCount > maxVertices;
+    vertexCount = std::min(vertexCount, maxVertices);
+
+    reserve(GL_SHADER_STORAGE_BUFFER, polygonBuffer, polygonBytes, polygonCount * sizeof(Polygon));
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, (GLsizeiptr)(polygonCount * sizeof(Polygon)), polygons.data());
+    reserve(GL_SHADER_STORAGE_BUFFER, vertexBuffer, vertexBytes, vertexCount * VERTEX_STRIDE);
+    reserve(GL_SHADER_STORAGE_BUFFER, commandBuffer, commandBytes, polygonCount * COMMAND_BYTES);
+
+    GLuint zeros[2] = {0, 0};
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, counterBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, COUNTER_BYTES, zeros);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, polygonBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, vertexBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, commandBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, counterBuffer);
+
+    state.useProgram(program);
+    state.uniform1i(EXPANSION_LOCATION, (GLint)expansion);
+    state.uniform1i(SUBDIVISIONS_LOCATION, std::max(subdivisions, 1));
+    state.uniform1ui(POLYGONS_LOCATION, (GLuint)polygonCount);
+    state.uniform1ui(CAPACITY_LOCATION, (GLuint)vertexCount);
+    glDispatchCompute((GLuint)((polygonCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE), 1, 1);
+
+    // vertices are read as attributes and commands as indirect parameters by the next draw
+    glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+
+    if (overflow || rejectedPolygons > 0) {
+        // only past the limit: reading the counter waits for the dispatch
+        GLuint counters[2] = {0, 0};
+        glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, counterBuffer);
+        glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, COUNTER_BYTES, counters);
+        rejectedPolygons += counters[1];
+        std::cout << "Compute n-gons: more than the storage block limit of " << maxPolygons << " polygons / "
+                  << maxVertices << " vertices, " << rejectedPolygons << " of " << polygons.size()
+                  << " polygons are not drawn" << std::endl;
+    }
+}
+
+int ComputeGenerator::draw() {
+    if (program == 0 || polygonCount == 0) return 0;
+
+    state.bindVertexArray(vao);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+    glMultiDrawArraysIndirect(primitiveOf(expansion), nullptr, (GLsizei)polygonCount, 0);
+    return 1;
+}
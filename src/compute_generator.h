@@ -0,0 +1,89 @@
+#pragma once
+#include <GL/glew.h>
+#include <render_state.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+
+/// @brief Regular n-gons generated by ngon_compute_shader.glsl straight into a vertex buffer.
+///        The CPU uploads 20 bytes per polygon; the shader expands every polygon into its vertices
+///        (VertexFormat::FLOAT, drawn with vertex_shader.glsl) and writes one indirect command per
+///        polygon, so the vertices never exist on the CPU and draw() is a single
+///        glMultiDrawArraysIndirect. Needs GL 4.3 (compute shaders, multi-draw indirect).
+class ComputeGenerator {
+    public:
+        /// @brief Parameters of one polygon, the same layout as the per-instance attributes of
+        ///        ngon_vertex_shader.glsl
+        struct Polygon {
+            glm::vec2 center;
+            float radius;
+            GLint sides;
+            GLuint seed;   // 0 - white, else seed of the per-vertex colors
+        };
+
+        /// @brief What every polygon becomes, each polygon is its own primitive
+        enum Expansion {
+            POINTS,        // the corners
+            LINES,         // segment k from corner k to corner k + 1
+            TRIANGLE_FAN,  // the corners, the first one repeated at the end
+            TRIANGLES      // center fan, every triangle split into subdivisions^2 (tessellation)
+        };
+
+        /// @param state Tracker of the context the polygons are drawn in, VAO bindings go through it
+        ComputeGenerator(RenderState& state);
+        ~ComputeGenerator();
+
+        ComputeGenerator(const ComputeGenerator&) = delete;
+        ComputeGenerator& operator=(const ComputeGenerator&) = delete;
+
+        /// @brief Compiles the compute program, needs a current GL context
+        /// @param computePath ngon_compute_shader.glsl
+        /// @return false without compute shader / multi-draw indirect support or if the program failed to link
+        bool initialize(const char* computePath);
+
+        bool isAvailable() const { return program != 0; }
+
+        /// @brief Uploads the parameters and dispatches the shader. Buffers only grow.
+        /// @param subdivisions TRIANGLES only, at least 1
+        void generate(const std::vector<Polygon>& polygons, Expansion expansion, int subdivisions = 1);
+
+        /// @brief Draws the polygons of the last generate with the current program
+        /// @return Number of draw calls
+        int draw();
+
+        /// @brief Vertices the last generate reserved, at most GL_MAX_SHADER_STORAGE_BLOCK_SIZE / 24
+        size_t getVertexCount() const { return vertexCount; }
+
+        size_t getPolygonCount() const { return polygonCount; }
+
+        /// @brief Polygons of the last generate that did not fit into the storage block limit and are
+        ///        not drawn, counted by the shader (read back only when the limit was exceeded)
+        size_t getRejectedPolygons() const { return rejectedPolygons; }
+
+        /// @brief Bytes of every buffer: parameters, vertices, commands
+        size_t getGpuBytes() const { return polygonBytes + vertexBytes + commandBytes; }
+
+        /// @brief Vertices one polygon expands into
+        static size_t verticesPerPolygon(int sides, Expansion expansion, int subdivisions);
+
+        /// @brief GL primitive of the expansion
+        static GLenum primitiveOf(Expansion expansion);
+
+        /// @brief Deletes the program and the buffers
+        void release();
+
+    private:
+        /// @brief glBufferData with a larger size if the buffer is too small
+        void reserve(GLenum target, GLuint buffer, size_t& capacityBytes, size_t bytes);
+
+        RenderState& state;
+        GLuint program;
+        GLuint vao;
+        GLuint polygonBuffer, vertexBuffer, commandBuffer, counterBuffer;
+        size_t polygonBytes, vertexBytes, commandBytes;
+        Expansion expansion;
+        size_t polygonCount;
+        size_t vertexCount;
+        size_t maxVertices, maxPolygons; // GL_MAX_SHADER_STORAGE_BLOCK_SIZE
+        size_t rejectedPolygons;
+};
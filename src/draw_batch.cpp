@@ -0,0 +1,83 @@
+#include <draw_batch.h>
+
+DrawBatch::DrawBatch() {
+    primitive = GL_TRIANGLES;
+    indirectBuffer = 0;
+    indirectCapacity = 0;
+    commandsDirty = true;
+}
+
+DrawBatch::~DrawBatch() {
+    release();
+}
+
+void DrawBatch::release() {
+    if (indirectBuffer != 0) glDeleteBuffers(1, &indirectBuffer);
+    indirectBuffer = 0;
+    indirectCapacity = 0;
+    commandsDirty = true;
+}
+
+void DrawBatch::begin(GLenum newPrimitive) {
+    primitive = newPrimitive;
+    firsts.clear();
+    counts.clear();
+    commandsDirty = true;
+}
+
+void DrawBatch::add(GLint first, GLsizei count) {
+    if (count <= 0) return;
+    firsts.push_back(first);
+    counts.push_back(count);
+    commandsDirty = true;
+}
+
+void DrawBatch::uploadCommands() {
+    std::vector<DrawArraysIndirectCommand> commands(firsts.size());
+    for (size_t i = 0; i < firsts.size(); ++i) {
+        commands[i].count = (GLuint)counts[i];
+        commands[i].instanceCount = 1;
+        commands[i].first = (GLuint)firsts[i];
+        commands[i].baseInstance = 0;
+    }
+
+    if (indirectBuffer == 0) glGenBuffers(1, &indirectBuffer);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+
+    if (commands.size() > indirectCapacity) {
+        indirectCapacity = commands.size();
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, indirectCapacity * sizeof(DrawArraysIndirectCommand), 
+                     commands.data(), GL_STATIC_DRAW);
+    } else {
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, commands.size() * sizeof(DrawArraysIndirectCommand), 
+                        commands.data());
+    }
+
+    commandsDirty = false;
+}
+
+int DrawBatch::submit(SubmitMode mode) {
+    if (firsts.empty()) return 0;
+
+    switch (mode) {
+        case LOOP:
+            for (size_t i = 0; i < firsts.size(); ++i) {
+                glDrawArrays(primitive, firsts[i], counts[i]);
+            }
+            return (int)firsts.size();
+
+        case MULTI_DRAW:
+            glMultiDrawArrays(primitive, firsts.data(), counts.data(), (GLsizei)firsts.size());
+            return 1;
+
+        case INDIRECT:
+            if (commandsDirty) {
+                uploadCommands();
+            } else {
+                glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+            }
+            glMultiDrawArraysIndirect(primitive, (void*)0, (GLsizei)firsts.size(), 0);
+            return 1;
+    }
+    return 0;
+}
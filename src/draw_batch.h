@@ -0,0 +1,60 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstddef>
+#include <vector>
+
+/// @brief Collects sub-ranges of one primitive type from the bound VAO and submits them together:
+///        one glDrawArrays per range, one glMultiDrawArrays, or one glMultiDrawArraysIndirect
+///        reading its commands from a GPU buffer. Ranges are kept between frames, the indirect
+///        buffer is re-uploaded only after they change.
+class DrawBatch {
+    public:
+        enum SubmitMode {
+            LOOP,        // glDrawArrays per range, reference path
+            MULTI_DRAW,  // glMultiDrawArrays
+            INDIRECT     // glMultiDrawArraysIndirect, GL 4.3
+        };
+
+        DrawBatch();
+        ~DrawBatch();
+
+        /// @brief Drops all ranges and sets the primitive for the next ones
+        /// @param primitive GL primitive (GL_TRIANGLE_FAN, GL_LINE_STRIP, ...)
+        void begin(GLenum primitive);
+
+        /// @brief Adds a range of vertices, empty ranges are skipped
+        /// @param first First vertex in the bound vertex buffer
+        /// @param count Number of vertices
+        void add(GLint first, GLsizei count);
+
+        /// @brief Number of collected ranges
+        int size() const { return (int)firsts.size(); }
+
+        /// @brief Draws all ranges with the bound VAO and program
+        /// @param mode How to submit
+        /// @return Number of draw calls issued
+        int submit(SubmitMode mode);
+
+        /// @brief Deletes the indirect command buffer
+        void release();
+
+    private:
+        /// @brief Layout defined by the GL spec for glMultiDrawArraysIndirect
+        struct DrawArraysIndirectCommand {
+            GLuint count;
+            GLuint instanceCount;
+            GLuint first;
+            GLuint baseInstance;
+        };
+
+        /// @brief Uploads commands to indirectBuffer, growing it when needed
+        void uploadCommands();
+
+        GLenum primitive;
+        std::vector<GLint> firsts;
+        std::vector<GLsizei> counts;
+
+        GLuint indirectBuffer;
+        size_t indirectCapacity; // in commands
+        bool commandsDirty;
+};
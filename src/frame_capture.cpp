@@ -0,0 +1,299 @@
+#include <frame_capture.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <zlib.h>
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+FrameCapture::FrameCapture(int count) : slots(count < 2 ? 2 : count) {
+    for (Slot& slot : slots) {
+        slot.state = FREE;
+        slot.fence = 0;
+        slot.frame = 0;
+        slot.data = nullptr;
+    }
+    buffer = 0;
+    frameBytes = 0;
+    next = 0;
+    frames = 0;
+    format = PNG;
+    width = 0;
+    height = 0;
+    encoding = false;
+    quit = false;
+    written = 0;
+    failed = 0;
+    encodeMs = 0.0;
+}
+
+FrameCapture::~FrameCapture() {
+    finish();
+    if (!encoder.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_one();
+    encoder.join();
+}
+
+const char* FrameCapture::formatName(Format format) {
+    switch (format) {
+        case PNG: return "png";
+        case RAW: return "raw";
+    }
+    return "unknown";
+}
+
+bool FrameCapture::start(const std::string& directory, Format format, int width, int height) {
+    finish();
+    if (width <= 0 || height <= 0) return false;
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) return false;
+
+    this->directory = directory;
+    this->format = format;
+    frameBytes = (size_t)width * height * 4;
+    next = 0;
+    frames = 0;
+    stats = Stats();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        written = 0;
+        failed = 0;
+        encodeMs = 0.0;
+    }
+
+    // one buffer mapped for good: the encoder reads the pixels where the GPU wrote them
+    if (GLEW_ARB_buffer_storage) {
+        GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+        glBufferStorage(GL_PIXEL_PACK_BUFFER, frameBytes * slots.size(), nullptr, flags);
+        char* data = (char*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frameBytes * slots.size(), flags);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        if (data != nullptr) {
+            for (size_t i = 0; i < slots.size(); ++i) {
+                slots[i].data = data + i * frameBytes;
+            }
+        } else {
+            glDeleteBuffers(1, &buffer);
+            buffer = 0;
+        }
+    }
+
+    // without it every slot is mapped and copied out once its read back finished
+    if (buffer == 0) {
+        slotBuffers.assign(slots.size(), 0);
+        glGenBuffers((GLsizei)slotBuffers.size(), slotBuffers.data());
+        for (size_t i = 0; i < slots.size(); ++i) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slotBuffers[i]);
+            glBufferData(GL_PIXEL_PACK_BUFFER, frameBytes, nullptr, GL_STREAM_READ);
+            slots[i].fallback.resize(frameBytes);
+            slots[i].data = slots[i].fallback.data();
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    if (!encoder.joinable()) encoder = std::thread(&FrameCapture::encode, this);
+    this->width = width;
+    this->height = height;
+    return true;
+}
+
+void FrameCapture::capture() {
+    if (!isCapturing()) return;
+    Clock::time_point start = Clock::now();
+
+    collect(false);
+
+    // slots are taken and given back in order, if the oldest is busy all of them are
+    Slot& slot = slots[next];
+    if (slot.state.load(std::memory_order_acquire) != FREE) {
+        stats.dropped++;
+        frames++; // the gap in the file numbers shows the dropped frame
+        stats.captureMs += elapsedMs(start);
+        return;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer != 0 ? buffer : slotBuffers[next]);
+    size_t offset = buffer != 0 ? next * frameBytes : 0;
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)offset);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.frame = frames++;
+    slot.state.store(READING, std::memory_order_relaxed);
+    next = (next + 1) % (int)slots.size();
+    stats.captured++;
+
+    stats.captureMs += elapsedMs(start);
+}
+
+void FrameCapture::collect(bool wait) {
+    for (size_t i = 0; i < slots.size(); ++i) {
+        int index = (next + (int)i) % (int)slots.size();
+        Slot& slot = slots[index];
+        if (slot.state.load(std::memory_order_relaxed) != READING) continue;
+
+        GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? GL_TIMEOUT_IGNORED : 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) break; // younger ones neither
+        glDeleteSync(slot.fence);
+        slot.fence = 0;
+
+        if (buffer == 0) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slotBuffers[index]);
+            void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frameBytes, GL_MAP_READ_BIT);
+            if (pixels) memcpy(slot.data, pixels, frameBytes);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
+
+        slot.state.store(ENCODING, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(index);
+        }
+        wake.notify_one();
+    }
+}
+
+void FrameCapture::finish() {
+    if (!isCapturing()) return;
+
+    collect(true);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return queue.empty() && !encoding; });
+    }
+    release();
+    width = 0;
+    height = 0;
+}
+
+void FrameCapture::release() {
+    for (Slot& slot : slots) {
+        if (slot.fence) glDeleteSync(slot.fence);
+        slot.fence = 0;
+        slot.state = FREE;
+        slot.data = nullptr;
+        slot.fallback = std::vector<char>();
+    }
+    if (buffer != 0) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        glDeleteBuffers(1, &buffer);
+    }
+    buffer = 0;
+    if (!slotBuffers.empty()) glDeleteBuffers((GLsizei)slotBuffers.size(), slotBuffers.data());
+    slotBuffers.clear();
+}
+
+FrameCapture::Stats FrameCapture::getStats() const {
+    Stats result = stats;
+    std::lock_guard<std::mutex> lock(mutex);
+    result.written = written;
+    result.failed = failed;
+    result.encodeMs = encodeMs;
+    return result;
+}
+
+void FrameCapture::encode() {
+    std::vector<unsigned char> scratch;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return quit || !queue.empty(); });
+        if (queue.empty()) return; // quit
+
+        int index = queue.front();
+        queue.pop_front();
+        encoding = true;
+        lock.unlock();
+
+        Clock::time_point start = Clock::now();
+        bool ok = writeFrame(slots[index], scratch);
+        double ms = elapsedMs(start);
+        slots[index].state.store(FREE, std::memory_order_release);
+
+        lock.lock();
+        encoding = false;
+        if (ok) {
+            written++;
+            encodeMs += ms;
+        } else {
+            failed++;
+        }
+        if (queue.empty()) idle.notify_all();
+    }
+}
+
+/// @brief Appends a PNG chunk: length, type, data, CRC of type and data
+static void writeChunk(std::ofstream& file, const char* type, const unsigned char* data, size_t size) {
+    unsigned char length[4] = {(unsigned char)(size >> 24), (unsigned char)(size >> 16),
+                               (unsigned char)(size >> 8), (unsigned char)size};
+    uLong crc = crc32(0, (const Bytef*)type, 4);
+    if (size > 0) crc = crc32(crc, data, (uInt)size);
+    unsigned char crcBytes[4] = {(unsigned char)(crc >> 24), (unsigned char)(crc >> 16),
+                                 (unsigned char)(crc >> 8), (unsigned char)crc};
+    file.write((const char*)length, 4);
+    file.write(type, 4);
+    file.write((const char*)data, size);
+    file.write((const char*)crcBytes, 4);
+}
+
+bool FrameCapture::writeFrame(const Slot& slot, std::vector<unsigned char>& scratch) {
+    char name[32];
+    snprintf(name, sizeof(name), format == PNG ? "/frame_%06llu.png" : "/frame_%06llu.rgba",
+             (unsigned long long)slot.frame);
+    std::ofstream file(directory + name, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    size_t rowBytes = (size_t)width * 4;
+    if (format == RAW) {
+        // glReadPixels rows are bottom-up
+        for (int y = height - 1; y >= 0; --y) {
+            file.write(slot.data + y * rowBytes, rowBytes);
+        }
+        return file.good();
+    }
+
+    // filter type 0 per row, alpha dropped: blending leaves it partly transparent where points were drawn
+    size_t filtered = (size_t)height * (1 + (size_t)width * 3);
+    uLongf compressedSize = compressBound((uLong)filtered);
+    scratch.resize(filtered + compressedSize);
+    unsigned char* rows = scratch.data();
+    unsigned char* compressed = scratch.data() + filtered;
+    for (int y = 0; y < height; ++y) {
+        const unsigned char* src = (const unsigned char*)slot.data + (height - 1 - y) * rowBytes;
+        unsigned char* dst = rows + y * (1 + (size_t)width * 3);
+        *dst++ = 0;
+        for (int x = 0; x < width; ++x) {
+            *dst++ = src[x * 4];
+            *dst++ = src[x * 4 + 1];
+            *dst++ = src[x * 4 + 2];
+        }
+    }
+    // fastest level: the encoder has to keep up with the frame rate, size comes second
+    if (compress2(compressed, &compressedSize, rows, (uLong)filtered, Z_BEST_SPEED) != Z_OK) return false;
+
+    unsigned char header[13] = {
+        (unsigned char)(width >> 24), (unsigned char)(width >> 16), (unsigned char)(width >> 8), (unsigned char)width,
+        (unsigned char)(height >> 24), (unsigned char)(height >> 16), (unsigned char)(height >> 8), (unsigned char)height,
+        8, 2, 0, 0, 0 // 8 bits, RGB, deflate, adaptive filters, no interlace
+    };
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    file.write((const char*)signature, sizeof(signature));
+    writeChunk(file, "IHDR", header, sizeof(header));
+    writeChunk(file, "IDAT", compressed, compressedSize);
+    writeChunk(file, "IEND", nullptr, 0);
+    return file.good();
+}
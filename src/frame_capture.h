@@ -0,0 +1,105 @@
+#pragma once
+#include <GL/glew.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// @brief Records rendered frames to numbered files without stalling the render thread.
+///        capture() only queues a glReadPixels into the next pixel pack buffer of a ring and a fence;
+///        frames whose fence has passed are handed to an encoder thread, which writes them from the
+///        mapped buffer (persistent with GL_ARB_buffer_storage, as in StagingBuffer) and then
+///        releases the slot. When every slot is still being read back or encoded the frame is dropped
+///        and counted instead of waited for.
+class FrameCapture {
+    public:
+        enum Format {
+            PNG, // frame_000000.png, RGB, rows top-down
+            RAW  // frame_000000.rgba, width * height RGBA8 pixels, rows top-down, no header
+        };
+
+        struct Stats {
+            uint64_t captured = 0;    // frames read back and queued for encoding
+            uint64_t written = 0;     // files written
+            uint64_t dropped = 0;     // no free slot at capture()
+            uint64_t failed = 0;      // files that could not be written
+            double captureMs = 0.0;   // render-thread time spent in capture(), total
+            double encodeMs = 0.0;    // encoder thread time per written frame, total
+        };
+
+        /// @param slots Frames in flight: read back by the GPU or waiting for / being encoded
+        FrameCapture(int slots = 6);
+
+        /// @brief Waits for the frames in flight (see finish), GL thread only
+        ~FrameCapture();
+
+        FrameCapture(const FrameCapture&) = delete;
+        FrameCapture& operator=(const FrameCapture&) = delete;
+
+        /// @brief Starts a capture of the bottom-left width x height pixels of the read framebuffer,
+        ///        finishing the previous one. Needs a current GL context.
+        /// @param directory Directory for the files, created if missing; files are numbered from 0 per start
+        /// @return false for an empty size or if the directory could not be created
+        bool start(const std::string& directory, Format format, int width, int height);
+
+        bool isCapturing() const { return width > 0; }
+
+        /// @brief Reads back the frame just rendered (before swapping buffers). Never waits for the GPU
+        ///        or the encoder. GL thread only.
+        void capture();
+
+        /// @brief Waits until every frame in flight is written and stops capturing. GL thread only.
+        void finish();
+
+        /// @brief Counters of the current or last capture, `written` and `encodeMs` are updated by
+        ///        the encoder thread and only exact after finish
+        Stats getStats() const;
+
+        static const char* formatName(Format format);
+
+    private:
+        enum SlotState {
+            FREE,
+            READING,  // glReadPixels queued, fence pending
+            ENCODING  // owned by the encoder thread
+        };
+
+        struct Slot {
+            std::atomic<int> state;
+            GLsync fence;
+            uint64_t frame;
+            char* data;             // mapped pointer, or fallback.data()
+            std::vector<char> fallback;
+        };
+
+        /// @brief Hands the slots whose read back finished to the encoder, in frame order
+        void collect(bool wait);
+        void release();
+        void encode();
+        bool writeFrame(const Slot& slot, std::vector<unsigned char>& scratch);
+
+        std::vector<Slot> slots;
+        GLuint buffer;              // all slots, persistently mapped; 0 - a buffer per slot mapped on demand
+        std::vector<GLuint> slotBuffers;
+        size_t frameBytes;
+        int next;                   // slot of the next capture
+        uint64_t frames;            // numbers the files
+        std::string directory;
+        Format format;
+        int width, height;
+        Stats stats;
+
+        std::thread encoder;
+        mutable std::mutex mutex;   // guards the queue and the encoder's counters
+        std::condition_variable wake;
+        std::condition_variable idle;
+        std::deque<int> queue;      // slots in ENCODING order
+        bool encoding;              // the encoder holds a slot taken from the queue
+        bool quit;
+        uint64_t written, failed;   // guarded by mutex
+        double encodeMs;
+};
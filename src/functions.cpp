@@ -51,7 +51,6 @@ GLFWwindow* InitAll(int width, int height){
     return window;
 }
 
-
 GLuint compileShader(GLenum shaderType, const char* source) {
     GLuint shader = glCreateShader(shaderType);
     glShaderSource(shader, 1, &source, NULL);
@@ -66,23 +65,45 @@ GLuint compileShader(GLenum shaderType, const char* source) {
         char* errorMessage = new char[infoLogLength + 1]; 
         glGetShaderInfoLog(shader, infoLogLength, NULL, errorMessage); 
         std::cout << errorMessage; 
-        delete errorMessage; 
+        delete[] errorMessage; 
     } 
     
     return shader;
 }
 
+bool checkProgramLinked(GLuint program) {
+    GLint result = GL_FALSE;
+    int infoLogLength = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &result);
+    if (result == GL_TRUE) {
+        return true;
+    }
+
+    glGetProgramiv(program, GL_INFO_LOG_LENGTH, &infoLogLength);
+    std::cout << "ERROR::PROGRAM::LINKING_FAILED" << std::endl;
+    if (infoLogLength > 0) {
+        std::vector<char> errorMessage(infoLogLength + 1, '\0');
+        glGetProgramInfoLog(program, infoLogLength, NULL, errorMessage.data());
+        std::cout << errorMessage.data() << std::endl;
+    }
+    return false;
+}
+
 GLuint createShaderProgram(const char* vertexPath, const char* fragmentPath){
     std::string vertexCode = readShaderFile(vertexPath);
     std::string fragmentCode = readShaderFile(fragmentPath);
     
-    const char* vertexSource = vertexCode.c_str();
-    const char* fragmentSource = fragmentCode.c_str();
+    return createShaderProgramFromSource(vertexCode.c_str(), fragmentCode.c_str());
+}
 
+GLuint createShaderProgramFromSource(const char* vertexSource, const char* fragmentSource, bool retrievable){
     GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource);
     GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);    
 
     GLuint shaderProgram = glCreateProgram();
+    if (retrievable) {
+        glProgramParameteri(shaderProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     glAttachShader(shaderProgram, vertexShader);
     glAttachShader(shaderProgram, fragmentShader);
     glLinkProgram(shaderProgram);
@@ -90,5 +111,26 @@ GLuint createShaderProgram(const char* vertexPath, const char* fragmentPath){
     glDeleteShader(vertexShader); 
     glDeleteShader(fragmentShader);
 
+    if (!checkProgramLinked(shaderProgram)) {
+        glDeleteProgram(shaderProgram);
+        return 0;
+    }
+
     return shaderProgram;
 }
+
+GLuint createComputeProgram(const char* computePath){
+    std::string computeCode = readShaderFile(computePath);
+    GLuint computeShader = compileShader(GL_COMPUTE_SHADER, computeCode.c_str());
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, computeShader);
+    glLinkProgram(program);
+    glDeleteShader(computeShader);
+
+    if (!checkProgramLinked(program)) {
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
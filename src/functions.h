@@ -34,8 +34,25 @@ GLFWwindow* InitAll(int width = 200, int height = 200);
 /// @return GLuint ID of the compiled shader
 GLuint compileShader(GLenum shaderType, const char* source);
 
+/// @brief Prints the info log if the program failed to link
+/// @param program Program after glLinkProgram or glProgramBinary
+/// @return true if GL_LINK_STATUS is GL_TRUE
+bool checkProgramLinked(GLuint program);
+
 /// @brief Creates a complete shader program from vertex and fragment shader files
 /// @param vertexPath File path to the vertex shader source
 /// @param fragmentPath File path to the fragment shader source
-/// @return GLuint ID of the linked shader programs
+/// @return GLuint ID of the linked shader programs, 0 if linking failed
 GLuint createShaderProgram(const char* vertexPath, const char* fragmentPath);
+
+/// @brief Creates a complete shader program from vertex and fragment shader source code
+/// @param vertexSource Null-terminated vertex shader source
+/// @param fragmentSource Null-terminated fragment shader source
+/// @param retrievable true to set GL_PROGRAM_BINARY_RETRIEVABLE_HINT before linking (see ProgramCache)
+/// @return GLuint ID of the linked shader programs, 0 if linking failed
+GLuint createShaderProgramFromSource(const char* vertexSource, const char* fragmentSource, bool retrievable = false);
+
+/// @brief Creates a compute program from a shader file, needs GL 4.3 or GL_ARB_compute_shader
+/// @param computePath File path to the compute shader source
+/// @return GLuint ID of the linked program, 0 if linking failed
+GLuint createComputeProgram(const char* computePath);
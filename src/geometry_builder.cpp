@@ -0,0 +1,59 @@
+#include <geometry_builder.h>
+#include <algorithm>
+#include <cstring>
+
+GeometryBuilder::GeometryBuilder() {
+    count = 0;
+    capacity = 0;
+    allocations = 0;
+}
+
+void GeometryBuilder::grow(size_t needed) {
+    // doubling keeps vertex() amortized O(1) for tasks that do not reserve
+    size_t newCapacity = std::max(needed, capacity * 2);
+    newCapacity = std::max<size_t>(newCapacity, 64);
+
+    std::unique_ptr<float[]> newPositions(new float[newCapacity * 3]);
+    std::unique_ptr<float[]> newColors(new float[newCapacity * 3]);
+    if (count > 0) {
+        memcpy(newPositions.get(), positionArena.get(), count * 3 * sizeof(float));
+        memcpy(newColors.get(), colorArena.get(), count * 3 * sizeof(float));
+    }
+
+    positionArena = std::move(newPositions);
+    colorArena = std::move(newColors);
+    capacity = newCapacity;
+    allocations++;
+}
+
+void GeometryBuilder::reserve(size_t more) {
+    if (count + more > capacity) grow(count + more);
+}
+
+void GeometryBuilder::vertex(glm::vec2 position, glm::vec3 color) {
+    if (count == capacity) grow(count + 1);
+
+    float* p = positionArena.get() + count * 3;
+    p[0] = position.x;
+    p[1] = position.y;
+    p[2] = 0.0f;
+
+    float* c = colorArena.get() + count * 3;
+    c[0] = color.r;
+    c[1] = color.g;
+    c[2] = color.b;
+    count++;
+}
+
+size_t GeometryBuilder::append(size_t more) {
+    reserve(more);
+    size_t first = count;
+    count += more;
+    return first;
+}
+
+size_t GeometryBuilder::append(const float* positions, size_t more) {
+    size_t first = append(more);
+    memcpy(this->positions(first), positions, more * 3 * sizeof(float));
+    return first;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <memory>
+
+/// @brief Arena the tasks emit their vertices into: x, y, z positions and r, g, b colors in two
+///        arrays that survive clear(), so after the first use of a size a task switch allocates
+///        nothing. append() hands out uninitialized room for writers like NgonGenerator, no
+///        zero fill first. VertexFormat::pack reads the arrays straight into the vertex buffer.
+class GeometryBuilder {
+    public:
+        GeometryBuilder();
+
+        /// @brief Drops the vertices, keeps the memory
+        void clear() { count = 0; }
+
+        /// @brief Makes room for `more` vertices past the current ones in at most one allocation
+        void reserve(size_t more);
+
+        /// @brief Appends a vertex at z = 0
+        void vertex(glm::vec2 position, glm::vec3 color);
+
+        /// @brief Appends `more` uninitialized vertices, fill them through positions/colors
+        /// @return Index of the first new vertex
+        size_t append(size_t more);
+
+        /// @brief Appends `more` vertices with positions copied from x, y, z triplets (e.g. ShapeTables),
+        ///        their colors uninitialized
+        /// @return Index of the first new vertex
+        size_t append(const float* positions, size_t more);
+
+        /// @brief x, y, z of vertex `first` onwards, valid until the next reserve/vertex/append
+        float* positions(size_t first = 0) { return positionArena.get() + first * 3; }
+        const float* positions(size_t first = 0) const { return positionArena.get() + first * 3; }
+
+        /// @brief r, g, b of vertex `first` onwards, same lifetime as positions
+        float* colors(size_t first = 0) { return colorArena.get() + first * 3; }
+        const float* colors(size_t first = 0) const { return colorArena.get() + first * 3; }
+
+        /// @brief Number of vertices
+        size_t size() const { return count; }
+
+        /// @brief Times the arrays were (re)allocated since construction
+        size_t getAllocations() const { return allocations; }
+
+    private:
+        void grow(size_t needed);
+
+        std::unique_ptr<float[]> positionArena;
+        std::unique_ptr<float[]> colorArena;
+        size_t count;
+        size_t capacity; // in vertices
+        size_t allocations;
+};
@@ -0,0 +1,125 @@
+#include <headless.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <iostream>
+
+static EGLDisplay headlessDisplay = EGL_NO_DISPLAY;
+static EGLContext headlessContext = EGL_NO_CONTEXT;
+static EGLSurface headlessSurface = EGL_NO_SURFACE;
+static GLuint headlessFBO = 0;
+static GLuint headlessColorRB = 0;
+
+bool InitHeadless(int width, int height){
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay) {
+        headlessDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    }
+#endif
+    if (headlessDisplay == EGL_NO_DISPLAY) {
+        headlessDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLint major = 0, minor = 0;
+    if (headlessDisplay == EGL_NO_DISPLAY || !eglInitialize(headlessDisplay, &major, &minor)) {
+        std::cout << "ERROR: could not initialize EGL display" << std::endl;
+        return false;
+    }
+
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(headlessDisplay, configAttribs, &config, 1, &numConfigs) || numConfigs == 0) {
+        std::cout << "ERROR: no EGL config with OpenGL + pbuffer support" << std::endl;
+        TerminateHeadless();
+        return false;
+    }
+
+    eglBindAPI(EGL_OPENGL_API);
+
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 6,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    headlessContext = eglCreateContext(headlessDisplay, config, EGL_NO_CONTEXT, contextAttribs);
+    if (headlessContext == EGL_NO_CONTEXT) {
+        std::cout << "ERROR: could not create OpenGL 4.6 core context (EGL error 0x" 
+                  << std::hex << eglGetError() << std::dec << ")" << std::endl;
+        // llvmpipe reports 4.5, while our shaders are "#version 460 core"
+        std::cout << "Mesa llvmpipe: run with MESA_GL_VERSION_OVERRIDE=4.6 MESA_GLSL_VERSION_OVERRIDE=460" << std::endl;
+        TerminateHeadless();
+        return false;
+    }
+
+    // Prefer a surfaceless context, fall back to a dummy pbuffer: everything is drawn into the FBO anyway
+    if (!eglMakeCurrent(headlessDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, headlessContext)) {
+        const EGLint pbufferAttribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        headlessSurface = eglCreatePbufferSurface(headlessDisplay, config, pbufferAttribs);
+        if (headlessSurface == EGL_NO_SURFACE ||
+            !eglMakeCurrent(headlessDisplay, headlessSurface, headlessSurface, headlessContext)) {
+            std::cout << "ERROR: could not make EGL context current" << std::endl;
+            TerminateHeadless();
+            return false;
+        }
+    }
+
+    glewExperimental = GL_TRUE;
+    GLenum glewStatus = glewInit();
+    // GLEW built for GLX complains about the missing X display, but GL entry points are already loaded
+    if (glewStatus != GLEW_OK 
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+        && glewStatus != GLEW_ERROR_NO_GLX_DISPLAY
+#endif
+    ) {
+        std::cout << "ERROR: could not start GLEW\n";
+        TerminateHeadless();
+        return false;
+    }
+
+    glGenFramebuffers(1, &headlessFBO);
+    glGenRenderbuffers(1, &headlessColorRB);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, headlessColorRB);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, headlessFBO);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, headlessColorRB);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "ERROR: offscreen framebuffer is incomplete" << std::endl;
+        TerminateHeadless();
+        return false;
+    }
+
+    glViewport(0, 0, width, height);
+    return true;
+}
+
+void TerminateHeadless(){
+    if (headlessContext != EGL_NO_CONTEXT) {
+        if (headlessFBO != 0) glDeleteFramebuffers(1, &headlessFBO);
+        if (headlessColorRB != 0) glDeleteRenderbuffers(1, &headlessColorRB);
+        headlessFBO = 0;
+        headlessColorRB = 0;
+
+        eglMakeCurrent(headlessDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(headlessDisplay, headlessContext);
+        headlessContext = EGL_NO_CONTEXT;
+    }
+    if (headlessSurface != EGL_NO_SURFACE) {
+        eglDestroySurface(headlessDisplay, headlessSurface);
+        headlessSurface = EGL_NO_SURFACE;
+    }
+    if (headlessDisplay != EGL_NO_DISPLAY) {
+        eglTerminate(headlessDisplay);
+        headlessDisplay = EGL_NO_DISPLAY;
+    }
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <GL/glew.h>
+
+/// @brief Initializes an offscreen OpenGL 4.6 core context through EGL (no window, no display server)
+///        and binds a framebuffer object of the given size as the render target.
+///        Works on Mesa llvmpipe without a GPU, with MESA_GL_VERSION_OVERRIDE=4.6 and
+///        MESA_GLSL_VERSION_OVERRIDE=460 in the environment (llvmpipe reports 4.5).
+///        Built into the headless library only where CMake finds EGL.
+/// @param width Width of the offscreen color buffer in pixels
+/// @param height Height of the offscreen color buffer in pixels
+/// @return true on success, else false
+bool InitHeadless(int width = 200, int height = 200);
+
+/// @brief Destroys the offscreen framebuffer and the EGL context created by InitHeadless
+void TerminateHeadless();
@@ -0,0 +1,110 @@
+#include <line_renderer.h>
+#include <algorithm>
+#include <cstddef>
+
+static uint8_t toUnorm8(float value) {
+    return (uint8_t)(std::min(1.0f, std::max(0.0f, value)) * 255.0f + 0.5f);
+}
+
+static void setColor(uint8_t* out, const float* colors, size_t vertex) {
+    for (int k = 0; k < 3; ++k) out[k] = colors ? toUnorm8(colors[vertex * 3 + k]) : 255;
+    out[3] = 255;
+}
+
+LineRenderer::LineRenderer(RenderState& state) : state(state) {
+    vao = 0; vbo = 0;
+    segmentCount = 0;
+}
+
+LineRenderer::~LineRenderer() {
+    release();
+}
+
+void LineRenderer::release() {
+    if (vbo != 0) glDeleteBuffers(1, &vbo);
+    if (vao != 0) {
+        state.vertexArrayDeleted(vao);
+        glDeleteVertexArrays(1, &vao);
+    }
+    vao = 0; vbo = 0;
+    segmentCount = 0;
+}
+
+void LineRenderer::build(GLenum mode, const float* positions, const float* colors, size_t count,
+                         const float* widths) {
+    segments.clear();
+    size_t pairs = mode == GL_LINES ? count / 2 : mode == GL_LINE_LOOP ? count : count > 0 ? count - 1 : 0;
+    if (count < 2) pairs = 0;
+    segments.reserve(pairs);
+
+    for (size_t i = 0; i < pairs; ++i) {
+        size_t a = mode == GL_LINES ? i * 2 : i;
+        size_t b = mode == GL_LINES ? i * 2 + 1 : (i + 1) % count;
+
+        Segment segment;
+        segment.start = glm::vec2(positions[a * 3], positions[a * 3 + 1]);
+        segment.end = glm::vec2(positions[b * 3], positions[b * 3 + 1]);
+        if (segment.start == segment.end) continue; // GL_LINES draws nothing for it either
+        segment.prev = segment.start;
+        segment.next = segment.end;
+        setColor(segment.startColor, colors, a);
+        setColor(segment.endColor, colors, b);
+        segment.width = widths ? widths[i] : 1.0f;
+        segments.push_back(segment);
+    }
+    joinSegments();
+    segmentCount = segments.size();
+
+    if (vao == 0) {
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vbo);
+
+        state.bindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        const GLsizei stride = sizeof(Segment);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Segment, prev));
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Segment, start));
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Segment, end));
+        glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Segment, next));
+        glVertexAttribPointer(4, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)offsetof(Segment, startColor));
+        glVertexAttribPointer(5, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)offsetof(Segment, endColor));
+        glVertexAttribPointer(6, 1, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Segment, width));
+        for (GLuint location = 0; location <= 6; ++location) {
+            glEnableVertexAttribArray(location);
+            glVertexAttribDivisor(location, 1);
+        }
+    } else {
+        state.bindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    }
+
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(segments.size() * sizeof(Segment)), segments.data(), GL_STATIC_DRAW);
+    state.bindVertexArray(0);
+}
+
+void LineRenderer::joinSegments() {
+    size_t runStart = 0;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        bool continues = i > 0 && segments[i - 1].end == segments[i].start;
+        if (continues) {
+            segments[i].prev = segments[i - 1].start;
+            segments[i - 1].next = segments[i].end;
+        } else {
+            runStart = i;
+        }
+
+        // a run that ends where it started is closed (GL_LINE_LOOP, a polygon outline in GL_LINES)
+        bool runEnds = i + 1 == segments.size() || segments[i].end != segments[i + 1].start;
+        if (runEnds && i > runStart && segments[i].end == segments[runStart].start) {
+            segments[runStart].prev = segments[i].start;
+            segments[i].next = segments[runStart].end;
+        }
+    }
+}
+
+int LineRenderer::draw() {
+    if (segmentCount == 0) return 0;
+    state.bindVertexArray(vao);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)segmentCount);
+    return 1;
+}
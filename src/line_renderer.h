@@ -0,0 +1,63 @@
+#pragma once
+#include <GL/glew.h>
+#include <render_state.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// @brief Thick lines without glLineWidth (clamped to 1 pixel by many core profile drivers): every
+///        segment is one instance of a four-corner triangle strip expanded to its width in screen
+///        space by line_vertex_shader.glsl, so any number of segments is one draw. Segments that
+///        continue each other (a strip, a loop, or GL_LINES pairs sharing an end point) are joined
+///        with a miter or round join; free ends get round caps.
+class LineRenderer {
+    public:
+        enum Join {
+            MITER,  // sharp corners, rounded past the shader's miter limit
+            ROUND
+        };
+
+        /// @brief Per-instance attributes of line_vertex_shader.glsl
+        struct Segment {
+            glm::vec2 prev;         // start of the joined segment before, == start if none
+            glm::vec2 start;
+            glm::vec2 end;
+            glm::vec2 next;         // end of the joined segment after, == end if none
+            uint8_t startColor[4];  // RGBA8
+            uint8_t endColor[4];
+            float width;            // in multiples of the line width
+        };
+
+        /// @param state Tracker of the context the lines are drawn in, VAO bindings go through it
+        LineRenderer(RenderState& state);
+        ~LineRenderer();
+
+        /// @brief Replaces the segments with those of a polyline and uploads them, needs a current GL context
+        /// @param mode GL_LINES, GL_LINE_STRIP or GL_LINE_LOOP, as the vertices would be drawn natively
+        /// @param positions x, y, z per vertex (z is ignored)
+        /// @param colors r, g, b per vertex, nullptr for white
+        /// @param count Number of vertices
+        /// @param widths Width of every segment in multiples of the line width, nullptr for 1
+        void build(GLenum mode, const float* positions, const float* colors, size_t count,
+                   const float* widths = nullptr);
+
+        /// @brief Deletes the buffers
+        void release();
+
+        /// @brief Segments drawn, zero-length ones are dropped by build
+        size_t getSegmentCount() const { return segmentCount; }
+
+        /// @brief One instanced draw of every segment with the current program
+        /// @return Number of draw calls
+        int draw();
+
+    private:
+        /// @brief Fills prev/next of the segments that continue each other, in order
+        void joinSegments();
+
+        RenderState& state;
+        GLuint vao, vbo;
+        std::vector<Segment> segments; // reused by build
+        size_t segmentCount;
+};
@@ -1,14 +1,28 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <chrono>
+#include <cstring>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
 #include <functions.h>
+#include <frame_capture.h>
 #include <model.h>
 
 
-int main() {
+// usage: main [file.mesh] [--capture DIR [--capture-raw]], the mesh is shown as task 0,
+// --capture writes every frame to DIR (PNG, or raw RGBA)
+int main(int argc, char** argv) {
+    const char* meshPath = nullptr;
+    const char* captureDir = nullptr;
+    FrameCapture::Format captureFormat = FrameCapture::PNG;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--capture") && i + 1 < argc) captureDir = argv[++i];
+        else if (!strcmp(argv[i], "--capture-raw")) captureFormat = FrameCapture::RAW;
+        else meshPath = argv[i];
+    }
+
     GLFWwindow* window = InitAll(1920, 1080); //925 991
 
     if(window == nullptr) {
@@ -18,9 +32,30 @@ int main() {
     }
 
     Model model;
+    ProgramCache programCache("shader_cache");
+    model.setProgramCache(&programCache);
+    Profiler profiler;
+    model.setProfiler(&profiler);
     
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
     model.initialize("../shader/vertex_shader.glsl", "../shader/fragment_shader.glsl");
+    model.initializeNgon("../shader/ngon_vertex_shader.glsl", "../shader/fragment_shader.glsl");
+    model.initializeCompute("../shader/ngon_compute_shader.glsl");
+    model.initializeLines("../shader/line_vertex_shader.glsl", "../shader/fragment_shader.glsl");
+    std::cout << "Shader startup: " 
+              << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+              << " ms (" << programCache.getHits() << " from cache, " 
+              << programCache.getMisses() << " compiled)" << std::endl;
+    model.setAsyncBuild(true);
     model.setCurrentTask(1);
+    if (meshPath) model.loadMesh(meshPath);
+
+    FrameCapture capture;
+    if (captureDir) {
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        capture.start(captureDir, captureFormat, width, height);
+    }
 
     auto key_callback_wrapper = [](GLFWwindow* w, int key, int scancode, int action, int mods) {
         Model* model = static_cast<Model*>(glfwGetWindowUserPointer(w));
@@ -32,13 +67,28 @@ int main() {
 
     while(!glfwWindowShouldClose(window))
     {       
+        profiler.beginFrame();
         glClear(GL_COLOR_BUFFER_BIT);
         glClearColor(0.5f, 0.5f, 0.5f, 1.0f);
         
         model.render();
+        {
+            Profiler::Scope scope(&profiler, "capture");
+            capture.capture();
+        }
 
         glfwSwapBuffers(window);
         glfwPollEvents();    
+        profiler.endFrame();
+    }
+
+    if (capture.isCapturing()) {
+        capture.finish();
+        FrameCapture::Stats stats = capture.getStats();
+        std::cout << "Captured " << stats.written << " frames to " << captureDir << ", dropped " << stats.dropped
+                  << ", " << stats.captureMs / std::max<uint64_t>(1, stats.captured + stats.dropped)
+                  << " ms per frame on the render thread"
+                  << std::endl;
     }
 
     glfwTerminate();
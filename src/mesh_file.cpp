@@ -0,0 +1,255 @@
+#include <mesh_file.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(MeshHeader) == 64, "the vertex section starts right after the header");
+static_assert(sizeof(MeshChunk) == 40, "chunk table entries are packed");
+
+/// @brief true if [offset, offset + count * itemSize) lies inside a file of `size` bytes, without overflow
+static bool fits(uint64_t offset, uint64_t count, uint64_t itemSize, uint64_t size) {
+    if (offset > size) return false;
+    return itemSize == 0 || count <= (size - offset) / itemSize;
+}
+
+MeshFile::MeshFile() {
+    data = nullptr;
+    size = 0;
+#ifdef _WIN32
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+#endif
+}
+
+MeshFile::~MeshFile() {
+    close();
+}
+
+void MeshFile::close() {
+#ifdef _WIN32
+    if (data != nullptr) UnmapViewOfFile(data);
+    if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+    if (fileHandle != nullptr) CloseHandle(fileHandle);
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+#else
+    if (data != nullptr) munmap(data, size);
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+bool MeshFile::open(const std::string& path) {
+    close();
+
+#ifdef _WIN32
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                             FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (fileHandle == INVALID_HANDLE_VALUE) fileHandle = nullptr;
+    LARGE_INTEGER fileSize;
+    if (fileHandle != nullptr && GetFileSizeEx(fileHandle, &fileSize) && fileSize.QuadPart > 0) {
+        size = (size_t)fileSize.QuadPart;
+        mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mappingHandle != nullptr) data = (char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat status;
+    if (fd >= 0 && fstat(fd, &status) == 0 && status.st_size > 0) {
+        size = (size_t)status.st_size;
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            data = (char*)mapped;
+            madvise(data, size, MADV_SEQUENTIAL); // uploads walk the file front to back
+        }
+    }
+    if (fd >= 0) ::close(fd); // the mapping keeps the file open
+#endif
+
+    if (data == nullptr) {
+        std::cout << "Mesh file: could not map " << path << std::endl;
+        close();
+        return false;
+    }
+
+    // everything read below comes from the file, check it before trusting any offset
+    const MeshHeader& h = header();
+    bool valid = size >= sizeof(MeshHeader) && h.magic == MAGIC && h.version == VERSION &&
+                 (h.primitive == GL_TRIANGLES || h.primitive == GL_LINES || h.primitive == GL_POINTS) &&
+                 h.vertexFormat < VertexFormat::AUTO &&
+                 fits(h.vertexOffset, h.vertexCount, VertexFormat::stride((VertexFormat::Format)h.vertexFormat), size) &&
+                 fits(h.indexOffset, h.indexCount, sizeof(uint32_t), size) &&
+                 fits(h.chunkOffset, h.chunkCount, sizeof(MeshChunk), size) &&
+                 h.vertexOffset % ALIGNMENT == 0 && h.indexOffset % ALIGNMENT == 0 && h.chunkOffset % ALIGNMENT == 0;
+
+    for (size_t i = 0; valid && i < h.chunkCount; ++i) {
+        const MeshChunk& c = chunk(i);
+        valid = c.firstVertex <= h.vertexCount && c.vertexCount <= h.vertexCount - c.firstVertex &&
+                c.firstIndex <= h.indexCount && c.indexCount <= h.indexCount - c.firstIndex &&
+                c.vertexCount <= INT32_MAX && c.indexCount <= INT32_MAX; // drawn with GLsizei counts
+    }
+
+    if (!valid) {
+        std::cout << "Mesh file: " << path << " is not a valid version " << VERSION << " mesh" << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MeshFile::checkIndices(size_t index) const {
+    const MeshChunk& c = chunk(index);
+    const uint32_t* indices = chunkIndices(index);
+    for (uint32_t k = 0; k < c.indexCount; ++k) {
+        if (indices[k] >= c.vertexCount) return false;
+    }
+    return true;
+}
+
+void MeshFile::releaseRange(const char* begin, size_t bytes) const {
+#ifdef _WIN32
+    (void)begin;
+    (void)bytes; // the working set of a read-only view is trimmed by the OS
+#else
+    if (bytes == 0) return;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t offset = (size_t)(begin - data) / page * page;
+    size_t end = std::min(size, (size_t)(begin - data) + bytes);
+    // a page shared with the next chunk is simply read again
+    madvise(data + offset, end - offset, MADV_DONTNEED);
+#endif
+}
+
+void MeshFile::release(size_t index) const {
+    const MeshChunk& c = chunk(index);
+    releaseRange(chunkVertices(index), (size_t)c.vertexCount * getStride());
+    releaseRange((const char*)chunkIndices(index), (size_t)c.indexCount * sizeof(uint32_t));
+}
+
+MeshWriter::MeshWriter() {
+    file = nullptr;
+    indexFile = nullptr;
+    memset(&header, 0, sizeof(header));
+    written = 0;
+}
+
+MeshWriter::~MeshWriter() {
+    // not finished: no half-written mesh is left behind
+    if (file) {
+        fclose(file);
+        remove(partPath.c_str());
+    }
+    if (indexFile) {
+        fclose(indexFile);
+        remove(indexPath.c_str());
+    }
+}
+
+bool MeshWriter::open(const std::string& outputPath, VertexFormat::Format format, GLenum primitive) {
+    path = outputPath;
+    partPath = outputPath + ".part";
+    indexPath = outputPath + ".indices.tmp";
+    file = fopen(partPath.c_str(), "wb");
+    indexFile = fopen(indexPath.c_str(), "w+b");
+    if (!file || !indexFile) {
+        std::cout << "Mesh file: could not write " << (file ? indexPath : partPath) << std::endl;
+        return false;
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.magic = MeshFile::MAGIC;
+    header.version = MeshFile::VERSION;
+    header.primitive = primitive;
+    header.vertexFormat = (uint32_t)format;
+    chunks.clear();
+
+    // the header is written last, once the sizes are known
+    written = 0;
+    if (fwrite(&header, sizeof(header), 1, file) != 1) return false;
+    written = sizeof(header);
+    header.vertexOffset = written;
+    return true;
+}
+
+bool MeshWriter::addChunk(const void* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount,
+                          glm::vec2 boundsMin, glm::vec2 boundsMax) {
+    if (!file || !indexFile) return false;
+
+    MeshChunk chunk;
+    chunk.firstVertex = header.vertexCount;
+    chunk.firstIndex = header.indexCount;
+    chunk.vertexCount = vertexCount;
+    chunk.indexCount = indexCount;
+    chunk.boundsMin[0] = boundsMin.x;
+    chunk.boundsMin[1] = boundsMin.y;
+    chunk.boundsMax[0] = boundsMax.x;
+    chunk.boundsMax[1] = boundsMax.y;
+
+    size_t vertexBytes = (size_t)vertexCount * VertexFormat::stride((VertexFormat::Format)header.vertexFormat);
+    if (vertexBytes > 0 && fwrite(vertices, vertexBytes, 1, file) != 1) return false;
+    if (indexCount > 0 && fwrite(indices, sizeof(uint32_t), indexCount, indexFile) != indexCount) return false;
+
+    written += vertexBytes;
+    header.vertexCount += vertexCount;
+    header.indexCount += indexCount;
+    chunks.push_back(chunk);
+    return true;
+}
+
+bool MeshWriter::align() {
+    static const char zeros[MeshFile::ALIGNMENT] = {};
+    size_t padding = (size_t)((MeshFile::ALIGNMENT - written % MeshFile::ALIGNMENT) % MeshFile::ALIGNMENT);
+    if (padding > 0 && fwrite(zeros, padding, 1, file) != 1) return false;
+    written += padding;
+    return true;
+}
+
+bool MeshWriter::finish() {
+    if (!file || !indexFile) return false;
+
+    bool ok = align();
+    header.indexOffset = written;
+
+    std::vector<char> block(1 << 20);
+    rewind(indexFile);
+    size_t read;
+    while (ok && (read = fread(block.data(), 1, block.size(), indexFile)) > 0) {
+        ok = fwrite(block.data(), read, 1, file) == 1;
+        written += read;
+    }
+
+    ok = ok && align();
+    header.chunkOffset = written;
+    header.chunkCount = chunks.size();
+    ok = ok && (chunks.empty() || fwrite(chunks.data(), sizeof(MeshChunk), chunks.size(), file) == chunks.size());
+    written += chunks.size() * sizeof(MeshChunk);
+
+    ok = ok && fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = fclose(file) == 0 && ok;
+    file = nullptr;
+
+    fclose(indexFile);
+    indexFile = nullptr;
+    remove(indexPath.c_str());
+
+    // the mesh only appears under its name once complete, an existing file stays until then
+#ifdef _WIN32
+    if (ok) remove(path.c_str()); // rename does not replace on Windows
+#endif
+    ok = ok && rename(partPath.c_str(), path.c_str()) == 0;
+    if (!ok) {
+        remove(partPath.c_str());
+        std::cout << "Mesh file: could not write " << path << std::endl;
+    }
+    return ok;
+}
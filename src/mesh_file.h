@@ -0,0 +1,134 @@
+#pragma once
+#include <GL/glew.h>
+#include <vertex_format.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/// @brief Layout of a .mesh file, all integers little-endian, every section 64-byte aligned:
+///        header | vertices (interleaved, already in VertexFormat layout) | indices (uint32) | chunk table
+///        A chunk is a self-contained piece of the mesh: its indices count from its own first vertex,
+///        so it can be drawn alone from a buffer holding only its vertices (see MeshStream).
+struct MeshHeader {
+    uint32_t magic;         // MeshFile::MAGIC
+    uint32_t version;       // MeshFile::VERSION
+    uint32_t primitive;     // GL_TRIANGLES, GL_LINES or GL_POINTS
+    uint32_t vertexFormat;  // VertexFormat::Format, never AUTO
+    uint64_t vertexCount;
+    uint64_t indexCount;    // 0 - chunks are drawn with glDrawArrays
+    uint64_t chunkCount;
+    uint64_t chunkOffset;   // byte offsets from the start of the file
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+};
+
+struct MeshChunk {
+    uint64_t firstVertex;
+    uint64_t firstIndex;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    float boundsMin[2];     // x, y of the vertices, for culling without touching them
+    float boundsMax[2];
+};
+
+/// @brief Read-only memory mapping of a .mesh file. Nothing is parsed or copied: the sections are
+///        pointers into the mapping, pages are read from disk when first touched.
+class MeshFile {
+    public:
+        static const uint32_t MAGIC = 0x4853454D; // "MESH"
+        static const uint32_t VERSION = 2; // 2 - chunk bounds
+        static const size_t ALIGNMENT = 64;
+
+        MeshFile();
+        ~MeshFile();
+        MeshFile(const MeshFile&) = delete;
+        MeshFile& operator=(const MeshFile&) = delete;
+
+        /// @brief Maps the file and checks that the header and the chunk table fit inside it.
+        ///        The indices are not read, see checkIndices.
+        /// @return false if it cannot be mapped or is not a valid .mesh file (the reason is printed)
+        bool open(const std::string& path);
+
+        void close();
+
+        bool isOpen() const { return data != nullptr; }
+
+        const MeshHeader& header() const { return *(const MeshHeader*)data; }
+        const MeshChunk& chunk(size_t index) const { return ((const MeshChunk*)(data + header().chunkOffset))[index]; }
+        size_t getChunkCount() const { return (size_t)header().chunkCount; }
+
+        VertexFormat::Format getVertexFormat() const { return (VertexFormat::Format)header().vertexFormat; }
+        size_t getStride() const { return VertexFormat::stride(getVertexFormat()); }
+
+        /// @brief Packed vertices of the chunk, getStride() bytes each
+        const char* chunkVertices(size_t index) const {
+            return data + header().vertexOffset + chunk(index).firstVertex * getStride();
+        }
+
+        /// @brief Indices of the chunk, relative to its first vertex
+        const uint32_t* chunkIndices(size_t index) const {
+            return (const uint32_t*)(data + header().indexOffset) + chunk(index).firstIndex;
+        }
+
+        /// @brief true if every index of the chunk is below its vertexCount. Reads the chunk's indices,
+        ///        call it when they are read for the upload anyway.
+        bool checkIndices(size_t index) const;
+
+        /// @brief Tells the OS the pages of the chunk are no longer needed, they are read again on the
+        ///        next access. Keeps the resident memory of a mesh larger than RAM bounded.
+        void release(size_t index) const;
+
+        /// @brief Size of the mapping in bytes
+        size_t getSize() const { return size; }
+
+    private:
+        void releaseRange(const char* begin, size_t bytes) const;
+
+        char* data;
+        size_t size;
+#ifdef _WIN32
+        void* fileHandle;
+        void* mappingHandle;
+#endif
+};
+
+/// @brief Writes a .mesh file chunk by chunk without holding the mesh in memory: vertices go to the
+///        file as they come, indices to a temporary file appended by finish. Everything is written to
+///        path + ".part", finish renames it to path, so a failed or unfinished write never leaves a
+///        partial mesh under the name (the .part file is deleted).
+class MeshWriter {
+    public:
+        MeshWriter();
+        ~MeshWriter();
+
+        /// @param format Resolved VertexFormat of every vertex passed to addChunk
+        /// @param primitive GL_TRIANGLES, GL_LINES or GL_POINTS
+        bool open(const std::string& path, VertexFormat::Format format, GLenum primitive);
+
+        /// @brief Appends a chunk
+        /// @param vertices vertexCount packed vertices (VertexFormat::pack)
+        /// @param indices Relative to the first vertex of this chunk, nullptr if indexCount is 0
+        /// @param boundsMin, boundsMax Rectangle around the x, y of the vertices
+        bool addChunk(const void* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount,
+                      glm::vec2 boundsMin, glm::vec2 boundsMax);
+
+        /// @brief Appends the indices and the chunk table, writes the header
+        bool finish();
+
+        uint64_t getVertexCount() const { return header.vertexCount; }
+        uint64_t getIndexCount() const { return header.indexCount; }
+
+    private:
+        /// @brief Pads the output file with zeros up to the next MeshFile::ALIGNMENT
+        bool align();
+
+        std::string path, partPath, indexPath;
+        FILE* file;
+        FILE* indexFile;
+        MeshHeader header;
+        std::vector<MeshChunk> chunks;
+        uint64_t written;
+};
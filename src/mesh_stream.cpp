@@ -0,0 +1,201 @@
+#include <mesh_stream.h>
+#include <algorithm>
+#include <iostream>
+
+MeshStream::MeshStream(RenderState& state) : state(state) {
+    vao = 0; vbo = 0; ebo = 0;
+    streamed = false;
+    gpuBytes = 0;
+    streamVertexBytes = 0;
+    streamIndexBytes = 0;
+}
+
+MeshStream::~MeshStream() {
+    release();
+}
+
+void MeshStream::release() {
+    if (ebo != 0) glDeleteBuffers(1, &ebo);
+    if (vbo != 0) glDeleteBuffers(1, &vbo);
+    if (vao != 0) {
+        state.vertexArrayDeleted(vao);
+        glDeleteVertexArrays(1, &vao);
+    }
+    vao = 0; vbo = 0; ebo = 0;
+    file.close();
+    streamed = false;
+    gpuBytes = 0;
+    streamVertexBytes = 0;
+    streamIndexBytes = 0;
+    chunkChecks.clear();
+    grid.clear();
+    visible.clear();
+    counts.clear();
+    offsets.clear();
+    firsts.clear();
+}
+
+bool MeshStream::load(const std::string& path, size_t budget) {
+    release();
+    if (!file.open(path)) return false;
+
+    const MeshHeader& header = file.header();
+    size_t vertexBytes = (size_t)header.vertexCount * file.getStride();
+    size_t indexBytes = (size_t)header.indexCount * sizeof(uint32_t);
+    // glDrawArrays over the whole resident mesh takes a GLsizei count
+    streamed = vertexBytes + indexBytes > budget || header.vertexCount > INT32_MAX;
+
+    std::vector<glm::vec4> bounds(file.getChunkCount());
+    for (size_t i = 0; i < bounds.size(); ++i) {
+        const MeshChunk& chunk = file.chunk(i);
+        bounds[i] = glm::vec4(chunk.boundsMin[0], chunk.boundsMin[1], chunk.boundsMax[0], chunk.boundsMax[1]);
+    }
+    grid.build(bounds);
+    chunkChecks.assign(file.getChunkCount(), 0);
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    if (header.indexCount > 0) glGenBuffers(1, &ebo);
+
+    if (streamed) {
+        prepareStreaming();
+        if (gpuBytes > budget) {
+            std::cout << "Mesh " << path << ": the largest chunk needs " << gpuBytes
+                      << " bytes, more than the budget of " << budget << std::endl;
+        }
+    } else {
+        uploadResident();
+    }
+    return true;
+}
+
+bool MeshStream::isChunkValid(uint32_t index) {
+    if (chunkChecks[index] == 0) {
+        // an index past its chunk would make the GPU read outside the chunk's vertices
+        chunkChecks[index] = file.checkIndices(index) ? 1 : -1;
+        if (chunkChecks[index] < 0) {
+            std::cout << "Mesh: chunk " << index << " has indices past its vertices, it is not drawn" << std::endl;
+        }
+    }
+    return chunkChecks[index] > 0;
+}
+
+void MeshStream::uploadResident() {
+    const MeshHeader& header = file.header();
+    size_t stride = file.getStride();
+
+    state.bindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(header.vertexCount * stride), nullptr, GL_STATIC_DRAW);
+    VertexFormat::setAttributes(file.getVertexFormat());
+    if (ebo != 0) {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(header.indexCount * sizeof(uint32_t)), nullptr,
+                     GL_STATIC_DRAW);
+    }
+
+    // chunk by chunk straight from the mapping, pages are dropped once uploaded
+    for (size_t i = 0; i < file.getChunkCount(); ++i) {
+        const MeshChunk& chunk = file.chunk(i);
+        if (!isChunkValid((uint32_t)i)) {
+            file.release(i);
+            continue;
+        }
+        glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)(chunk.firstVertex * stride),
+                        (GLsizeiptr)chunk.vertexCount * stride, file.chunkVertices(i));
+        if (ebo != 0 && chunk.indexCount > 0) {
+            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, (GLintptr)(chunk.firstIndex * sizeof(uint32_t)),
+                            (GLsizeiptr)chunk.indexCount * sizeof(uint32_t), file.chunkIndices(i));
+        }
+        file.release(i);
+    }
+
+    state.bindVertexArray(0);
+    counts.reserve(file.getChunkCount());
+    offsets.reserve(file.getChunkCount());
+    firsts.reserve(file.getChunkCount());
+    gpuBytes = (size_t)(header.vertexCount * stride + header.indexCount * sizeof(uint32_t));
+}
+
+void MeshStream::prepareStreaming() {
+    size_t stride = file.getStride();
+    for (size_t i = 0; i < file.getChunkCount(); ++i) {
+        const MeshChunk& chunk = file.chunk(i);
+        streamVertexBytes = std::max(streamVertexBytes, (size_t)chunk.vertexCount * stride);
+        streamIndexBytes = std::max(streamIndexBytes, (size_t)chunk.indexCount * sizeof(uint32_t));
+    }
+
+    state.bindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)streamVertexBytes, nullptr, GL_STREAM_DRAW);
+    VertexFormat::setAttributes(file.getVertexFormat());
+    if (ebo != 0) {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)streamIndexBytes, nullptr, GL_STREAM_DRAW);
+    }
+    state.bindVertexArray(0);
+    gpuBytes = streamVertexBytes + streamIndexBytes;
+}
+
+int MeshStream::draw(glm::vec4 view) {
+    if (!isLoaded()) return 0;
+
+    grid.query(view, visible);
+    if (visible.empty()) return 0;
+
+    const MeshHeader& header = file.header();
+    GLenum mode = header.primitive;
+    state.bindVertexArray(vao);
+
+    if (!streamed) {
+        counts.clear();
+        offsets.clear();
+        firsts.clear();
+        for (uint32_t i : visible) {
+            const MeshChunk& chunk = file.chunk(i);
+            if (chunkChecks[i] < 0) continue;
+            if (ebo == 0) {
+                counts.push_back((GLsizei)chunk.vertexCount);
+                firsts.push_back((GLint)chunk.firstVertex);
+            } else if (chunk.indexCount > 0) {
+                counts.push_back((GLsizei)chunk.indexCount);
+                offsets.push_back((const void*)(chunk.firstIndex * sizeof(uint32_t)));
+                firsts.push_back((GLint)chunk.firstVertex);
+            }
+        }
+
+        if (counts.empty()) return 0;
+        if (ebo == 0) {
+            glMultiDrawArrays(mode, firsts.data(), counts.data(), (GLsizei)counts.size());
+        } else {
+            // indices count from the first vertex of their chunk
+            glMultiDrawElementsBaseVertex(mode, counts.data(), GL_UNSIGNED_INT, offsets.data(),
+                                          (GLsizei)counts.size(), firsts.data());
+        }
+        return 1;
+    }
+
+    size_t stride = file.getStride();
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    int draws = 0;
+    for (uint32_t i : visible) {
+        const MeshChunk& chunk = file.chunk(i);
+        if (chunk.vertexCount == 0 || !isChunkValid(i)) continue;
+
+        // orphaning: the driver hands out fresh storage while the previous chunk is still being drawn
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)streamVertexBytes, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)chunk.vertexCount * stride, file.chunkVertices(i));
+
+        if (ebo != 0) {
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)streamIndexBytes, nullptr, GL_STREAM_DRAW);
+            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, (GLsizeiptr)chunk.indexCount * sizeof(uint32_t),
+                            file.chunkIndices(i));
+            glDrawElements(mode, (GLsizei)chunk.indexCount, GL_UNSIGNED_INT, (void*)0);
+        } else {
+            glDrawArrays(mode, 0, (GLsizei)chunk.vertexCount);
+        }
+        file.release(i);
+        draws++;
+    }
+    return draws;
+}
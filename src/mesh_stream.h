@@ -0,0 +1,81 @@
+#pragma once
+#include <GL/glew.h>
+#include <mesh_file.h>
+#include <render_state.h>
+#include <spatial_grid.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// @brief Draws a .mesh file straight from its memory mapping. The vertices are stored in their GPU
+///        layout, so loading is glBufferSubData from the mapped pages, chunk by chunk, with no parsing
+///        and no intermediate copy. A mesh larger than the memory budget is not kept on the GPU:
+///        every frame each chunk is uploaded into one buffer sized for the largest chunk and drawn.
+///        Chunks are culled against the view through a SpatialGrid over their bounds, built at load:
+///        only the visible ones are drawn, or uploaded when streaming.
+class MeshStream {
+    public:
+        /// @param state Tracker of the context the mesh is drawn in, VAO bindings go through it
+        MeshStream(RenderState& state);
+        ~MeshStream();
+
+        /// @brief Maps the file and uploads it, or prepares streaming if it does not fit the budget.
+        ///        Needs a current GL context.
+        /// @param path .mesh file (see MeshWriter, mesh_convert)
+        /// @param budget GPU bytes the mesh may keep resident
+        /// @return false if the file cannot be opened, the previous mesh is released either way
+        bool load(const std::string& path, size_t budget);
+
+        /// @brief Deletes the buffers and unmaps the file
+        void release();
+
+        bool isLoaded() const { return file.isOpen(); }
+
+        // the getters below need a loaded mesh
+
+        /// @brief true if the mesh exceeded the budget and is uploaded chunk by chunk every frame
+        bool isStreamed() const { return streamed; }
+
+        GLenum getPrimitive() const { return file.header().primitive; }
+        VertexFormat::Format getVertexFormat() const { return file.getVertexFormat(); }
+        uint64_t getVertexCount() const { return file.header().vertexCount; }
+        uint64_t getIndexCount() const { return file.header().indexCount; }
+        size_t getChunkCount() const { return file.getChunkCount(); }
+
+        /// @brief GPU bytes held by the mesh: all of it, or the streaming buffers
+        size_t getGpuBytes() const { return gpuBytes; }
+
+        /// @brief Draws the chunks intersecting `view` with the current program
+        /// @param view Visible rectangle in mesh coordinates: minX, minY, maxX, maxY
+        /// @return Number of draw calls
+        int draw(glm::vec4 view);
+
+        /// @brief Chunks the last draw submitted
+        size_t getVisibleChunks() const { return visible.size(); }
+
+    private:
+        /// @brief MeshFile::checkIndices once per chunk, a chunk that fails is never drawn
+        bool isChunkValid(uint32_t index);
+
+        void uploadResident();
+        void prepareStreaming();
+
+        RenderState& state;
+        MeshFile file;
+        GLuint vao, vbo, ebo;
+        bool streamed;
+        size_t gpuBytes;
+        size_t streamVertexBytes, streamIndexBytes; // largest chunk, streaming only
+
+        std::vector<signed char> chunkChecks; // per chunk: 0 not checked yet, 1 valid, -1 invalid
+
+        SpatialGrid grid;
+        std::vector<uint32_t> visible; // chunk indices, ascending
+
+        // resident meshes: one multi-draw over the visible chunks, rebuilt from `visible` every draw
+        std::vector<GLsizei> counts;
+        std::vector<const void*> offsets;
+        std::vector<GLint> firsts; // base vertex, or first vertex without indices
+};
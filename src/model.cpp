@@ -1,202 +1,851 @@
 #include <model.h>
 
 int Model::renderMode = 0;
+RenderState Model::renderState;
 
-Model::Model() {
-    VAO = 0; VBO = 0;
-    shaderProgram = 0;
+Model::Model()
+    : shaderVariants(renderState), ngonVariants(renderState), ngonCompute(renderState),
+      mesh(renderState), lineVariants(renderState), lines(renderState) {
+    VAO = 0; VBO = 0; EBO = 0;
+    programCache = nullptr;
+    profiler = nullptr;
     pointSize = 24.0f;
     lineWidth = 8.0f;
     numVertices = 0;
+    drawCalls = 0;
     currentTask = 1;
     smoothPoints = true;
     smoothMode = 1;
-    flatMode = true;
-    polygonMode = 0;
+    rasterMode = GL_FILL;
+    vertexFormat = VertexFormat::FLOAT;
+    bufferFormat = VertexFormat::FLOAT;
+    bufferColors = true;
+    colorSeed = 0;
+    atlasFormat = VertexFormat::FLOAT;
+    firstVertex = 0;
+    firstIndex = 0;
+    numIndices = 0;
+    atlasVAO = 0; atlasVBO = 0; atlasEBO = 0;
+    atlasMode = false;
+    batchMode = DrawBatch::MULTI_DRAW;
+    for (int task = 0; task < 10; ++task) nextVariant[task] = 0;
+    proceduralNgons = false;
+    ngonVAO = 0; ngonInstanceVBO = 0;
+    ngonVerticesPerInstance = 0;
+    computeNgons = false;
+    ngonSubdivisions = 0;
+    ngonComputed = false;
+    meshBudget = (size_t)512 << 20;
+    viewCenter = glm::vec2(0.0f);
+    viewZoom = 1.0f;
+    thickLines = false;
+    lineJoin = LineRenderer::MITER;
+    linesDirty = true;
+    software = nullptr;
+    topologyReport = Stripifier::Report();
+    asyncBuild = false;
+    requestedTask = -1;
+    taskRequests = 0;
+    buildAllocations = 0;
+    nextRegion = 0;
+    buildTask = 0;
+    buildRequest = 0;
+    buildRegion = 0;
+    buildStaged = false;
+    buildFormat = VertexFormat::FLOAT;
+    buildVertexBytes = 0;
+    buildIndexBytes = 0;
 }
 
 Model::~Model() {
+    buildThread.wait();
     clearBuffers();
+    clearAtlas();
+    clearNgonBuffers();
 }
 
 void Model::clearBuffers() {
+    if (EBO != 0) glDeleteBuffers(1, &EBO);
     if (VBO != 0) glDeleteBuffers(1, &VBO);
-    if (VAO != 0) glDeleteVertexArrays(1, &VAO);
+    if (VAO != 0) {
+        renderState.vertexArrayDeleted(VAO);
+        glDeleteVertexArrays(1, &VAO);
+    }
+    VAO = 0; VBO = 0; EBO = 0;
 }
 
+// indexed by VariantBits
+static const std::vector<std::string> VARIANT_DEFINES = {"FLAT_SHADING", "POINT_AA"};
+
+// layout (location = 0) in ngon_vertex_shader.glsl, the same in every variant
+static const GLint NGON_PRIMITIVE_LOCATION = 0;
+
+// layout (location = 1) in vertex_shader.glsl, ngon_vertex_shader.glsl and line_vertex_shader.glsl
+static const GLint VIEW_LOCATION = 1;
+
+// layout (location = 2) and (location = 3) in line_vertex_shader.glsl
+static const GLint LINE_LOCATION = 2;
+static const GLint LINE_JOIN_LOCATION = 3;
+
+// layout (location = 2) in vertex_shader.glsl
+static const GLint COLOR_SEED_LOCATION = 2;
+
 void Model::initialize(const char* vertexPath, const char* fragmentPath) {
-    shaderProgram = createShaderProgram(vertexPath, fragmentPath);
+    shaderVariants.compile(vertexPath, fragmentPath, VARIANT_DEFINES, programCache);
+}
+
+void Model::initializeNgon(const char* vertexPath, const char* fragmentPath) {
+    ngonVariants.compile(vertexPath, fragmentPath, VARIANT_DEFINES, programCache);
+}
+
+bool Model::initializeCompute(const char* computePath) {
+    return ngonCompute.initialize(computePath);
+}
+
+void Model::initializeLines(const char* vertexPath, const char* fragmentPath) {
+    lineVariants.compile(vertexPath, fragmentPath, VARIANT_DEFINES, programCache, nullptr, "THICK_LINE");
+}
+
+void Model::finishPrograms() {
+    for (size_t i = 0; i < shaderVariants.size(); ++i) shaderVariants.get((int)i);
+    for (size_t i = 0; i < ngonVariants.size(); ++i) ngonVariants.get((int)i);
+    for (size_t i = 0; i < lineVariants.size(); ++i) lineVariants.get((int)i);
+}
+
+int Model::currentVariant() const {
+    int variant = 0;
+    if (taskSettings.flatMode) variant |= FLAT_VARIANT;
+    // point AA only changes points, other primitives keep the cheaper variant
+    if (smoothMode == 1 && (primitiveType == POINTS || rasterMode == GL_POINT)) variant |= POINT_AA_VARIANT;
+    return variant;
+}
+
+size_t Model::getGeometryAllocations() const {
+    // buildGenerator may be generating right now, its count is the one read back while idle
+    return geometry.getAllocations() + tasks.getGeometry().getAllocations() + buildAllocations;
 }
 
 void Model::setupBuffers() {
-    clearBuffers();
+    Profiler::Scope scope(profiler, "upload");
+    linesDirty = true;
 
-    std::vector<float> combinedData;
-    for (size_t i = 0; i < vertices.size() / 3; ++i) {
-        combinedData.push_back(vertices[i * 3]);
-        combinedData.push_back(vertices[i * 3 + 1]);
-        combinedData.push_back(vertices[i * 3 + 2]);
-        
-        if (i < colors.size() / 3) {
-            combinedData.push_back(colors[i * 3]);
-            combinedData.push_back(colors[i * 3 + 1]);
-            combinedData.push_back(colors[i * 3 + 2]);
-        } else {
-            combinedData.push_back(1.0f); // R
-            combinedData.push_back(1.0f); // G  
-            combinedData.push_back(1.0f); // B
-        }
+    VertexFormat::Format format = VertexFormat::resolve(vertexFormat, geometry.positions(), geometry.size());
+    bool colors = colorSeed == 0;
+    GLsizeiptr vertexBytes = (GLsizeiptr)(geometry.size() * VertexFormat::stride(format, colors));
+    createBuffers(format, colors, vertexBytes, nullptr, indices.size() * sizeof(GLuint), indices.data());
+    if (vertexBytes == 0) return;
+
+    // pack straight into the new VBO, the driver already allocated it in createBuffers
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    void* mapped = glMapBufferRange(GL_ARRAY_BUFFER, 0, vertexBytes,
+                                    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (mapped) {
+        packGeometry(format, geometry, colors, mapped);
+        if (glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE) return;
     }
 
+    // mapping failed or the contents were lost while mapped: upload through a kept CPU copy
+    uploadArena.resize(vertexBytes);
+    packGeometry(format, geometry, colors, uploadArena.data());
+    glBufferSubData(GL_ARRAY_BUFFER, 0, vertexBytes, uploadArena.data());
+}
+
+void Model::packGeometry(VertexFormat::Format format, const GeometryBuilder& built, bool colors, void* destination) {
+    if (!colors) {
+        VertexFormat::packPositions(format, built.positions(), built.size(), destination);
+    } else {
+        VertexFormat::pack(format, built.positions(), built.colors(), built.size(), destination);
+    }
+}
+
+void Model::createBuffers(VertexFormat::Format format, bool colors, GLsizeiptr vertexBytes, const void* vertexData,
+                          GLsizeiptr indexBytes, const void* indexData) {
+    clearBuffers();
+    bufferFormat = format;
+    bufferColors = colors;
+
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
 
-    glBindVertexArray(VAO);
+    renderState.bindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, combinedData.size() * sizeof(float), combinedData.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, vertexBytes, vertexData, GL_STATIC_DRAW);
+    VertexFormat::setAttributes(format, colors);
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
+    if (indexBytes > 0) {
+        glGenBuffers(1, &EBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, indexData, GL_STATIC_DRAW);
+    }
 
-    glBindVertexArray(0);
+    renderState.bindVertexArray(0);
 }
 
 void Model::render() {
-    glUseProgram(shaderProgram);
+    if (software) {
+        renderSoftware();
+        return;
+    }
+
+    if (asyncBuild || !buildThread.isIdle()) pollBuild();
     updateRenderSettings();
 
-    glBindVertexArray(VAO);
+    drawCalls = 0;
+    if (isProceduralTask()) {
+        renderProcedural();
+        return;
+    }
+
+    if (currentTask == MESH_TASK) {
+        Profiler::Scope scope(profiler, "draw_mesh");
+        drawCalls += mesh.draw(getViewRect());
+        return;
+    }
+
+    if (isThickLineTask()) {
+        renderThickLines();
+        return;
+    }
+
+    // the VAO stays bound after the frame, next render() elides the rebind
+    renderState.bindVertexArray(atlasMode ? atlasVAO : VAO);
     
     if (currentTask != 9) {
         renderNormal();
     } else{
         renderTask8bSpecial();
     }
-    
-    glBindVertexArray(0);
 }
 
 void Model::renderNormal() {
+    Profiler::Scope scope(profiler, "draw");
     switch (primitiveType) {
         case POINTS:
-            glDrawArrays(GL_POINTS, 0, numVertices);
+            glDrawArrays(GL_POINTS, firstVertex, numVertices);
+            drawCalls++;
             break;
         case LINES:
-            glDrawArrays(GL_LINES, 0, numVertices);
+            glDrawArrays(GL_LINES, firstVertex, numVertices);
+            drawCalls++;
             break;
         case LINE_STRIP:
-            glDrawArrays(GL_LINE_STRIP, 0, numVertices);
+            glDrawArrays(GL_LINE_STRIP, firstVertex, numVertices);
+            drawCalls++;
             break;
         case LINE_LOOP:
-            glDrawArrays(GL_LINE_LOOP, 0, numVertices);
+            glDrawArrays(GL_LINE_LOOP, firstVertex, numVertices);
+            drawCalls++;
             break;
         case TRIANGLES:
-            glDrawArrays(GL_TRIANGLES, 0, numVertices);
+            drawTriangles();
+            drawCalls++;
             break;
         case TRIANGLE_STRIP:
-            glDrawArrays(GL_TRIANGLE_STRIP, 0, numVertices);
+            drawTriangles();
+            drawCalls++;
             break;
         case TRIANGLE_FAN:
             if (fanOffsets.size() > 1) {
-                for (size_t i = 0; i < fanOffsets.size(); ++i) {
-                    int start = fanOffsets[i];
-                    int count = (i == fanOffsets.size() - 1) ? 
-                               numVertices - start : 
-                               fanOffsets[i + 1] - start;
-                    
-                    if (count > 0) {
-                        glDrawArrays(GL_TRIANGLE_FAN, start, count);
-                    }
-                }
+                drawCalls += rangeBatch.submit(batchMode);
             } else {
-                glDrawArrays(GL_TRIANGLE_FAN, 0, numVertices);
+                drawTriangles();
+                drawCalls++;
             }
             break;
     }
 }
 
+void Model::renderProcedural() {
+    Profiler::Scope scope(profiler, "draw_procedural");
+    if (ngonComputed) {
+        drawCalls += ngonCompute.draw();
+        return;
+    }
+
+    GLenum mode = GL_POINTS;
+    int primitive = 0;
+    if (primitiveType == LINES) {
+        mode = GL_LINES;
+        primitive = 1;
+    } else if (primitiveType == TRIANGLE_FAN) {
+        mode = GL_TRIANGLE_FAN;
+        primitive = 2;
+    }
+
+    renderState.uniform1i(NGON_PRIMITIVE_LOCATION, primitive);
+    renderState.bindVertexArray(ngonVAO);
+    // every instance is a separate primitive, fans and lines do not connect across polygons
+    glDrawArraysInstanced(mode, 0, ngonVerticesPerInstance, taskSettings.ngonCount);
+    drawCalls++;
+}
+
+bool Model::isThickLineTask() const {
+    bool lineTask = primitiveType == LINES || primitiveType == LINE_STRIP || primitiveType == LINE_LOOP;
+    return thickLines && lineVariants.size() > 0 && lineTask && rasterMode == GL_FILL && !atlasMode &&
+           !isProceduralTask() && currentTask != MESH_TASK;
+}
+
+void Model::renderThickLines() {
+    if (linesDirty) {
+        GLenum mode = primitiveType == LINES ? GL_LINES : primitiveType == LINE_STRIP ? GL_LINE_STRIP : GL_LINE_LOOP;
+        // the colors the vertex shader would give these vertices, the buffer has none
+        if (colorSeed != 0) ngonGenerator.randomColors(geometry.colors(), geometry.size(), colorSeed);
+        lines.build(mode, geometry.positions(), geometry.colors(), geometry.size());
+        linesDirty = false;
+    }
+
+    Profiler::Scope scope(profiler, "draw_lines");
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    renderState.uniform3f(LINE_LOCATION, glm::vec3((float)viewport[2], (float)viewport[3], lineWidth));
+    renderState.uniform1i(LINE_JOIN_LOCATION, lineJoin == LineRenderer::ROUND ? 1 : 0);
+    drawCalls += lines.draw();
+}
+
+void Model::renderSoftware() {
+    Profiler::Scope scope(profiler, "draw_software");
+    drawCalls = 0;
+    if (currentTask == MESH_TASK || geometry.size() == 0) return;
+
+    // the uniforms and fixed-function state updateRenderSettings sets for GL
+    SoftwareRasterizer::State state;
+    state.view = glm::vec3(viewCenter, viewZoom);
+    state.pointSize = pointSize;
+    state.lineWidth = lineWidth;
+    state.flatShading = taskSettings.flatMode;
+    state.roundPoints = (currentVariant() & POINT_AA_VARIANT) != 0;
+    state.polygonMode = rasterMode;
+    state.colorSeed = colorSeed;
+
+    GLenum mode = GL_TRIANGLES;
+    switch (primitiveType) {
+        case POINTS: mode = GL_POINTS; break;
+        case LINES: mode = GL_LINES; break;
+        case LINE_STRIP: mode = GL_LINE_STRIP; break;
+        case LINE_LOOP: mode = GL_LINE_LOOP; break;
+        case TRIANGLES: mode = GL_TRIANGLES; break;
+        case TRIANGLE_STRIP: mode = GL_TRIANGLE_STRIP; break;
+        case TRIANGLE_FAN: mode = GL_TRIANGLE_FAN; break;
+    }
+
+    const float* positions = geometry.positions();
+    const float* colors = geometry.colors();
+    const uint32_t* elements = numIndices > 0 ? indices.data() : nullptr;
+    size_t first = elements ? (size_t)firstIndex : (size_t)firstVertex;
+    size_t count = elements ? (size_t)numIndices : (size_t)numVertices;
+
+    if (currentTask == 9) {
+        // the two passes of renderTask8bSpecial: filled front faces, then back faces as lines
+        state.cullFace = GL_BACK;
+        state.polygonMode = GL_FILL;
+        software->draw(mode, state, positions, colors, first, count, elements);
+        state.cullFace = GL_FRONT;
+        state.polygonMode = GL_LINE;
+        software->draw(mode, state, positions, colors, first, count, elements);
+        drawCalls += 2;
+        return;
+    }
+
+    if (primitiveType == TRIANGLE_FAN && fanOffsets.size() > 1) {
+        for (size_t i = 0; i < fanOffsets.size(); ++i) {
+            int start = fanOffsets[i];
+            int end = i + 1 < fanOffsets.size() ? fanOffsets[i + 1] : numVertices;
+            software->draw(mode, state, positions, colors, (size_t)(firstVertex + start), (size_t)(end - start));
+            drawCalls++;
+        }
+        return;
+    }
+
+    software->draw(mode, state, positions, colors, first, count, elements);
+    drawCalls++;
+}
+
+void Model::drawTriangles() {
+    GLenum mode = GL_TRIANGLES;
+    if (primitiveType == TRIANGLE_STRIP) mode = GL_TRIANGLE_STRIP;
+    else if (primitiveType == TRIANGLE_FAN) mode = GL_TRIANGLE_FAN;
+
+    if (numIndices > 0) {
+        glDrawElements(mode, numIndices, GL_UNSIGNED_INT, (void*)(firstIndex * sizeof(GLuint)));
+    } else {
+        glDrawArrays(mode, firstVertex, numVertices);
+    }
+}
+
 void Model::renderTask8bSpecial() {
-    glEnable(GL_CULL_FACE); // Включаем отсечение граней
-    glLineWidth(lineWidth); // установили ширину
+    renderState.cullFace(true); // Включаем отсечение граней (выключает updateRenderSettings для других заданий)
+    renderState.lineWidth(lineWidth); // установили ширину
 
     // Рисуем только лицевые заликвкой 
-    glCullFace(GL_BACK);    //  отсекли задние грани 
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    glDrawArrays(GL_TRIANGLES, 0, numVertices);
+    {
+        Profiler::Scope scope(profiler, "task8b_fill");
+        renderState.cullFaceMode(GL_BACK);    //  отсекли задние грани 
+        renderState.polygonMode(GL_FILL);
+        drawTriangles();
+    }
 
     // Рисуем только задние грани линий
-    glCullFace(GL_FRONT); //  отсекаем лицевые грани 
-    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE); 
-    glDrawArrays(GL_TRIANGLES, 0, numVertices); 
+    {
+        Profiler::Scope scope(profiler, "task8b_wire");
+        renderState.cullFaceMode(GL_FRONT); //  отсекаем лицевые грани 
+        renderState.polygonMode(GL_LINE); 
+        drawTriangles(); 
+    }
 
-    glDisable(GL_CULL_FACE); 
+    drawCalls += 2;
 }
 
 void Model::updateRenderSettings() {
-    glUseProgram(shaderProgram);
-    
-    int smoothModeLoc = glGetUniformLocation(shaderProgram, "u_smoothMode");
-    glUniform1i(smoothModeLoc, smoothMode);
-
-    int flatModeLoc = glGetUniformLocation(shaderProgram, "u_flatMode");
-    glUniform1i(flatModeLoc, flatMode);
+    // specialized variants instead of per-fragment branches on flat/smooth uniforms
+    ShaderVariants& variants = isProceduralTask() ? (ngonComputed ? shaderVariants : ngonVariants)
+                             : isThickLineTask() ? lineVariants
+                             : shaderVariants;
+    renderState.useProgram(variants.get(currentVariant()));
+    renderState.uniform3f(VIEW_LOCATION, glm::vec3(viewCenter, viewZoom));
+    if (&variants == &shaderVariants) {
+        bool generated = !atlasMode && currentTask != MESH_TASK && !isProceduralTask();
+        renderState.uniform1i(COLOR_SEED_LOCATION, generated ? (GLint)colorSeed : 0);
+    }
 
-    if (primitiveType == POINTS) {
-        glPointSize(pointSize);
-    } else if (primitiveType == LINES || primitiveType == LINE_STRIP || primitiveType == LINE_LOOP) {
-        glLineWidth(lineWidth);
+    renderState.polygonMode(rasterMode);
+    // strips and fans from the stripifier are separated by Stripifier::RESTART_INDEX
+    renderState.primitiveRestart(numIndices > 0 && (primitiveType == TRIANGLE_STRIP || primitiveType == TRIANGLE_FAN));
+    if (currentTask != 9) {
+        renderState.cullFace(false);
     }
-    
-}
 
-glm::vec3 Model::getRandomColor() {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+    if (primitiveType == POINTS || rasterMode == GL_POINT) {
+        renderState.pointSize(pointSize);
+    } else if (primitiveType == LINES || primitiveType == LINE_STRIP || primitiveType == LINE_LOOP || rasterMode == GL_LINE) {
+        renderState.lineWidth(lineWidth);
+    }
     
-    return glm::vec3(dis(gen), dis(gen), dis(gen));
 }
 
 void Model::setCurrentTask(int task) {
+    if (task == MESH_TASK && !mesh.isLoaded()) return;
+
+    taskRequests++;
+    if (task == MESH_TASK) {
+        selectMesh();
+        return;
+    }
+    if (asyncBuild && !atlasMode && !isProceduralTask(task) && !software) {
+        requestedTask = task; // pollBuild hands it to the worker, the current task stays on screen
+        return;
+    }
+    requestedTask = -1;
     currentTask = task;
-    
-    switch (currentTask) {
+
+    if (software) {
+        // CPU geometry only, drawn by renderSoftware
+        generateTask(task);
+    } else if (isProceduralTask()) {
+        setupNgonTask(task);
+    } else if (atlasMode) {
+        selectAtlasRange(task);
+    } else {
+        generateTask(task);
+        setupBuffers();
+    }
+
+    updateDrawBatch();
+}
+
+void Model::setAsyncBuild(bool enabled) {
+    if (!enabled) finishBuild();
+    asyncBuild = enabled;
+}
+
+void Model::finishBuild() {
+    while (isBuildPending()) {
+        buildThread.wait();
+        glFinish(); // the staging region of the previous copy is free after this
+        pollBuild();
+    }
+}
+
+void Model::pollBuild() {
+    if (buildThread.isReady()) adoptBuild();
+    if (requestedTask < 0 || !buildThread.isIdle()) return;
+
+    if (staging.getRegionSize() == 0) staging.reserve(1);
+    int region = nextRegion;
+    if (!staging.isRegionFree(region)) return; // still copied from by the GPU, try next frame
+
+    buildTask = requestedTask;
+    buildRequest = taskRequests;
+    buildRegion = region;
+    requestedTask = -1;
+    nextRegion = (nextRegion + 1) % staging.getRegions();
+
+    int task = buildTask;
+    int variant = takeVariant(task);
+    // copies: the setters may change both while the worker runs
+    TaskGenerator::Settings settings = taskSettings;
+    VertexFormat::Format format = vertexFormat;
+    char* destination = staging.regionData(region);
+    size_t capacity = staging.getRegionSize();
+    buildThread.submit([this, task, variant, settings, format, destination, capacity]() {
+        buildGeometry(task, variant, settings, format, destination, capacity);
+    });
+}
+
+void Model::buildGeometry(int task, int variant, const TaskGenerator::Settings& settings,
+                          VertexFormat::Format format, char* destination, size_t capacity) {
+    buildGenerator.generate(task, variant, settings);
+
+    const GeometryBuilder& built = buildGenerator.getGeometry();
+    const std::vector<GLuint>& builtIndices = buildGenerator.getIndices();
+    bool colors = buildGenerator.getColorSeed() == 0;
+    buildFormat = VertexFormat::resolve(format, built.positions(), built.size());
+    buildVertexBytes = built.size() * VertexFormat::stride(buildFormat, colors);
+    buildIndexBytes = builtIndices.size() * sizeof(GLuint);
+    buildStaged = buildVertexBytes + buildIndexBytes <= capacity;
+
+    if (buildStaged) {
+        packGeometry(buildFormat, built, colors, destination);
+        if (buildIndexBytes > 0) memcpy(destination + buildVertexBytes, builtIndices.data(), buildIndexBytes);
+    } else {
+        buildPacked.resize(buildVertexBytes);
+        packGeometry(buildFormat, built, colors, buildPacked.data());
+    }
+}
+
+void Model::adoptBuild() {
+    // another setCurrentTask came after this build was started
+    if (buildRequest != taskRequests) {
+        buildAllocations = buildGenerator.getGeometry().getAllocations();
+        buildThread.acknowledge();
+        return;
+    }
+
+    Profiler::Scope scope(profiler, "upload");
+
+    // the worker gets the old arena back, generate clears it anyway
+    takeTask(buildGenerator);
+    buildAllocations = buildGenerator.getGeometry().getAllocations();
+
+    currentTask = buildTask;
+    linesDirty = true;
+
+    if (buildStaged) {
+        createBuffers(buildFormat, colorSeed == 0, buildVertexBytes, nullptr, buildIndexBytes, nullptr);
+        staging.copy(buildRegion, 0, VBO, buildVertexBytes);
+        if (buildIndexBytes > 0) staging.copy(buildRegion, buildVertexBytes, EBO, buildIndexBytes);
+        staging.fence(buildRegion);
+    } else {
+        createBuffers(buildFormat, colorSeed == 0, buildVertexBytes, buildPacked.data(), buildIndexBytes,
+                      indices.data());
+        // the worker is idle, growing is safe; the next task of this size is staged
+        staging.reserve(buildVertexBytes + buildIndexBytes);
+        buildPacked = std::vector<char>();
+    }
+
+    updateDrawBatch();
+    buildThread.acknowledge();
+}
+
+void Model::updateDrawBatch() {
+    rangeBatch.begin(GL_TRIANGLE_FAN);
+    if (primitiveType != TRIANGLE_FAN || fanOffsets.size() < 2) return;
+
+    for (size_t i = 0; i < fanOffsets.size(); ++i) {
+        int start = fanOffsets[i];
+        int count = (i == fanOffsets.size() - 1) ? 
+                   numVertices - start : 
+                   fanOffsets[i + 1] - start;
+        rangeBatch.add(firstVertex + start, count);
+    }
+}
+
+void Model::setBatchMode(DrawBatch::SubmitMode mode) {
+    if (mode == DrawBatch::INDIRECT && !GLEW_VERSION_4_3) {
+        std::cout << "glMultiDrawArraysIndirect needs GL 4.3, using glMultiDrawArrays" << std::endl;
+        mode = DrawBatch::MULTI_DRAW;
+    }
+    batchMode = mode;
+}
+
+bool Model::loadMesh(const std::string& path) {
+    bool loaded = mesh.load(path, meshBudget);
+    if (loaded) {
+        std::cout << "Mesh " << path << ": " << mesh.getVertexCount() << " vertices, " << mesh.getIndexCount()
+                  << " indices, " << mesh.getChunkCount() << " chunks, "
+                  << VertexFormat::formatName(mesh.getVertexFormat())
+                  << (mesh.isStreamed() ? ", streamed" : ", resident") << std::endl;
+        setCurrentTask(MESH_TASK);
+    } else if (currentTask == MESH_TASK) {
+        setCurrentTask(1); // its buffers are gone
+    }
+    return loaded;
+}
+
+void Model::selectMesh() {
+    requestedTask = -1;
+    currentTask = MESH_TASK;
+
+    primitiveType = toPrimitiveType(mesh.getPrimitive());
+    rasterMode = GL_FILL;
+    fanOffsets.clear();
+    topologyReport = Stripifier::Report();
+    numVertices = (int)std::min<uint64_t>(mesh.getVertexCount(), INT32_MAX);
+    numIndices = (GLsizei)std::min<uint64_t>(mesh.getIndexCount(), INT32_MAX);
+    updateDrawBatch();
+}
+
+void Model::generateTask(int task) {
+    tasks.generate(task, takeVariant(task), taskSettings);
+    takeTask(tasks);
+}
+
+void Model::takeTask(TaskGenerator& generator) {
+    generator.swapArrays(geometry, indices, fanOffsets);
+    primitiveType = toPrimitiveType(generator.getPrimitive());
+    rasterMode = generator.getRasterMode();
+    colorSeed = generator.getColorSeed();
+    topologyReport = generator.getTopologyReport();
+    numVertices = (int)geometry.size();
+    firstVertex = 0;
+    firstIndex = 0;
+    numIndices = (GLsizei)indices.size();
+}
+
+int Model::takeVariant(int task) {
+    int& variant = nextVariant[task];
+    int current = variant;
+    variant = (variant + 1) % TaskGenerator::variantCount(task);
+    return current;
+}
+
+Model::PrimitiveType Model::toPrimitiveType(GLenum primitive) {
+    switch (primitive) {
+        case GL_POINTS: return POINTS;
+        case GL_LINES: return LINES;
+        case GL_LINE_STRIP: return LINE_STRIP;
+        case GL_LINE_LOOP: return LINE_LOOP;
+        case GL_TRIANGLE_STRIP: return TRIANGLE_STRIP;
+        case GL_TRIANGLE_FAN: return TRIANGLE_FAN;
+        default: return TRIANGLES;
+    }
+}
+
+bool Model::isProceduralTask(int task) const {
+    return proceduralNgons && (ngonVariants.size() > 0 || isComputeNgons()) && !software &&
+           (task == 1 || task == 2 || task == 6);
+}
+
+void Model::clearNgonBuffers() {
+    if (ngonInstanceVBO != 0) glDeleteBuffers(1, &ngonInstanceVBO);
+    if (ngonVAO != 0) {
+        renderState.vertexArrayDeleted(ngonVAO);
+        glDeleteVertexArrays(1, &ngonVAO);
+    }
+    ngonVAO = 0; ngonInstanceVBO = 0;
+}
+
+void Model::setupNgonTask(int task) {
+    // the same polygons as Task1(7, 0.5f), Task2(7, 0.5f), Task6(7, 0.5f) in TaskGenerator::generate
+    const int sides = 7;
+    const float radius = 0.5f;
+    bool colored = true;
+
+    switch (task) {
         case 1:
-            Task1(7, 0.5f);
+            primitiveType = POINTS;
+            ngonVerticesPerInstance = sides;
+            colored = false;
             break;
         case 2:
-            Task2(7, 0.5f);
-            break;
-        case 3:
-            Task3();
-            break;
-        case 4:
-            Task4();
-            break;
-        case 5:
-            Task5();
+            primitiveType = LINES;
+            ngonVerticesPerInstance = sides * 2;
             break;
         case 6:
-            Task6(7, 0.5f);
-            break;
-        case 7:
-            Task7();
-            break;
-        case 8:
-            Task8();
-            break;
-        case 9:
-            Task8b();
+            primitiveType = TRIANGLE_FAN;
+            ngonVerticesPerInstance = sides + 1;
             break;
     }
+
+    int ngonCount = taskSettings.ngonCount;
+    std::vector<NgonInstance> instances(ngonCount);
+    for (int k = 0; k < ngonCount; ++k) {
+        TaskGenerator::ngonLayout(ngonCount, k, radius, instances[k].center, instances[k].radius);
+        instances[k].sides = sides;
+        instances[k].seed = colored ? (GLuint)(k + 1) : 0;
+    }
+
+    fanOffsets.clear();
+    geometry.clear();
+    indices.clear();
+    rasterMode = GL_FILL;
+    firstVertex = 0;
+    firstIndex = 0;
+    numIndices = 0;
+    numVertices = ngonVerticesPerInstance * ngonCount;
+
+    clearNgonBuffers();
+    ngonComputed = isComputeNgons();
+    if (ngonComputed) {
+        ComputeGenerator::Expansion expansion = primitiveType == POINTS ? ComputeGenerator::POINTS
+                                              : primitiveType == LINES ? ComputeGenerator::LINES
+                                              : ComputeGenerator::TRIANGLE_FAN;
+        if (expansion == ComputeGenerator::TRIANGLE_FAN && ngonSubdivisions > 0) {
+            expansion = ComputeGenerator::TRIANGLES;
+            primitiveType = TRIANGLES;
+        }
+        // the vertices are written on the GPU, nothing is uploaded but the parameters
+        ngonCompute.generate(instances, expansion, ngonSubdivisions);
+        numVertices = (GLsizei)ngonCompute.getVertexCount();
+        return;
+    }
+
+    glGenVertexArrays(1, &ngonVAO);
+    glGenBuffers(1, &ngonInstanceVBO);
+
+    renderState.bindVertexArray(ngonVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, ngonInstanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(NgonInstance), instances.data(), GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(NgonInstance), (void*)offsetof(NgonInstance, center));
+    glEnableVertexAttribArray(0);
+    glVertexAttribDivisor(0, 1);
+
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(NgonInstance), (void*)offsetof(NgonInstance, radius));
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+
+    glVertexAttribIPointer(2, 1, GL_INT, sizeof(NgonInstance), (void*)offsetof(NgonInstance, sides));
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+
+    glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(NgonInstance), (void*)offsetof(NgonInstance, seed));
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
+
+    renderState.bindVertexArray(0);
+}
+
+void Model::clearAtlas() {
+    if (atlasEBO != 0) glDeleteBuffers(1, &atlasEBO);
+    if (atlasVBO != 0) glDeleteBuffers(1, &atlasVBO);
+    if (atlasVAO != 0) {
+        renderState.vertexArrayDeleted(atlasVAO);
+        glDeleteVertexArrays(1, &atlasVAO);
+    }
+    atlasVAO = 0; atlasVBO = 0; atlasEBO = 0;
+}
+
+void Model::buildAtlas() {
+    GeometryBuilder atlasGeometry;
+    std::vector<GLuint> atlasIndices;
+    // one buffer for all tasks, colors included
+    TaskGenerator::Settings settings = taskSettings;
+    settings.gpuColors = false;
+
+    atlasRanges.clear();
+    for (int task = 0; task <= 9; ++task) atlasTaskRanges[task].clear();
+
+    // every variant of every task (Task5 TRIANGLES, TRIANGLE_STRIP, TRIANGLE_FAN, Task8 GL_POINT, GL_LINE),
+    // range k of a task is its variant k
+    for (int task = 1; task <= 9; ++task) {
+        for (int variant = 0; variant < TaskGenerator::variantCount(task); ++variant) {
+            tasks.generate(task, variant, settings);
+            const GeometryBuilder& built = tasks.getGeometry();
+            const std::vector<GLuint>& builtIndices = tasks.getIndices();
+
+            TaskRange range;
+            range.primitiveType = toPrimitiveType(tasks.getPrimitive());
+            range.rasterMode = tasks.getRasterMode();
+            range.firstVertex = (GLint)atlasGeometry.size();
+            range.vertexCount = (GLsizei)built.size();
+            range.firstIndex = (GLint)atlasIndices.size();
+            range.indexCount = (GLsizei)builtIndices.size();
+            range.fanOffsets = tasks.getFanOffsets();
+
+            for (GLuint index : builtIndices) {
+                atlasIndices.push_back(index == Stripifier::RESTART_INDEX ? index : range.firstVertex + index);
+            }
+            size_t first = atlasGeometry.append(built.size());
+            memcpy(atlasGeometry.positions(first), built.positions(), built.size() * 3 * sizeof(float));
+            memcpy(atlasGeometry.colors(first), built.colors(), built.size() * 3 * sizeof(float));
+
+            atlasTaskRanges[task].push_back((int)atlasRanges.size());
+            atlasRanges.push_back(range);
+        }
+    }
+
+    // one format for all ranges, compact only if every task fits it
+    atlasFormat = VertexFormat::resolve(vertexFormat, atlasGeometry.positions(), atlasGeometry.size());
+    std::vector<char> packed(atlasGeometry.size() * VertexFormat::stride(atlasFormat));
+    VertexFormat::pack(atlasFormat, atlasGeometry.positions(), atlasGeometry.colors(), atlasGeometry.size(),
+                       packed.data());
+
+    clearAtlas();
+
+    glGenVertexArrays(1, &atlasVAO);
+    glGenBuffers(1, &atlasVBO);
+
+    renderState.bindVertexArray(atlasVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, atlasVBO);
+    // immutable storage: written once here, never reallocated on task switch
+    glBufferStorage(GL_ARRAY_BUFFER, packed.size(), packed.data(), 0);
+    VertexFormat::setAttributes(atlasFormat);
+
+    if (!atlasIndices.empty()) {
+        glGenBuffers(1, &atlasEBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, atlasEBO);
+        glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, atlasIndices.size() * sizeof(GLuint), atlasIndices.data(), 0);
+    }
+
+    renderState.bindVertexArray(0);
+}
+
+void Model::rebuildAtlas() {
+    if (!atlasMode) return;
+    buildAtlas();
+    // the ranges of the current task moved
+    setCurrentTask(currentTask);
+}
+
+void Model::selectAtlasRange(int task) {
+    if (task < 1 || task > 9 || atlasTaskRanges[task].empty()) return;
+
+    const TaskRange& range = atlasRanges[atlasTaskRanges[task][takeVariant(task)]];
+
+    primitiveType = range.primitiveType;
+    rasterMode = range.rasterMode;
+    firstVertex = range.firstVertex;
+    numVertices = range.vertexCount;
+    firstIndex = range.firstIndex;
+    numIndices = range.indexCount;
+    fanOffsets.assign(range.fanOffsets.begin(), range.fanOffsets.end());
+}
+
+void Model::setAtlasMode(bool enabled) {
+    if (enabled && atlasRanges.empty()) {
+        buildAtlas();
+    }
+    atlasMode = enabled;
+    setCurrentTask(currentTask);
+}
+
+void Model::setView(glm::vec2 center, float zoom) {
+    viewCenter = center;
+    viewZoom = std::min(1e6f, std::max(1e-3f, zoom));
+}
+
+glm::vec4 Model::getViewRect() const {
+    // clip space [-1, 1] maps back to center +- 1 / zoom
+    float half = 1.0f / viewZoom;
+    return glm::vec4(viewCenter.x - half, viewCenter.y - half, viewCenter.x + half, viewCenter.y + half);
 }
 
 void Model::key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
     if (action == GLFW_PRESS || action == GLFW_REPEAT) {
         switch (key) {
+            case GLFW_KEY_0: 
+                if (action == GLFW_PRESS) setCurrentTask(MESH_TASK); 
+                break;
             case GLFW_KEY_1: 
                 if (action == GLFW_PRESS) setCurrentTask(1); 
                 break;
@@ -260,488 +909,158 @@ void Model::key_callback(GLFWwindow* window, int key, int scancode, int action,
 
             case GLFW_KEY_F:
             if (action == GLFW_PRESS && currentTask != 1) {
-                flatMode = !flatMode;
+                taskSettings.flatMode = !taskSettings.flatMode;
                 const char* modes[] = {"SMOOTH", "FLAT"};
-                std::cout << "Flat mode: " << modes[flatMode ? 1 : 0] << std::endl;
+                std::cout << "Flat mode: " << modes[taskSettings.flatMode ? 1 : 0] << std::endl;
                 updateRenderSettings();
+                // strips and fans are built for the shading mode
+                if (taskSettings.optimizeTopology) {
+                    if (atlasMode) rebuildAtlas();
+                    else setCurrentTask(currentTask);
+                }
             }
             break;
-        }
-    }
-}
-
-void Model::Task1(int n, float radius) {
-    fanOffsets.clear(); 
-    vertices.clear();
-    colors.clear();
-    
-    for (int i = 0; i < n; ++i) {
-        float angle = 2.0f * M_PI * i / n;
-        float x = radius * cos(angle);
-        float y = radius * sin(angle);
-        
-        vertices.push_back(x);
-        vertices.push_back(y);
-        vertices.push_back(0.0f);
-        
-        colors.push_back(1.0f);
-        colors.push_back(1.0f);
-        colors.push_back(1.0f);
-    }
-    
-    numVertices = n;
-    primitiveType = POINTS;
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    setupBuffers();
-}
-
-void Model::Task2(int n, float radius) {
-    fanOffsets.clear(); 
-    vertices.clear();
-    colors.clear();
-    
-    for (int i = 0; i < n; ++i) {
-        float angle1 = 2.0f * M_PI * i / n;
-        float angle2 = 2.0f * M_PI * (i + 1) / n;
-        
-        vertices.push_back(radius * cos(angle1));
-        vertices.push_back(radius * sin(angle1));
-        vertices.push_back(0.0f);
-        
-        vertices.push_back(radius * cos(angle2));
-        vertices.push_back(radius * sin(angle2));
-        vertices.push_back(0.0f);
-        
-        for (int j = 0; j < 2; ++j) {
-            glm::vec3 color = getRandomColor();
-            colors.push_back(color.r);
-            colors.push_back(color.g);
-            colors.push_back(color.b);
-        }
-    }
-    
-    numVertices = n * 2;
-    primitiveType = LINES;
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    setupBuffers();
-}
 
-void Model::Task3() {
-    fanOffsets.clear(); 
-    vertices.clear();
-    colors.clear();
-    
-    std::vector<glm::vec2> points = {
-        {-0.85f, 0.48f},   // 1
-        {-0.623f, -0.26f}, // 2
-        {-0.349f, 0.12f},  // 3
-        {0.075f, 0.12f},   // 4 
-        {-0.05f, 0.6f},    // 5 
-        {0.740f, 0.6f},    // 6
-        {0.130f, -0.454f}  // 7
-    };
-    
-    for (const auto& point : points) {
-        vertices.push_back(point.x);
-        vertices.push_back(point.y);
-        vertices.push_back(0.0f);
-        
-        glm::vec3 color = getRandomColor();
-        colors.push_back(color.r);
-        colors.push_back(color.g);
-        colors.push_back(color.b);
-    }
-    
-    numVertices = 7;
-    primitiveType = LINE_STRIP;
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    setupBuffers();
-}
+            case GLFW_KEY_I:
+            if (action == GLFW_PRESS) {
+                setIndexedGeometry(!taskSettings.indexedGeometry);
+                const char* modes[] = {"OFF", "ON"};
+                std::cout << "Indexed geometry: " << modes[taskSettings.indexedGeometry ? 1 : 0] 
+                          << " (applies on next task switch)" << std::endl;
+                rebuildAtlas();
+            }
+            break;
 
-void Model::Task4() {
-    fanOffsets.clear(); 
-    vertices.clear();
-    colors.clear();
-    
-    std::vector<glm::vec2> points = {
-        {-0.7f, 0.8f},     //1 
-        {0.7f, 0.8f},      //2
-        {0.2f, 0.5f},      //3
-        {0.2f, 0.0f},      //4
-        {0.6f, 0.0f},      //5
-        {0.6f, -0.4f},     //6
-        {-0.6f, -0.4f},    //7
-        {-0.1358f,0.2985f},//8
-    };
-    
-    for (const auto& point : points) {
-        vertices.push_back(point.x);
-        vertices.push_back(point.y);
-        vertices.push_back(0.0f);
-        
-        glm::vec3 color = getRandomColor();
-        colors.push_back(color.r);
-        colors.push_back(color.g);
-        colors.push_back(color.b);
-    }
-    
-    numVertices = points.size();
-    primitiveType = LINE_LOOP;
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    setupBuffers();
-}
+            case GLFW_KEY_T:
+            if (action == GLFW_PRESS) {
+                setTopologyOptimization(!taskSettings.optimizeTopology);
+                const char* modes[] = {"OFF", "ON"};
+                std::cout << "Strips/fans: " << modes[taskSettings.optimizeTopology ? 1 : 0]
+                          << " (applies on next task switch)" << std::endl;
+                rebuildAtlas();
+            }
+            break;
 
-void Model::Task5() {
-    fanOffsets.clear(); 
-    vertices.clear();
-    colors.clear();
+            case GLFW_KEY_B:
+            if (action == GLFW_PRESS) {
+                const char* modes[] = {"LOOP", "MULTI_DRAW", "INDIRECT"};
+                setBatchMode((DrawBatch::SubmitMode)((batchMode + 1) % 3));
+                std::cout << "Batch mode: " << modes[batchMode] << std::endl;
+            }
+            break;
 
-    static int renderMode = 0; // 0 - TRIANGLES, 1 - TRIANGLE_STRIP, 2 - TRIANGLE_FAN
-    
-    switch (renderMode) {
-        case 0: // GL_TRIANGLES
-        {
-            std::vector<glm::vec2> verticest5 = {
-                {-0.7f, 0.8f},      // 0
-                {0.7f, 0.8f},       // 1
-                {0.2f, 0.5f},       // 2
-                {0.2f, 0.0f},       // 3
-                {0.6f, 0.0f},       // 4
-                {0.6f, -0.4f},      // 5
-                {-0.6f, -0.4f},     // 6
-                {-0.1358f, 0.2985f} // 7
-            };
-
-            std::vector<glm::ivec3> triangles = {
-                {0, 1, 2},    // (1-2-3)
-                {0, 2, 7},    // (1-3-8)
-                {2, 3, 7},    // (3-4-8)
-                {3, 4, 5},    // (4-5-6)
-                {3, 5, 6},    // (4-6-7)
-                {3, 6, 7}     // (4-7-8)
-            };
-
-            int vertexCount = 0;
-            for (const auto& tri : triangles) {
-                vertices.push_back(verticest5[tri.x].x);
-                vertices.push_back(verticest5[tri.x].y);
-                vertices.push_back(0.0f);
-                    
-                vertices.push_back(verticest5[tri.y].x);
-                vertices.push_back(verticest5[tri.y].y);
-                vertices.push_back(0.0f);
-                    
-                vertices.push_back(verticest5[tri.z].x);
-                vertices.push_back(verticest5[tri.z].y);
-                vertices.push_back(0.0f);
-                    
-                glm::vec3 color1 = getRandomColor();
-                glm::vec3 color2 = getRandomColor(); 
-                glm::vec3 color3 = getRandomColor();
-                
-                colors.push_back(color1.r); colors.push_back(color1.g); colors.push_back(color1.b);
-                colors.push_back(color2.r); colors.push_back(color2.g); colors.push_back(color2.b);
-                colors.push_back(color3.r); colors.push_back(color3.g); colors.push_back(color3.b);
-                vertexCount += 3;
+            case GLFW_KEY_P:
+            if (action == GLFW_PRESS) {
+                // CPU -> instanced -> compute shader, when available
+                int mode = !proceduralNgons ? 0 : isComputeNgons() ? 2 : 1;
+                mode = (mode + 1) % (ngonCompute.isAvailable() ? 3 : 2);
+                proceduralNgons = mode > 0;
+                computeNgons = mode == 2;
+                const char* modes[] = {"CPU", "GPU", "GPU compute"};
+                std::cout << "N-gon generation: " << modes[mode] << std::endl;
+                if (currentTask == 1 || currentTask == 2 || currentTask == 6) setCurrentTask(currentTask);
             }
+            break;
 
-            primitiveType = TRIANGLES;
-            std::cout << "GL_TRIANGLES(" 
-                      << vertexCount << " vertex)" << std::endl;
+            case GLFW_KEY_EQUAL:
+            case GLFW_KEY_MINUS:
+            if (action == GLFW_PRESS) {
+                setNgonCount(key == GLFW_KEY_EQUAL ? taskSettings.ngonCount * 10 : taskSettings.ngonCount / 10);
+                std::cout << "N-gon count: " << taskSettings.ngonCount << std::endl;
+                if (atlasMode) {
+                    rebuildAtlas();
+                } else if (currentTask == 1 || currentTask == 2 || currentTask == 6) {
+                    setCurrentTask(currentTask);
+                }
+            }
             break;
-        }
-        
-        case 1: // GL_TRIANGLE_STRIP
-        {
-            std::vector<glm::vec2> triangleStrip = {
-                {0.7f, 0.8f},        // 2
-                {-0.7f, 0.8f},       // 1
-                {0.2f, 0.5f},        // 3
-                {-0.1358f,0.2985f},  // 4
-                {0.2f, 0.0f},        // 5
-                {-0.6f, -0.4f},      // 6
-                {0.6f, 0.0f},        // 7
-                {0.6f, -0.4f},       // 8
-            };
-
-            for (int i = 0; i < triangleStrip.size(); ++i) {
-                glm::vec2 vertex = triangleStrip[i];
-                vertices.push_back(vertex.x); 
-                vertices.push_back(vertex.y); 
-                vertices.push_back(0.0f);
-                
-                glm::vec3 color = getRandomColor();
-                colors.push_back(color.r);
-                colors.push_back(color.g);
-                colors.push_back(color.b);
+
+            case GLFW_KEY_A:
+            if (action == GLFW_PRESS) {
+                const char* modes[] = {"OFF", "ON"};
+                std::cout << "Geometry atlas: " << modes[atlasMode ? 0 : 1] << std::endl;
+                setAtlasMode(!atlasMode);
             }
-        
-            primitiveType = TRIANGLE_STRIP;
-            std::cout << "GL_TRIANGLE_STRIP (" 
-                    << triangleStrip.size() << " vertex)" << std::endl;
             break;
-        }
-        
-        case 2: // GL_TRIANGLE_FAN
-        {
-            fanOffsets.clear();
-            std::vector<glm::vec2> triangleFan1 = {
-                {0.2f, 0.0f}, {0.6f, 0.0f}, {0.6f, -0.4f}, 
-                {-0.6f, -0.4f}, {-0.1358f, 0.2985f}
-            };
-         
-            std::vector<glm::vec2> triangleFan2 = {
-                {-0.7f, 0.8f}, {0.7f, 0.8f}, {0.2f, 0.5f}, {0.2f, 0.0f}
-            };
-        
-            fanOffsets.push_back(0); 
-            fanOffsets.push_back(triangleFan1.size()); 
-
-            for (const auto& vertex : triangleFan1) {
-                vertices.push_back(vertex.x); 
-                vertices.push_back(vertex.y); 
-                vertices.push_back(0.0f);
-                
-                glm::vec3 color = getRandomColor();
-                colors.push_back(color.r);
-                colors.push_back(color.g);
-                colors.push_back(color.b);
+
+            case GLFW_KEY_V:
+            if (action == GLFW_PRESS) {
+                setVertexFormat((VertexFormat::Format)((vertexFormat + 1) % 4));
+                std::cout << "Vertex format: " << VertexFormat::formatName(vertexFormat)
+                          << " (applies on next task switch)" << std::endl;
+                rebuildAtlas();
             }
-        
-            for (const auto& vertex : triangleFan2) {
-                vertices.push_back(vertex.x); 
-                vertices.push_back(vertex.y); 
-                vertices.push_back(0.0f);
-                
-                glm::vec3 color = getRandomColor();
-                colors.push_back(color.r);
-                colors.push_back(color.g);
-                colors.push_back(color.b);
+            break;
+
+            case GLFW_KEY_W:
+            if (action == GLFW_PRESS) {
+                const char* modes[] = {"OFF", "ON"};
+                setAsyncBuild(!asyncBuild);
+                std::cout << "Background task build: " << modes[asyncBuild ? 1 : 0] << std::endl;
             }
-        
-            primitiveType = TRIANGLE_FAN;
-            numVertices = vertices.size() / 3;
-            
-            std::cout << "GL_TRIANGLE_FAN (" << triangleFan1.size() + triangleFan2.size() << " vertex)" << std::endl;
             break;
-        }
-    }
-    
-    numVertices = vertices.size() / 3;
 
-    renderMode = (renderMode + 1) % 3;
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    setupBuffers();
-}
+            case GLFW_KEY_LEFT:
+            case GLFW_KEY_RIGHT:
+            case GLFW_KEY_DOWN:
+            case GLFW_KEY_UP: {
+                // a tenth of the visible width per press, held keys repeat
+                float step = 0.1f / viewZoom;
+                glm::vec2 offset(key == GLFW_KEY_LEFT ? -step : key == GLFW_KEY_RIGHT ? step : 0.0f,
+                                 key == GLFW_KEY_DOWN ? -step : key == GLFW_KEY_UP ? step : 0.0f);
+                setView(viewCenter + offset, viewZoom);
+                updateRenderSettings();
+            }
+            break;
 
-void Model::Task6(int n, float radius) {
-    fanOffsets.clear(); 
-    vertices.clear();
-    colors.clear();
-    
-    vertices.push_back(radius * cos(0));
-    vertices.push_back(radius * sin(0));
-    vertices.push_back(0.0f);
-    
-    for (int i = 1; i <= n; ++i) {
-        float angle = 2.0f * M_PI * i / n;
-        float x = radius * cos(angle);
-        float y = radius * sin(angle);
-        
-        vertices.push_back(x);
-        vertices.push_back(y);
-        vertices.push_back(0.0f);
-        
-        glm::vec3 color = getRandomColor();
-        colors.push_back(color.r);
-        colors.push_back(color.g);
-        colors.push_back(color.b);
-    }
-    
-    numVertices = n + 2;
-    primitiveType = TRIANGLE_FAN;
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    setupBuffers();
-}
-
-void Model::Task7() { 
-    fanOffsets.clear(); 
-    vertices.clear();
-    colors.clear();
-
-    std::vector<glm::vec2> vertices7_points = {
-        {-0.5f, 0.8f},     // 0 - vertex 1
-        {0.7f, 0.7f},      // 1 - vertex 2  
-        {-0.1f, 0.5f},     // 2 - vertex 3
-        {-0.4f, -0.1f},    // 3 - vertex 4
-        {0.4f, -0.5f},     // 4 - vertex 5
-        {0.1f, -0.2f},     // 5 - vertex 6
-        {-0.1f, -0.6f},    // 6 - vertex 7
-        {-0.8, 0.0},       // 7 - vertex 8
-        {0.8f, 0.0f},      // 8 - vertex 9
-    };
-    
-    std::vector<glm::ivec3> triangles7_indices = {
-        {0, 1, 2},
-        {0, 2, 7},
-        {2, 3, 7},
-        {3, 5, 6},
-        {3, 6, 7},
-        {1, 2, 8},
-        {2, 8, 4},
-    };
-
-    for (const auto& tri : triangles7_indices) {
-        vertices.push_back(vertices7_points[tri.x].x);
-        vertices.push_back(vertices7_points[tri.x].y);
-        vertices.push_back(0.0f);
-            
-        vertices.push_back(vertices7_points[tri.y].x);
-        vertices.push_back(vertices7_points[tri.y].y);
-        vertices.push_back(0.0f);
-            
-        vertices.push_back(vertices7_points[tri.z].x);
-        vertices.push_back(vertices7_points[tri.z].y);
-        vertices.push_back(0.0f);
-            
-        glm::vec3 color1 = getRandomColor();
-        glm::vec3 color2 = getRandomColor(); 
-        glm::vec3 color3 = getRandomColor();
-        
-        colors.push_back(color1.r); colors.push_back(color1.g); colors.push_back(color1.b);
-        colors.push_back(color2.r); colors.push_back(color2.g); colors.push_back(color2.b);
-        colors.push_back(color3.r); colors.push_back(color3.g); colors.push_back(color3.b);
-    }
+            case GLFW_KEY_Z:
+            case GLFW_KEY_X:
+                setView(viewCenter, key == GLFW_KEY_Z ? viewZoom * 1.25f : viewZoom / 1.25f);
+                std::cout << "Zoom: " << viewZoom << std::endl;
+                updateRenderSettings();
+                break;
 
-    primitiveType = TRIANGLES;
-    
-    numVertices = vertices.size() / 3;
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    setupBuffers();
-}
-
-void Model::Task8() {
-    fanOffsets.clear(); 
-    vertices.clear();
-    colors.clear();
-
-    std::vector<glm::vec2> vertices7_points = {
-        {-0.5f, 0.8f},     // 0 - vertex 1
-        {0.7f, 0.7f},      // 1 - vertex 2  
-        {-0.1f, 0.5f},     // 2 - vertex 3
-        {-0.4f, -0.1f},    // 3 - vertex 4
-        {0.4f, -0.5f},     // 4 - vertex 5
-        {0.1f, -0.2f},     // 5 - vertex 6
-        {-0.1f, -0.6f},    // 6 - vertex 7
-        {-0.8f, 0.0f},     // 7 - vertex 8
-        {0.8f, 0.0f},      // 8 - vertex 9
-    };
-    
-    std::vector<glm::ivec3> triangles7_indices = {
-        {0, 1, 2},
-        {0, 2, 7},
-        {2, 3, 7},
-        {3, 5, 6},
-        {3, 6, 7},
-        {1, 2, 8},
-        {2, 8, 4},
-    };
-
-    for (const auto& tri : triangles7_indices) {
-        vertices.push_back(vertices7_points[tri.x].x);
-        vertices.push_back(vertices7_points[tri.x].y);
-        vertices.push_back(0.0f);
-            
-        vertices.push_back(vertices7_points[tri.y].x);
-        vertices.push_back(vertices7_points[tri.y].y);
-        vertices.push_back(0.0f);
-            
-        vertices.push_back(vertices7_points[tri.z].x);
-        vertices.push_back(vertices7_points[tri.z].y);
-        vertices.push_back(0.0f);
-            
-        glm::vec3 color1 = getRandomColor();
-        glm::vec3 color2 = getRandomColor(); 
-        glm::vec3 color3 = getRandomColor();
-        
-        colors.push_back(color1.r); colors.push_back(color1.g); colors.push_back(color1.b);
-        colors.push_back(color2.r); colors.push_back(color2.g); colors.push_back(color2.b);
-        colors.push_back(color3.r); colors.push_back(color3.g); colors.push_back(color3.b);
-    }
-
-    primitiveType = TRIANGLES;
-    numVertices = vertices.size() / 3;
-    setupBuffers();
-    
-    switch (polygonMode) {
-        case 0: 
-            glPolygonMode(GL_FRONT_AND_BACK, GL_POINT);
-            glPointSize(pointSize);
-            std::cout << "8A::GL_POINT" << std::endl;
+            case GLFW_KEY_R:
+            if (action == GLFW_PRESS) {
+                setView(glm::vec2(0.0f), 1.0f);
+                std::cout << "View reset" << std::endl;
+                updateRenderSettings();
+            }
             break;
-            
-        case 1: 
-            glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-            glLineWidth(lineWidth);
-            std::cout << "8C::GL_LINE" << std::endl;
+
+            case GLFW_KEY_C:
+            if (action == GLFW_PRESS) {
+                const char* modes[] = {"vertex buffer", "shader hash"};
+                setGpuColors(!taskSettings.gpuColors, taskSettings.colorSeedBase);
+                std::cout << "Colors: " << modes[taskSettings.gpuColors ? 1 : 0] << std::endl;
+                if (!atlasMode && currentTask != MESH_TASK && !isProceduralTask()) setCurrentTask(currentTask);
+            }
             break;
-    }
 
-    polygonMode = (polygonMode + 1) % 2; // 0->1 1->0
-}
+            case GLFW_KEY_H:
+            if (action == GLFW_PRESS) {
+                // GL_LINES -> quads with miter joins -> quads with round joins
+                const char* modes[] = {"GL_LINES", "quads, miter joins", "quads, round joins"};
+                int mode = !thickLines ? 1 : lineJoin == LineRenderer::MITER ? 2 : 0;
+                setThickLines(mode != 0, mode == 2 ? LineRenderer::ROUND : LineRenderer::MITER);
+                std::cout << "Lines: " << modes[mode] << std::endl;
+            }
+            break;
 
-void Model::Task8b() {
-    fanOffsets.clear(); 
-    vertices.clear();
-    colors.clear();
+            case GLFW_KEY_G:
+            if (action == GLFW_PRESS && profiler) {
+                profiler->printSummary(std::cout);
+            }
+            break;
 
-    std::vector<glm::vec2> vertices7_points = {
-        {-0.5f, 0.8f},     // 0 - vertex 1
-        {0.7f, 0.7f},      // 1 - vertex 2  
-        {-0.1f, 0.5f},     // 2 - vertex 3
-        {-0.4f, -0.1f},    // 3 - vertex 4
-        {0.4f, -0.5f},     // 4 - vertex 5
-        {0.1f, -0.2f},     // 5 - vertex 6
-        {-0.1f, -0.6f},    // 6 - vertex 7
-        {-0.8f, 0.0f},     // 7 - vertex 8
-        {0.8f, 0.0f},      // 8 - vertex 9
-    };
-    
-    std::vector<glm::ivec3> triangles7_indices = {
-        {0, 1, 2},
-        {0, 2, 7},
-        {7, 3, 2},
-        {3, 5, 6},
-        {3, 6, 7},
-        {1, 2, 8},
-        {2, 8, 4},
-    };
-
-    for (const auto& tri : triangles7_indices) {
-        vertices.push_back(vertices7_points[tri.x].x);
-        vertices.push_back(vertices7_points[tri.x].y);
-        vertices.push_back(0.0f);
-            
-        vertices.push_back(vertices7_points[tri.y].x);
-        vertices.push_back(vertices7_points[tri.y].y);
-        vertices.push_back(0.0f);
-            
-        vertices.push_back(vertices7_points[tri.z].x);
-        vertices.push_back(vertices7_points[tri.z].y);
-        vertices.push_back(0.0f);
-            
-        glm::vec3 color1 = getRandomColor();
-        glm::vec3 color2 = getRandomColor(); 
-        glm::vec3 color3 = getRandomColor();
-        
-        colors.push_back(color1.r); colors.push_back(color1.g); colors.push_back(color1.b);
-        colors.push_back(color2.r); colors.push_back(color2.g); colors.push_back(color2.b);
-        colors.push_back(color3.r); colors.push_back(color3.g); colors.push_back(color3.b);
+            case GLFW_KEY_E:
+            if (action == GLFW_PRESS && profiler) {
+                profiler->flush();
+                bool written = profiler->writeCsv("profile.csv") && profiler->writeJson("profile.json");
+                std::cout << (written ? "Profile written to profile.csv, profile.json" : "Could not write the profile")
+                          << " (" << profiler->getHistory().size() << " frames)" << std::endl;
+            }
+            break;
+        }
     }
-
-    primitiveType = TRIANGLES;
-    numVertices = vertices.size() / 3;
-    setupBuffers();
-
-    std::cout << "8B::GL_FILL_AND_GL_LINE" << std::endl;            
-}
\ No newline at end of file
+}
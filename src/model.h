@@ -4,10 +4,29 @@
 #include <vector>
 #include <string>
 #include <functions.h>
+#include <render_state.h>
+#include <draw_batch.h>
+#include <ngon_generator.h>
+#include <stripifier.h>
+#include <task_generator.h>
+#include <program_cache.h>
+#include <shader_variants.h>
+#include <profiler.h>
+#include <build_thread.h>
+#include <compute_generator.h>
+#include <staging_buffer.h>
+#include <vertex_format.h>
+#include <geometry_builder.h>
+#include <mesh_stream.h>
+#include <line_renderer.h>
+#include <software_rasterizer.h>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <random>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
 
 class Model {
     public:
@@ -23,10 +42,78 @@ class Model {
         Model();
         ~Model();
 
-        /// @brief 
+        /// @brief Starts compiling every variant of the main program (flat/smooth x point AA),
+        ///        render picks the one matching the current state
         /// @param vertexPath 
         /// @param fragmentPath 
-        void initialize(const char* vertexPath, const char* fragmentPath); // set shaderProgram filed?
+        void initialize(const char* vertexPath, const char* fragmentPath);
+
+        /// @brief Makes initialize/initializeNgon load programs through the cache instead of compiling
+        ///        from source every time. Call before initialize.
+        /// @param cache Owned by the caller, nullptr to compile from source
+        void setProgramCache(ProgramCache* cache) { programCache = cache; }
+
+        /// @brief Times the render passes and buffer uploads as profiler scopes
+        ///        (G prints the rolling summary, E exports profile.csv / profile.json)
+        /// @param profiler Owned by the caller, nullptr to disable
+        void setProfiler(Profiler* profiler) { this->profiler = profiler; }
+
+        /// @brief Waits until every program variant is compiled and linked (they are otherwise
+        ///        finished on first use)
+        void finishPrograms();
+
+        /// @brief Loads the program of the procedural n-gon path (see setProceduralNgons)
+        /// @param vertexPath ngon_vertex_shader.glsl
+        /// @param fragmentPath The same fragment shader as in initialize
+        void initializeNgon(const char* vertexPath, const char* fragmentPath);
+
+        /// @brief Loads the program of the compute n-gon path (see setComputeNgons)
+        /// @param computePath ngon_compute_shader.glsl
+        /// @return false without compute shader support, the instanced path is used then
+        bool initializeCompute(const char* computePath);
+
+        /// @brief Loads the program of the thick line renderer (see setThickLines)
+        /// @param vertexPath line_vertex_shader.glsl
+        /// @param fragmentPath The same fragment shader as in initialize
+        void initializeLines(const char* vertexPath, const char* fragmentPath);
+
+        /// @brief Task2/Task3/Task4 draw their lines as instanced screen-space quads of lineWidth pixels
+        ///        (LineRenderer) instead of GL_LINES with glLineWidth. Applies to generated tasks, the atlas
+        ///        and procedural n-gons keep native lines. Needs initializeLines.
+        /// @param enabled true for quads, false for GL_LINES
+        /// @param join How segments continuing each other are connected
+        void setThickLines(bool enabled, LineRenderer::Join join = LineRenderer::MITER) {
+            thickLines = enabled;
+            lineJoin = join;
+        }
+
+        /// @brief Segments drawn by the thick line renderer in the last render(), 0 with native lines
+        size_t getThickLineSegments() const { return isThickLineTask() ? lines.getSegmentCount() : 0; }
+
+        /// @brief Generated tasks leave the color out of the vertex buffer: the vertex shader hashes
+        ///        gl_VertexID with a seed per task, so no random engine runs per vertex and a vertex is
+        ///        12 bytes (FLOAT) or 4 (compact) instead of 24 or 8. Flat shading still takes the color of
+        ///        the provoking vertex, one per triangle. The seeds follow from `seed`, the colors are the
+        ///        same in every run. Task1 stays white; the atlas, procedural n-gons and meshes keep
+        ///        their colors. Takes effect on the next task switch.
+        /// @param seed Base of the per-task seeds
+        void setGpuColors(bool enabled, unsigned int seed = 1) {
+            taskSettings.gpuColors = enabled;
+            taskSettings.colorSeedBase = seed;
+        }
+
+        /// @brief render() rasterizes the current task on the CPU into `rasterizer` instead of issuing GL
+        ///        calls, and setCurrentTask keeps the geometry on the CPU only: no GL context is needed.
+        ///        Tasks are generated on the calling thread; the atlas, procedural n-gons and the async
+        ///        build are skipped, thick lines become the plain wide lines they replace. The mesh task is not drawn.
+        ///        Set before the first setCurrentTask. The caller clears the rasterizer between frames.
+        /// @param rasterizer nullptr to draw with GL again (from the next setCurrentTask)
+        void setSoftwareRasterizer(SoftwareRasterizer* rasterizer) { software = rasterizer; }
+
+        /// @brief false if the colors of the current task come from the shader (setGpuColors)
+        bool hasVertexColors() const {
+            return currentTask == MESH_TASK || atlasMode || isProceduralTask() || bufferColors;
+        }
         
         /// @brief 
         void render();
@@ -39,34 +126,172 @@ class Model {
         /// @param mods 
         void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
 
-        void Task1(int n, float radius = 0.8);
-        void Task2(int n, float radius);
-        void Task3();
-        void Task4();
-        void Task5();
-        void Task6(int n, float radius= 0.8);
-        void Task7();
-        void Task8();
-        void Task8b();
-
         /// @brief 
         /// @param task 
         void setCurrentTask(int task);
 
+        /// @brief Task number of the mesh loaded by loadMesh (key 0)
+        static const int MESH_TASK = 10;
+
+        /// @brief Maps a .mesh file (see mesh_convert) and switches to it as MESH_TASK. It is uploaded
+        ///        from the mapping as stored, in its own vertex format (setVertexFormat does not apply);
+        ///        a mesh over the memory budget is streamed in chunks every frame instead.
+        /// @return false if the file cannot be loaded, a mesh loaded before is released as well
+        bool loadMesh(const std::string& path);
+
+        /// @brief GPU bytes a mesh may keep resident before it is streamed, takes effect on the next loadMesh
+        void setMeshMemoryBudget(size_t bytes) { meshBudget = bytes; }
+
+        /// @brief The loaded mesh, isLoaded() is false before loadMesh
+        const MeshStream& getMesh() const { return mesh; }
+
+        /// @brief setCurrentTask returns at once and the task is generated on a worker thread, then
+        ///        uploaded through a persistently mapped staging buffer by the first render() after it
+        ///        is ready. The previous task is drawn until then. Atlas mode and procedural n-gons
+        ///        switch synchronously as before.
+        /// @param enabled false finishes the pending build first
+        void setAsyncBuild(bool enabled);
+
+        /// @brief true while a task requested with async build is not drawn yet
+        bool isBuildPending() const { return requestedTask >= 0 || !buildThread.isIdle(); }
+
+        /// @brief Waits for the pending async build and makes it current
+        void finishBuild();
+
         /// @brief 
         void updateRenderSettings();
 
         void renderNormal();
         void renderTask8bSpecial();
+        void renderSoftware();
+
+        /// @brief Number of draw calls issued by the last render()
+        int getDrawCalls() const { return drawCalls; }
+
+        /// @brief State cache shared by all models of the context, exposes issued/elided call counters
+        static RenderState& getRenderState() { return renderState; }
+
+        /// @brief Number of vertices uploaded for the current task
+        int getNumVertices() const { return numVertices; }
+
+        /// @brief Number of indices drawn for the current task, 0 when drawing without an EBO
+        int getNumIndices() const { return numIndices; }
+
+        /// @brief Switches Task5/Task7/Task8/Task8b between expanded triangles and the indexed (EBO) path.
+        ///        Takes effect on the next task switch.
+        /// @param enabled true to upload the shared point pool once and draw with glDrawElements
+        void setIndexedGeometry(bool enabled) { taskSettings.indexedGeometry = enabled; }
+
+        /// @brief Generates every task variant (all three Task5 layouts, both Task8 modes) once into
+        ///        one immutable vertex buffer and one index buffer with a range per variant
+        void buildAtlas();
+
+        /// @brief In atlas mode rebuilds the atlas after a setting that changes its contents and makes
+        ///        a range of the current task current again; does nothing outside atlas mode
+        void rebuildAtlas();
+
+        /// @brief In atlas mode setCurrentTask only switches the active range: no CPU generation,
+        ///        no buffer allocation, no upload. Builds the atlas on first use.
+        /// @param enabled true to draw from the atlas
+        void setAtlasMode(bool enabled);
+
+        /// @brief Task1/Task2/Task6 take their n-gon corners from gl_VertexID and per-instance
+        ///        center/radius/sides/color seed, all polygons in one instanced draw with no vertex buffer.
+        ///        Needs initializeNgon. Takes effect on the next task switch.
+        /// @param enabled true for the GPU path, false for CPU-generated vertices
+        void setProceduralNgons(bool enabled) { proceduralNgons = enabled; }
+
+        /// @brief With setProceduralNgons, Task1/Task2/Task6 are expanded by a compute shader into a
+        ///        vertex buffer and drawn with one indirect command per polygon written by the same
+        ///        shader, instead of the instanced draw. Needs initializeCompute. Takes effect on the
+        ///        next task switch.
+        void setComputeNgons(bool enabled) { computeNgons = enabled; }
+
+        /// @brief Compute path only: Task6 becomes a triangle list of center fans with every triangle
+        ///        split into subdivisions^2; 0 keeps the fan. Takes effect on the next task switch.
+        void setNgonTessellation(int subdivisions) { ngonSubdivisions = std::max(0, subdivisions); }
+
+        /// @brief Number of n-gons drawn by Task1/Task2/Task6 on both paths, laid out on a square grid.
+        ///        1 is the original single polygon. Takes effect on the next task switch.
+        void setNgonCount(int count) { taskSettings.ngonCount = std::max(1, count); }
+
+        /// @brief Converts the triangle lists of Task5/Task7/Task8/Task8b into strips or fans with primitive
+        ///        restart (whichever needs the fewest indices) after a vertex cache reorder.
+        ///        Uses the indexed path regardless of setIndexedGeometry. Takes effect on the next task switch.
+        /// @param enabled true to convert, false to draw the lists as generated
+        void setTopologyOptimization(bool enabled) { taskSettings.optimizeTopology = enabled; }
+
+        /// @brief Numbers of the triangle list converted by setTopologyOptimization for the last
+        ///        generated task, all zero if that task was not converted
+        const Stripifier::Report& getTopologyReport() const { return topologyReport; }
+
+        /// @brief Vertex buffer layout of the generated tasks and the atlas, resolved per task
+        ///        (see VertexFormat::resolve). Takes effect on the next task switch.
+        /// @param format VertexFormat::FLOAT (24 bytes, default), HALF, SNORM16 (8 bytes) or AUTO
+        void setVertexFormat(VertexFormat::Format format) { vertexFormat = format; }
+
+        /// @brief Layout of the vertex buffer drawn for the current task
+        VertexFormat::Format getVertexFormat() const {
+            if (currentTask == MESH_TASK) return mesh.getVertexFormat();
+            return atlasMode ? atlasFormat : bufferFormat;
+        }
+
+        /// @brief Times the vertex arenas of this model and its task generators were (re)allocated,
+        ///        stays the same over task switches that fit the sizes seen before. The build generator
+        ///        is counted as of the last adopted or dropped build.
+        size_t getGeometryAllocations() const;
+
+        /// @brief Chooses how multi-range primitives (Task5 fans) are submitted
+        /// @param mode DrawBatch::LOOP, MULTI_DRAW or INDIRECT (falls back to MULTI_DRAW below GL 4.3)
+        void setBatchMode(DrawBatch::SubmitMode mode);
+
+        /// @brief Pan and zoom of every task: a point is drawn at (position - center) * zoom.
+        ///        The mesh task also submits only its chunks inside the view. Arrows pan, Z/X zoom, R resets.
+        /// @param zoom 1 shows [-1, 1] around the center, clamped to [1e-3, 1e6]
+        void setView(glm::vec2 center, float zoom);
+
+        glm::vec2 getViewCenter() const { return viewCenter; }
+        float getViewZoom() const { return viewZoom; }
+
+        /// @brief Visible rectangle in geometry coordinates: minX, minY, maxX, maxY
+        glm::vec4 getViewRect() const;
     
     private:
+        /// @brief Per-instance attributes of ngon_vertex_shader.glsl, also the parameters of the compute path
+        typedef ComputeGenerator::Polygon NgonInstance;
+
+        /// @brief Location of one task variant inside the atlas buffers
+        struct TaskRange {
+            PrimitiveType primitiveType;
+            GLenum rasterMode;
+            GLint firstVertex;
+            GLsizei vertexCount;
+            GLint firstIndex;
+            GLsizei indexCount;
+            std::vector<int> fanOffsets;
+        };
+
         PrimitiveType primitiveType;
-        GLuint VAO, VBO;
-        GLuint shaderProgram;
+        GLuint VAO, VBO, EBO;
+        // bits of a program variant index, in the order of the defines passed to ShaderVariants
+        enum VariantBits {
+            FLAT_VARIANT = 1,     // FLAT_SHADING
+            POINT_AA_VARIANT = 2  // POINT_AA
+        };
+
+        ShaderVariants shaderVariants;
+        ProgramCache* programCache;
+        Profiler* profiler;
+        static RenderState renderState;
 
-        std::vector<float> vertices;
-        std::vector<float> colors;
+        GeometryBuilder geometry;
+        std::vector<char> uploadArena; // only used when the vertex buffer cannot be mapped
+        std::vector<GLuint> indices;
         int numVertices;
+        GLint firstVertex;
+        GLint firstIndex;
+        GLsizei numIndices;
+        int drawCalls;
 
         /// @brief 
         void setupBuffers();
@@ -74,9 +299,91 @@ class Model {
         /// @brief 
         void clearBuffers();
 
+        /// @brief Program variant for the flat mode, smoothMode and the current primitive
+        int currentVariant() const;
+
+        /// @brief Draws the current triangles (list, or strips/fans from the stripifier),
+        ///        through the EBO when one is bound
+        void drawTriangles();
+
+        /// @brief Replaces VAO/VBO/EBO with new buffers of the given sizes
+        /// @param format Layout of vertexData
+        /// @param colors false if vertexData holds positions only (VertexFormat::packPositions)
+        /// @param vertexData Packed vertices, nullptr to leave the VBO uninitialized
+        /// @param indexData Indices, nullptr to leave the EBO uninitialized; no EBO if indexBytes is 0
+        void createBuffers(VertexFormat::Format format, bool colors, GLsizeiptr vertexBytes, const void* vertexData,
+                           GLsizeiptr indexBytes, const void* indexData);
+
+        /// @brief Writes geometry in the layout of the next upload: with colors, or positions only
+        ///        when the shader derives them
+        static void packGeometry(VertexFormat::Format format, const GeometryBuilder& built, bool colors,
+                                 void* destination);
+
+        /// @brief Once per frame: takes a finished build and hands the next requested task to the worker
+        void pollBuild();
+
+        /// @brief Runs on the build thread: buildGenerator.generate, then packs the vertices and
+        ///        indices into the staging region if they fit (else into buildPacked)
+        /// @param settings Copy of taskSettings when the build was started
+        /// @param format Requested vertex format, resolved for the generated task
+        void buildGeometry(int task, int variant, const TaskGenerator::Settings& settings,
+                           VertexFormat::Format format, char* destination, size_t capacity);
+
+        /// @brief Makes the finished build current and copies it from the staging region, GL thread
+        void adoptBuild();
+
+        /// @brief Generates the task on the GL thread with taskSettings and makes it current,
+        ///        without touching GL
+        /// @param task Task number 1..9
+        void generateTask(int task);
+
+        /// @brief Takes the arrays of a generated task (the generator gets the current ones back to
+        ///        reuse) and its draw parameters
+        void takeTask(TaskGenerator& generator);
+
+        /// @brief The variant of the task to show next, advances the task's cycle
+        ///        (see TaskGenerator::variantCount)
+        int takeVariant(int task);
+
+        /// @brief PrimitiveType of a GL primitive
+        static PrimitiveType toPrimitiveType(GLenum primitive);
+
+        /// @brief Makes the next variant of the task's atlas ranges current
+        /// @param task Task number 1..9
+        void selectAtlasRange(int task);
+
         /// @brief 
-        /// @return 
-        glm::vec3 getRandomColor();
+        void clearAtlas();
+
+        /// @brief Refills rangeBatch from fanOffsets of the current task
+        void updateDrawBatch();
+
+        /// @brief true when the current task is drawn by the procedural n-gon path
+        bool isProceduralTask() const { return isProceduralTask(currentTask); }
+        bool isProceduralTask(int task) const;
+
+        /// @brief true if setupNgonTask can take the compute path
+        bool isComputeNgons() const { return computeNgons && ngonCompute.isAvailable(); }
+
+        /// @brief true when the current task is drawn by the thick line renderer
+        bool isThickLineTask() const;
+
+        /// @brief One instanced draw of the current lines, rebuilt from geometry after a task switch
+        void renderThickLines();
+
+        /// @brief Uploads per-instance n-gon attributes for Task1/Task2/Task6, or generates the
+        ///        polygons with the compute shader
+        /// @param task 1, 2 or 6
+        void setupNgonTask(int task);
+
+        /// @brief Makes the loaded mesh the current task, nothing is generated or uploaded
+        void selectMesh();
+
+        /// @brief Single instanced or indirect draw of the procedural n-gons
+        void renderProcedural();
+
+        /// @brief 
+        void clearNgonBuffers();
 
         float pointSize;
         float lineWidth;
@@ -85,7 +392,60 @@ class Model {
         int smoothMode;
         static int renderMode; 
         std::vector<int> fanOffsets;
-        bool flatMode;
-        int polygonMode;
+        DrawBatch rangeBatch;
+        DrawBatch::SubmitMode batchMode;
+        TaskGenerator::Settings taskSettings; // set by the setters, handed to both generators as a whole
+        GLenum rasterMode; // glPolygonMode applied in render, set by TaskN
+        VertexFormat::Format vertexFormat;  // requested, see setVertexFormat
+        VertexFormat::Format bufferFormat;  // of VBO
+        bool bufferColors;                  // VBO has a color per vertex, see setGpuColors
+        unsigned int colorSeed;             // u_colorSeed of the generated task, 0 - colors in the buffer
+        VertexFormat::Format atlasFormat;   // of atlasVBO
+
+        bool atlasMode;
+        GLuint atlasVAO, atlasVBO, atlasEBO;
+        std::vector<TaskRange> atlasRanges;
+        std::vector<int> atlasTaskRanges[10]; // indices into atlasRanges per task, one per variant
+        int nextVariant[10];                  // see takeVariant, shared by generated tasks and the atlas
+
+        TaskGenerator tasks;          // generates on the GL thread
+        NgonGenerator ngonGenerator;  // colors of thick lines
+        Stripifier::Report topologyReport;
+        bool proceduralNgons;
+        ShaderVariants ngonVariants;
+        GLuint ngonVAO, ngonInstanceVBO;
+        GLsizei ngonVerticesPerInstance;
+        bool computeNgons;
+        int ngonSubdivisions;
+        bool ngonComputed; // the current n-gons come from ngonCompute
+        ComputeGenerator ngonCompute;
+        MeshStream mesh;
+        size_t meshBudget;
+        glm::vec2 viewCenter;
+        float viewZoom;
+        bool thickLines;
+        LineRenderer::Join lineJoin;
+        ShaderVariants lineVariants;
+        LineRenderer lines;
+        bool linesDirty; // geometry changed since lines were built
+        SoftwareRasterizer* software; // nullptr - GL, see setSoftwareRasterizer
+
+        // async build, see setAsyncBuild
+        bool asyncBuild;
+        int requestedTask;             // waiting for the worker, -1 if none
+        unsigned int taskRequests;     // setCurrentTask calls, a build older than the last one is dropped
+        TaskGenerator buildGenerator;  // only touched by the job or while the worker is idle
+        size_t buildAllocations;       // of buildGenerator's arena, read back while the worker is idle
+        StagingBuffer staging;
+        int nextRegion;
+        // written by the job, read once buildThread.isReady()
+        int buildTask;
+        unsigned int buildRequest;
+        int buildRegion;
+        bool buildStaged;
+        VertexFormat::Format buildFormat;
+        size_t buildVertexBytes, buildIndexBytes;
+        std::vector<char> buildPacked;
+        BuildThread buildThread; // last: stopped before the members its job writes are destroyed
 };
 
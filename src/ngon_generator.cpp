@@ -0,0 +1,276 @@
+#include <ngon_generator.h>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define NGON_X86 1
+#include <immintrin.h>
+#endif
+
+// below this many corners/colors per thread spawning threads costs more than it saves
+static const int MIN_ITEMS_PER_THREAD = 1 << 15;
+
+static const float TWO_PI = 6.28318530717958647692f;
+
+/// @brief Splits [0, count) into contiguous chunks, runs fn(begin, end) on each, one thread per chunk
+template <class F>
+static void parallelFor(size_t count, int threads, F fn) {
+    size_t chunks = std::min<size_t>((size_t)threads, count / MIN_ITEMS_PER_THREAD);
+    if (chunks <= 1) {
+        fn((size_t)0, count);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(chunks - 1);
+    size_t chunkSize = (count + chunks - 1) / chunks;
+
+    for (size_t c = 1; c < chunks; ++c) {
+        size_t begin = c * chunkSize;
+        size_t end = std::min(count, begin + chunkSize);
+        workers.emplace_back([=]() { fn(begin, end); });
+    }
+    fn((size_t)0, std::min(count, chunkSize));
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+static void cornersScalar(float* out, size_t stride, int firstCorner, int count, float step,
+                          glm::vec2 center, float radius) {
+    for (int i = 0; i < count; ++i) {
+        float angle = step * (float)(firstCorner + i);
+        float* p = out + i * stride;
+        p[0] = center.x + radius * std::cos(angle);
+        p[1] = center.y + radius * std::sin(angle);
+        p[2] = 0.0f;
+    }
+}
+
+#ifdef NGON_X86
+
+/*
+    sincos for x >= 0, Cephes single precision (as in sse_mathfun / avx_mathfun):
+    reduce by pi/4 in three parts, pick the sin or cos minimax polynomial per octant.
+*/
+#define NGON_SINCOS_CONSTANTS \
+    const float FOPI = 1.27323954473516f; \
+    const float DP1 = -0.78515625f; \
+    const float DP2 = -2.4187564849853515625e-4f; \
+    const float DP3 = -3.77489497744594108e-8f; \
+    const float SIN_P0 = -1.9515295891e-4f, SIN_P1 = 8.3321608736e-3f, SIN_P2 = -1.6666654611e-1f; \
+    const float COS_P0 = 2.443315711809948e-5f, COS_P1 = -1.388731625493765e-3f, COS_P2 = 4.166664568298827e-2f;
+
+static inline void sincosSSE2(__m128 x, __m128& s, __m128& c) {
+    NGON_SINCOS_CONSTANTS
+
+    __m128i j = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(FOPI)));
+    j = _mm_and_si128(_mm_add_epi32(j, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+    __m128 y = _mm_cvtepi32_ps(j);
+
+    __m128 signSin = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(j, _mm_set1_epi32(4)), 29));
+    __m128 signCos = _mm_castsi128_ps(_mm_slli_epi32(
+        _mm_andnot_si128(_mm_sub_epi32(j, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29));
+    __m128 polyMask = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(j, _mm_set1_epi32(2)), _mm_setzero_si128()));
+
+    x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP1)));
+    x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP2)));
+    x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP3)));
+    __m128 z = _mm_mul_ps(x, x);
+
+    __m128 yc = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(COS_P0), z), _mm_set1_ps(COS_P1));
+    yc = _mm_add_ps(_mm_mul_ps(yc, z), _mm_set1_ps(COS_P2));
+    yc = _mm_mul_ps(_mm_mul_ps(yc, z), z);
+    yc = _mm_sub_ps(yc, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+    yc = _mm_add_ps(yc, _mm_set1_ps(1.0f));
+
+    __m128 ys = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(SIN_P0), z), _mm_set1_ps(SIN_P1));
+    ys = _mm_add_ps(_mm_mul_ps(ys, z), _mm_set1_ps(SIN_P2));
+    ys = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(ys, z), x), x);
+
+    __m128 sinValue = _mm_or_ps(_mm_and_ps(polyMask, ys), _mm_andnot_ps(polyMask, yc));
+    __m128 cosValue = _mm_or_ps(_mm_and_ps(polyMask, yc), _mm_andnot_ps(polyMask, ys));
+
+    s = _mm_xor_ps(sinValue, signSin);
+    c = _mm_xor_ps(cosValue, signCos);
+}
+
+static void cornersSSE2(float* out, size_t stride, int firstCorner, int count, float step,
+                        glm::vec2 center, float radius) {
+    const __m128 lane = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+    const __m128 cx = _mm_set1_ps(center.x), cy = _mm_set1_ps(center.y), r = _mm_set1_ps(radius);
+    alignas(16) float xs[4], ys[4];
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 index = _mm_add_ps(_mm_set1_ps((float)(firstCorner + i)), lane);
+        __m128 s, c;
+        sincosSSE2(_mm_mul_ps(index, _mm_set1_ps(step)), s, c);
+        _mm_store_ps(xs, _mm_add_ps(cx, _mm_mul_ps(r, c)));
+        _mm_store_ps(ys, _mm_add_ps(cy, _mm_mul_ps(r, s)));
+
+        float* p = out + i * stride;
+        for (int k = 0; k < 4; ++k, p += stride) {
+            p[0] = xs[k];
+            p[1] = ys[k];
+            p[2] = 0.0f;
+        }
+    }
+    cornersScalar(out + i * stride, stride, firstCorner + i, count - i, step, center, radius);
+}
+
+__attribute__((target("avx2,fma")))
+static inline void sincosAVX2(__m256 x, __m256& s, __m256& c) {
+    NGON_SINCOS_CONSTANTS
+
+    __m256i j = _mm256_cvttps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(FOPI)));
+    j = _mm256_and_si256(_mm256_add_epi32(j, _mm256_set1_epi32(1)), _mm256_set1_epi32(~1));
+    __m256 y = _mm256_cvtepi32_ps(j);
+
+    __m256 signSin = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(j, _mm256_set1_epi32(4)), 29));
+    __m256 signCos = _mm256_castsi256_ps(_mm256_slli_epi32(
+        _mm256_andnot_si256(_mm256_sub_epi32(j, _mm256_set1_epi32(2)), _mm256_set1_epi32(4)), 29));
+    __m256 polyMask = _mm256_castsi256_ps(
+        _mm256_cmpeq_epi32(_mm256_and_si256(j, _mm256_set1_epi32(2)), _mm256_setzero_si256()));
+
+    x = _mm256_fmadd_ps(y, _mm256_set1_ps(DP1), x);
+    x = _mm256_fmadd_ps(y, _mm256_set1_ps(DP2), x);
+    x = _mm256_fmadd_ps(y, _mm256_set1_ps(DP3), x);
+    __m256 z = _mm256_mul_ps(x, x);
+
+    __m256 yc = _mm256_fmadd_ps(_mm256_set1_ps(COS_P0), z, _mm256_set1_ps(COS_P1));
+    yc = _mm256_fmadd_ps(yc, z, _mm256_set1_ps(COS_P2));
+    yc = _mm256_mul_ps(_mm256_mul_ps(yc, z), z);
+    yc = _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), yc);
+    yc = _mm256_add_ps(yc, _mm256_set1_ps(1.0f));
+
+    __m256 ys = _mm256_fmadd_ps(_mm256_set1_ps(SIN_P0), z, _mm256_set1_ps(SIN_P1));
+    ys = _mm256_fmadd_ps(ys, z, _mm256_set1_ps(SIN_P2));
+    ys = _mm256_fmadd_ps(_mm256_mul_ps(ys, z), x, x);
+
+    __m256 sinValue = _mm256_blendv_ps(yc, ys, polyMask);
+    __m256 cosValue = _mm256_blendv_ps(ys, yc, polyMask);
+
+    s = _mm256_xor_ps(sinValue, signSin);
+    c = _mm256_xor_ps(cosValue, signCos);
+}
+
+__attribute__((target("avx2,fma")))
+static void cornersAVX2(float* out, size_t stride, int firstCorner, int count, float step,
+                        glm::vec2 center, float radius) {
+    const __m256 lane = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+    const __m256 cx = _mm256_set1_ps(center.x), cy = _mm256_set1_ps(center.y), r = _mm256_set1_ps(radius);
+    alignas(32) float xs[8], ys[8];
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 index = _mm256_add_ps(_mm256_set1_ps((float)(firstCorner + i)), lane);
+        __m256 s, c;
+        sincosAVX2(_mm256_mul_ps(index, _mm256_set1_ps(step)), s, c);
+        _mm256_store_ps(xs, _mm256_fmadd_ps(r, c, cx));
+        _mm256_store_ps(ys, _mm256_fmadd_ps(r, s, cy));
+
+        float* p = out + i * stride;
+        for (int k = 0; k < 8; ++k, p += stride) {
+            p[0] = xs[k];
+            p[1] = ys[k];
+            p[2] = 0.0f;
+        }
+    }
+    cornersSSE2(out + i * stride, stride, firstCorner + i, count - i, step, center, radius);
+}
+
+#endif // NGON_X86
+
+NgonGenerator::NgonGenerator(Kernel requested, int requestedThreads) {
+    if (requested == AUTO || !isSupported(requested)) {
+        requested = isSupported(AVX2) ? AVX2 : (isSupported(SSE2) ? SSE2 : SCALAR);
+    }
+    kernel = requested;
+
+    threads = requestedThreads > 0 ? requestedThreads : (int)std::thread::hardware_concurrency();
+    threads = std::max(1, threads);
+}
+
+bool NgonGenerator::isSupported(Kernel kernel) {
+    switch (kernel) {
+        case AUTO:
+        case SCALAR:
+            return true;
+#ifdef NGON_X86
+        case SSE2:
+            return __builtin_cpu_supports("sse2");
+        case AVX2:
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+        case SSE2:
+        case AVX2:
+            return false;
+#endif
+    }
+    return false;
+}
+
+const char* NgonGenerator::kernelName(Kernel kernel) {
+    switch (kernel) {
+        case AUTO: return "auto";
+        case SCALAR: return "scalar";
+        case SSE2: return "sse2";
+        case AVX2: return "avx2";
+    }
+    return "unknown";
+}
+
+void NgonGenerator::corners(float* out, size_t stride, int firstCorner, int count, int n,
+                            glm::vec2 center, float radius) const {
+    if (count <= 0 || n <= 0) return;
+
+    // same angle as the scalar tasks: 2*pi*i/n, the index stays exact in float up to 2^24
+    const float step = TWO_PI / (float)n;
+    const Kernel k = kernel;
+
+    parallelFor((size_t)count, threads, [=](size_t begin, size_t end) {
+        float* chunkOut = out + begin * stride;
+        int chunkFirst = firstCorner + (int)begin;
+        int chunkCount = (int)(end - begin);
+
+        switch (k) {
+#ifdef NGON_X86
+            case AVX2:
+                cornersAVX2(chunkOut, stride, chunkFirst, chunkCount, step, center, radius);
+                break;
+            case SSE2:
+                cornersSSE2(chunkOut, stride, chunkFirst, chunkCount, step, center, radius);
+                break;
+#endif
+            default:
+                cornersScalar(chunkOut, stride, chunkFirst, chunkCount, step, center, radius);
+                break;
+        }
+    });
+}
+
+/// @brief lowbias32 integer hash, also used by ngon_vertex_shader.glsl
+static inline uint32_t hash32(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+void NgonGenerator::randomColors(float* out, size_t count, uint32_t seed) const {
+    // counter-based: every color depends only on (seed, index), chunks need no shared state
+    parallelFor(count, threads, [=](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            uint32_t h = hash32(seed ^ hash32((uint32_t)i));
+            out[i * 3] = (float)(h & 0xFFu) / 255.0f;
+            out[i * 3 + 1] = (float)((h >> 8) & 0xFFu) / 255.0f;
+            out[i * 3 + 2] = (float)((h >> 16) & 0xFFu) / 255.0f;
+        }
+    });
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Generator of regular n-gon corners and random vertex colors for very large n.
+///        Writes straight into pre-sized buffers, computes 4 (SSE2) or 8 (AVX2) sin/cos pairs at once
+///        with a Cephes-style polynomial and splits large requests across hardware threads.
+///        The kernel is chosen at run time; the scalar one uses std::sin/std::cos.
+class NgonGenerator {
+    public:
+        enum Kernel {
+            AUTO,    // best supported by the CPU
+            SCALAR,
+            SSE2,
+            AVX2
+        };
+
+        /// @param kernel Kernel to use, falls back to the best supported one if unavailable
+        /// @param threads Worker threads for large requests, 0 - std::thread::hardware_concurrency
+        NgonGenerator(Kernel kernel = AUTO, int threads = 0);
+
+        /// @brief Writes corners firstCorner .. firstCorner + count - 1 of a regular n-gon as x, y, 0
+        /// @param out First corner, at least (count - 1) * stride + 3 floats
+        /// @param stride Distance between consecutive corners in floats (3 - packed xyz)
+        /// @param firstCorner Index of the first corner, corner i is at angle 2*pi*i/n
+        /// @param count Number of corners to write
+        /// @param n Number of sides
+        /// @param center Polygon center
+        /// @param radius Circumradius
+        void corners(float* out, size_t stride, int firstCorner, int count, int n,
+                     glm::vec2 center, float radius) const;
+
+        /// @brief Writes count RGB triplets in [0, 1], each channel a byte of the hash / 255 like
+        ///        ngon_vertex_shader.glsl, reproducible for a given seed
+        /// @param out At least count * 3 floats
+        /// @param count Number of colors
+        /// @param seed Seed, e.g. one draw of the caller's random engine
+        void randomColors(float* out, size_t count, uint32_t seed) const;
+
+        /// @brief Kernel actually used
+        Kernel getKernel() const { return kernel; }
+
+        /// @brief Number of threads used for large requests
+        int getThreads() const { return threads; }
+
+        /// @brief true if the CPU (and the build) can run the kernel
+        static bool isSupported(Kernel kernel);
+
+        static const char* kernelName(Kernel kernel);
+
+    private:
+        Kernel kernel;
+        int threads;
+};
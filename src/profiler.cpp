@@ -0,0 +1,256 @@
+#include <profiler.h>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+Profiler::Scope::Scope(Profiler* profiler, const char* pass) : profiler(profiler) {
+    if (profiler) profiler->begin(pass);
+}
+
+Profiler::Scope::~Scope() {
+    if (profiler) profiler->end();
+}
+
+Profiler::Profiler(int latency, size_t historySize) {
+    this->latency = std::max(2, latency);
+    this->historySize = std::max<size_t>(1, historySize);
+    ring.resize(this->latency);
+    for (PendingFrame& pending : ring) pending.pending = false;
+    gpuOwner = -1;
+    inFrame = false;
+    frameIndex = 0;
+    droppedFrames = 0;
+}
+
+Profiler::~Profiler() {
+    for (PendingFrame& pending : ring) discard(pending);
+    if (!freeQueries.empty()) glDeleteQueries((GLsizei)freeQueries.size(), freeQueries.data());
+}
+
+GLuint Profiler::acquireQuery() {
+    if (freeQueries.empty()) {
+        GLuint query = 0;
+        glGenQueries(1, &query);
+        return query;
+    }
+    GLuint query = freeQueries.back();
+    freeQueries.pop_back();
+    return query;
+}
+
+int Profiler::passIndex(const char* pass) {
+    for (size_t i = 0; i < passNames.size(); ++i) {
+        if (passNames[i] == pass) return (int)i;
+    }
+    passNames.push_back(pass);
+    return (int)passNames.size() - 1;
+}
+
+void Profiler::beginFrame() {
+    PendingFrame& current = ring[frameIndex % latency];
+    // still not done after `latency` frames: waiting here is exactly the stall we avoid
+    if (current.pending && !resolve(current, false)) {
+        discard(current);
+        droppedFrames++;
+    }
+
+    current.pending = false;
+    current.frame = frameIndex;
+    current.samples.clear();
+    openSamples.clear();
+    gpuOwner = -1;
+    inFrame = true;
+    frameStart = Clock::now();
+}
+
+void Profiler::endFrame() {
+    if (!inFrame) return;
+    while (!openSamples.empty()) end();
+
+    PendingFrame& current = ring[frameIndex % latency];
+    current.cpuFrameMs = std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+    current.pending = true;
+    inFrame = false;
+    frameIndex++;
+
+    // oldest first, queries finish in submission order
+    for (int k = 0; k < latency; ++k) {
+        PendingFrame& pending = ring[(frameIndex + k) % latency];
+        if (pending.pending && !resolve(pending, false)) break;
+    }
+}
+
+void Profiler::begin(const char* pass) {
+    if (!inFrame) {
+        openSamples.push_back(-1); // outside a frame, keeps end() balanced
+        return;
+    }
+
+    std::vector<Sample>& samples = ring[frameIndex % latency].samples;
+    Sample sample;
+    sample.pass = passIndex(pass);
+    sample.query = 0;
+    sample.cpuMs = 0.0;
+    if (gpuOwner < 0) {
+        sample.query = acquireQuery();
+        glBeginQuery(GL_TIME_ELAPSED, sample.query);
+        gpuOwner = (int)samples.size();
+    }
+    openSamples.push_back((int)samples.size());
+    sample.cpuStart = Clock::now();
+    samples.push_back(sample);
+}
+
+void Profiler::end() {
+    if (openSamples.empty()) return;
+    int index = openSamples.back();
+    openSamples.pop_back();
+    if (index < 0) return;
+
+    Sample& sample = ring[frameIndex % latency].samples[index];
+    sample.cpuMs = std::chrono::duration<double, std::milli>(Clock::now() - sample.cpuStart).count();
+    if (index == gpuOwner) {
+        glEndQuery(GL_TIME_ELAPSED);
+        gpuOwner = -1;
+    }
+}
+
+bool Profiler::resolve(PendingFrame& pending, bool wait) {
+    if (!wait) {
+        for (const Sample& sample : pending.samples) {
+            if (sample.query == 0) continue;
+            GLint available = GL_FALSE;
+            glGetQueryObjectiv(sample.query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available != GL_TRUE) return false;
+        }
+    }
+
+    FrameRow row;
+    row.frame = pending.frame;
+    row.cpuFrameMs = pending.cpuFrameMs;
+    row.cpuMs.assign(passNames.size(), -1.0);
+    row.gpuMs.assign(passNames.size(), -1.0);
+    // a pass drawn several times per frame adds up
+    for (const Sample& sample : pending.samples) {
+        double& cpuMs = row.cpuMs[sample.pass];
+        cpuMs = std::max(cpuMs, 0.0) + sample.cpuMs;
+        if (sample.query != 0) {
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(sample.query, GL_QUERY_RESULT, &ns);
+            double& gpuMs = row.gpuMs[sample.pass];
+            gpuMs = std::max(gpuMs, 0.0) + ns / 1e6;
+        }
+    }
+
+    history.push_back(row);
+    if (history.size() > historySize) history.pop_front();
+
+    discard(pending);
+    return true;
+}
+
+void Profiler::discard(PendingFrame& pending) {
+    for (const Sample& sample : pending.samples) {
+        if (sample.query != 0) freeQueries.push_back(sample.query);
+    }
+    pending.samples.clear();
+    pending.pending = false;
+}
+
+void Profiler::flush() {
+    for (int k = 0; k < latency; ++k) {
+        PendingFrame& pending = ring[(frameIndex + k) % latency];
+        if (pending.pending) resolve(pending, true);
+    }
+}
+
+void Profiler::printSummary(std::ostream& out, size_t frames) const {
+    size_t count = std::min(frames, history.size());
+    out << "Profiler: last " << count << " frames, " << droppedFrames << " dropped" << std::endl;
+    if (count == 0) return;
+
+    std::deque<FrameRow>::const_iterator first = history.end() - count;
+    double frameTotal = 0.0;
+    for (std::deque<FrameRow>::const_iterator row = first; row != history.end(); ++row) {
+        frameTotal += row->cpuFrameMs;
+    }
+    out << std::fixed << std::setprecision(4)
+        << "  frame (cpu)       avg " << frameTotal / count << " ms" << std::endl;
+
+    for (size_t pass = 0; pass < passNames.size(); ++pass) {
+        for (int gpu = 0; gpu < 2; ++gpu) {
+            double total = 0.0, low = 0.0, high = 0.0;
+            size_t samples = 0;
+            for (std::deque<FrameRow>::const_iterator row = first; row != history.end(); ++row) {
+                const std::vector<double>& values = gpu ? row->gpuMs : row->cpuMs;
+                if (pass >= values.size() || values[pass] < 0.0) continue;
+                double value = values[pass];
+                low = samples == 0 ? value : std::min(low, value);
+                high = samples == 0 ? value : std::max(high, value);
+                total += value;
+                samples++;
+            }
+            if (samples == 0) continue;
+            out << "  " << std::left << std::setw(18) << (passNames[pass] + (gpu ? " (gpu)" : " (cpu)"))
+                << std::right << "avg " << total / samples << " min " << low << " max " << high
+                << " ms over " << samples << " frames" << std::endl;
+        }
+    }
+    out.unsetf(std::ios::floatfield);
+}
+
+// negative - the pass did not run (or had no query), an empty cell / null
+static void writeValue(std::ostream& out, const std::vector<double>& values, size_t pass, const char* missing) {
+    if (pass < values.size() && values[pass] >= 0.0) out << values[pass];
+    else out << missing;
+}
+
+bool Profiler::writeCsv(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+
+    out << "frame,cpu_frame_ms";
+    for (const std::string& name : passNames) out << "," << name << "_cpu_ms," << name << "_gpu_ms";
+    out << "\n";
+
+    for (const FrameRow& row : history) {
+        out << row.frame << "," << row.cpuFrameMs;
+        for (size_t pass = 0; pass < passNames.size(); ++pass) {
+            out << ",";
+            writeValue(out, row.cpuMs, pass, "");
+            out << ",";
+            writeValue(out, row.gpuMs, pass, "");
+        }
+        out << "\n";
+    }
+    return out.good();
+}
+
+bool Profiler::writeJson(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+
+    out << "{\n  \"dropped_frames\": " << droppedFrames << ",\n  \"passes\": [";
+    for (size_t pass = 0; pass < passNames.size(); ++pass) {
+        out << (pass ? ", " : "") << "\"" << passNames[pass] << "\"";
+    }
+    out << "],\n  \"frames\": [\n";
+
+    for (size_t i = 0; i < history.size(); ++i) {
+        const FrameRow& row = history[i];
+        out << "    {\"frame\": " << row.frame << ", \"cpu_frame_ms\": " << row.cpuFrameMs << ", \"passes\": {";
+        bool firstPass = true;
+        for (size_t pass = 0; pass < passNames.size(); ++pass) {
+            if (pass >= row.cpuMs.size() || row.cpuMs[pass] < 0.0) continue;
+            out << (firstPass ? "" : ", ") << "\"" << passNames[pass] << "\": {\"cpu_ms\": ";
+            writeValue(out, row.cpuMs, pass, "null");
+            out << ", \"gpu_ms\": ";
+            writeValue(out, row.gpuMs, pass, "null");
+            out << "}";
+            firstPass = false;
+        }
+        out << "}}" << (i + 1 < history.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}" << std::endl;
+    return out.good();
+}
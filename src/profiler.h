@@ -0,0 +1,111 @@
+#pragma once
+#include <GL/glew.h>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// @brief Per-pass CPU and GPU frame timings. Every named scope between beginFrame and endFrame gets
+///        a CPU timer and a GL_TIME_ELAPSED query. Queries are read back `latency` frames later, when
+///        the GPU has long finished them, so reading never waits: a frame whose results are still not
+///        available when its ring slot is reused is dropped instead.
+class Profiler {
+    public:
+        /// @brief Times one pass from construction to destruction, does nothing with a null profiler
+        class Scope {
+            public:
+                Scope(Profiler* profiler, const char* pass);
+                ~Scope();
+                Scope(const Scope&) = delete;
+                Scope& operator=(const Scope&) = delete;
+            private:
+                Profiler* profiler;
+        };
+
+        /// @brief Timings of one resolved frame, indexed like getPassNames, negative if the pass did not run
+        struct FrameRow {
+            uint64_t frame;
+            double cpuFrameMs;        // beginFrame -> endFrame
+            std::vector<double> cpuMs;
+            std::vector<double> gpuMs; // negative also for scopes nested in another one (CPU only)
+        };
+
+        /// @param latency Frames between issuing a query and reading it back, at least 2
+        /// @param historySize Resolved frames kept for export, the oldest are dropped
+        Profiler(int latency = 4, size_t historySize = 10000);
+        ~Profiler();
+
+        /// @brief Needs a current GL context
+        void beginFrame();
+        void endFrame();
+
+        /// @brief Opens a pass, prefer Scope. Scopes nest, but GL_TIME_ELAPSED queries cannot:
+        ///        only the outermost open scope is timed on the GPU.
+        /// @param pass Name of the pass, a column of the exports
+        void begin(const char* pass);
+        void end();
+
+        /// @brief Waits for every frame still in flight (exports and shutdown)
+        void flush();
+
+        /// @brief Frames given up because their queries were not ready after `latency` frames
+        uint64_t getDroppedFrames() const { return droppedFrames; }
+
+        const std::vector<std::string>& getPassNames() const { return passNames; }
+        const std::deque<FrameRow>& getHistory() const { return history; }
+
+        /// @brief Average/min/max per pass over the last `frames` resolved frames
+        void printSummary(std::ostream& out, size_t frames = 120) const;
+
+        /// @brief One row per frame: frame, cpu_frame_ms, then <pass>_cpu_ms and <pass>_gpu_ms per pass
+        /// @return false if the file could not be written
+        bool writeCsv(const std::string& path) const;
+
+        /// @brief {"passes": [...], "frames": [{"frame", "cpu_frame_ms", "passes": {name: {cpu_ms, gpu_ms}}}]}
+        /// @return false if the file could not be written
+        bool writeJson(const std::string& path) const;
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        struct Sample {
+            int pass;
+            GLuint query;     // 0 - not timed on the GPU
+            Clock::time_point cpuStart;
+            double cpuMs;
+        };
+
+        struct PendingFrame {
+            bool pending;
+            uint64_t frame;
+            double cpuFrameMs;
+            std::vector<Sample> samples;
+        };
+
+        int passIndex(const char* pass);
+
+        /// @brief Turns the frame into a FrameRow if all its queries are available (always with wait)
+        /// @return false if some query is still in flight, the frame is left untouched
+        bool resolve(PendingFrame& pending, bool wait);
+
+        /// @brief Returns the queries of the frame to the pool without reading them
+        void discard(PendingFrame& pending);
+
+        GLuint acquireQuery();
+
+        int latency;
+        size_t historySize;
+        std::vector<PendingFrame> ring;
+        std::vector<GLuint> freeQueries;
+        std::vector<int> openSamples;  // indices into the current frame's samples
+        int gpuOwner;                  // sample holding the active GL_TIME_ELAPSED query, -1 if none
+        bool inFrame;
+        uint64_t frameIndex;
+        uint64_t droppedFrames;
+        Clock::time_point frameStart;
+
+        std::vector<std::string> passNames;
+        std::deque<FrameRow> history;
+};
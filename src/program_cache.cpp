@@ -0,0 +1,163 @@
+#include <program_cache.h>
+#include <functions.h>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+// file layout: MAGIC, FORMAT_VERSION, key, binary format, binary length, binary
+static const uint32_t MAGIC = 0x4E494250u; // "PBIN"
+static const uint32_t FORMAT_VERSION = 1;
+
+struct BinaryHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t binaryFormat;
+    uint32_t length;
+};
+
+static void fnv1a(uint64_t& hash, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ull;
+    }
+}
+
+static void fnv1a(uint64_t& hash, const char* text) {
+    // the terminator separates fields: "ab" + "c" and "a" + "bc" hash differently
+    fnv1a(hash, text ? text : "", text ? std::char_traits<char>::length(text) + 1 : 1);
+}
+
+ProgramCache::ProgramCache(const std::string& directory) : directory(directory) {
+    hits = 0;
+    misses = 0;
+    loadMs = 0.0;
+}
+
+bool ProgramCache::isSupported() const {
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+uint64_t ProgramCache::makeKey(const std::string& vertexCode, const std::string& fragmentCode,
+                               const std::string& geometryCode) const {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    fnv1a(hash, &FORMAT_VERSION, sizeof(FORMAT_VERSION));
+    fnv1a(hash, (const char*)glGetString(GL_VENDOR));
+    fnv1a(hash, (const char*)glGetString(GL_RENDERER));
+    fnv1a(hash, (const char*)glGetString(GL_VERSION));
+    fnv1a(hash, vertexCode.c_str());
+    fnv1a(hash, fragmentCode.c_str());
+    // only hashed when present, keys of vertex + fragment programs stay what they were
+    if (!geometryCode.empty()) fnv1a(hash, geometryCode.c_str());
+    return hash;
+}
+
+std::string ProgramCache::pathFor(uint64_t key) const {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+    return (std::filesystem::path(directory) / name).string();
+}
+
+GLuint ProgramCache::loadBinary(uint64_t key) const {
+    std::ifstream file(pathFor(key), std::ios::binary);
+    if (!file.is_open()) return 0;
+
+    BinaryHeader header;
+    if (!file.read((char*)&header, sizeof(header)) ||
+        header.magic != MAGIC || header.version != FORMAT_VERSION || header.key != key) {
+        return 0;
+    }
+
+    std::vector<char> binary(header.length);
+    if (!file.read(binary.data(), binary.size())) return 0;
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, header.binaryFormat, binary.data(), (GLsizei)binary.size());
+
+    // the driver may reject binaries from another build even with matching strings
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked != GL_TRUE) {
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+void ProgramCache::storeBinary(uint64_t key, GLuint program) const {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    BinaryHeader header;
+    header.magic = MAGIC;
+    header.version = FORMAT_VERSION;
+    header.key = key;
+    header.length = (uint32_t)length;
+
+    std::vector<char> binary(length);
+    GLenum binaryFormat = 0;
+    glGetProgramBinary(program, length, NULL, &binaryFormat, binary.data());
+    header.binaryFormat = binaryFormat;
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    // write to a temporary name first, a crash never leaves a truncated cache entry behind
+    std::string path = pathFor(key);
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cout << "Program cache: could not write " << tmpPath << std::endl;
+            return;
+        }
+        file.write((const char*)&header, sizeof(header));
+        file.write(binary.data(), binary.size());
+    }
+    std::filesystem::rename(tmpPath, path, error);
+}
+
+GLuint ProgramCache::find(const std::string& vertexCode, const std::string& fragmentCode,
+                          const std::string& geometryCode) {
+    GLuint program = isSupported() ? loadBinary(makeKey(vertexCode, fragmentCode, geometryCode)) : 0;
+    if (program != 0) hits++;
+    else misses++;
+    return program;
+}
+
+void ProgramCache::store(const std::string& vertexCode, const std::string& fragmentCode, GLuint program,
+                         const std::string& geometryCode) {
+    if (program != 0 && isSupported()) {
+        storeBinary(makeKey(vertexCode, fragmentCode, geometryCode), program);
+    }
+}
+
+GLuint ProgramCache::load(const char* vertexPath, const char* fragmentPath) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    std::string vertexCode = readShaderFile(vertexPath);
+    std::string fragmentCode = readShaderFile(fragmentPath);
+
+    bool supported = isSupported();
+    GLuint program = find(vertexCode, fragmentCode);
+    bool hit = program != 0;
+
+    if (!hit) {
+        program = createShaderProgramFromSource(vertexCode.c_str(), fragmentCode.c_str(), supported);
+        store(vertexCode, fragmentCode, program);
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    loadMs += ms;
+
+    std::cout << "Program cache " << (hit ? "hit" : (supported ? "miss" : "unsupported")) << ": "
+              << vertexPath << " + " << fragmentPath << ", " << ms << " ms" << std::endl;
+    return program;
+}
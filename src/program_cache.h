@@ -0,0 +1,58 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstdint>
+#include <string>
+
+/// @brief On-disk cache of linked shader programs (glGetProgramBinary / glProgramBinary).
+///        The key hashes both shader sources together with the GL vendor, renderer and version
+///        strings, so editing a shader or updating the driver misses the cache instead of loading
+///        a stale binary. A binary the driver rejects is recompiled from source and overwritten.
+class ProgramCache {
+    public:
+        /// @param directory Where <key>.bin files are kept, created on the first store
+        ProgramCache(const std::string& directory);
+
+        /// @brief Drop-in replacement of createShaderProgram with a current GL context
+        /// @param vertexPath File path to the vertex shader source
+        /// @param fragmentPath File path to the fragment shader source
+        /// @return Linked program, 0 if compiling/linking from source failed as well
+        GLuint load(const char* vertexPath, const char* fragmentPath);
+
+        /// @brief Looks the sources up without compiling, counts a hit or a miss
+        /// @param geometryCode Empty for programs without a geometry shader
+        /// @return Linked program restored from disk, 0 if not cached (or unsupported)
+        GLuint find(const std::string& vertexCode, const std::string& fragmentCode,
+                    const std::string& geometryCode = std::string());
+
+        /// @brief Saves a linked program created from these sources, best linked with
+        ///        GL_PROGRAM_BINARY_RETRIEVABLE_HINT (see createShaderProgramFromSource)
+        void store(const std::string& vertexCode, const std::string& fragmentCode, GLuint program,
+                   const std::string& geometryCode = std::string());
+
+        /// @brief false if the driver offers no program binary formats, load then always compiles
+        bool isSupported() const;
+
+        /// @brief Programs loaded from disk / compiled from source since construction
+        int getHits() const { return hits; }
+        int getMisses() const { return misses; }
+
+        /// @brief Time spent in load since construction, milliseconds
+        double getLoadMs() const { return loadMs; }
+
+    private:
+        /// @brief 64-bit FNV-1a of the sources and the driver strings
+        uint64_t makeKey(const std::string& vertexCode, const std::string& fragmentCode,
+                         const std::string& geometryCode) const;
+
+        std::string pathFor(uint64_t key) const;
+
+        /// @brief Creates a program from the cached binary, 0 if missing, stale or rejected
+        GLuint loadBinary(uint64_t key) const;
+
+        void storeBinary(uint64_t key, GLuint program) const;
+
+        std::string directory;
+        int hits;
+        int misses;
+        double loadMs;
+};
@@ -0,0 +1,181 @@
+#include <render_state.h>
+#include <limits>
+
+RenderState::RenderState() {
+    issuedCalls = 0;
+    elidedCalls = 0;
+    invalidate();
+}
+
+void RenderState::invalidate() {
+    program = 0; vao = 0; polygon = GL_FILL;
+    cullEnabled = -1;
+    restartEnabled = -1;
+    cullMode = GL_BACK;
+    point = 0.0f; line = 0.0f;
+    programValid = false;
+    vaoValid = false;
+    polygonValid = false;
+    cullModeValid = false;
+    pointValid = false;
+    lineValid = false;
+    uniforms.clear();
+    uintUniforms.clear();
+    floatUniforms.clear();
+    vec3Uniforms.clear();
+}
+
+void RenderState::resetCounters() {
+    issuedCalls = 0;
+    elidedCalls = 0;
+}
+
+bool RenderState::track(bool changed) {
+    if (changed) issuedCalls++;
+    else elidedCalls++;
+    return changed;
+}
+
+void RenderState::useProgram(GLuint newProgram) {
+    if (track(!programValid || program != newProgram)) {
+        glUseProgram(newProgram);
+        program = newProgram;
+        programValid = true;
+    }
+}
+
+void RenderState::bindVertexArray(GLuint newVao) {
+    if (track(!vaoValid || vao != newVao)) {
+        glBindVertexArray(newVao);
+        vao = newVao;
+        vaoValid = true;
+    }
+}
+
+void RenderState::vertexArrayDeleted(GLuint deletedVao) {
+    if (vaoValid && vao == deletedVao) {
+        vao = 0;
+    }
+}
+
+// entries of one program are contiguous: the map is ordered by program first
+template <typename Value>
+static void eraseProgram(std::map<std::pair<GLuint, GLint>, Value>& cache, GLuint program) {
+    auto first = cache.lower_bound(std::make_pair(program, std::numeric_limits<GLint>::min()));
+    auto last = first;
+    while (last != cache.end() && last->first.first == program) ++last;
+    cache.erase(first, last);
+}
+
+void RenderState::programDeleted(GLuint deletedProgram) {
+    // a deleted program stays in use until the next glUseProgram, which must reach GL
+    if (programValid && program == deletedProgram) {
+        programValid = false;
+    }
+    eraseProgram(uniforms, deletedProgram);
+    eraseProgram(uintUniforms, deletedProgram);
+    eraseProgram(floatUniforms, deletedProgram);
+    eraseProgram(vec3Uniforms, deletedProgram);
+}
+
+void RenderState::polygonMode(GLenum mode) {
+    if (track(!polygonValid || polygon != mode)) {
+        glPolygonMode(GL_FRONT_AND_BACK, mode);
+        polygon = mode;
+        polygonValid = true;
+    }
+}
+
+void RenderState::cullFace(bool enabled) {
+    if (track(cullEnabled != (enabled ? 1 : 0))) {
+        if (enabled) glEnable(GL_CULL_FACE);
+        else glDisable(GL_CULL_FACE);
+        cullEnabled = enabled ? 1 : 0;
+    }
+}
+
+void RenderState::primitiveRestart(bool enabled) {
+    if (track(restartEnabled != (enabled ? 1 : 0))) {
+        GLenum cap = GL_PRIMITIVE_RESTART_FIXED_INDEX;
+        if (!GLEW_VERSION_4_3) {
+            cap = GL_PRIMITIVE_RESTART;
+            glPrimitiveRestartIndex(0xFFFFFFFFu);
+        }
+
+        if (enabled) glEnable(cap);
+        else glDisable(cap);
+        restartEnabled = enabled ? 1 : 0;
+    }
+}
+
+void RenderState::cullFaceMode(GLenum mode) {
+    if (track(!cullModeValid || cullMode != mode)) {
+        glCullFace(mode);
+        cullMode = mode;
+        cullModeValid = true;
+    }
+}
+
+void RenderState::pointSize(float size) {
+    if (track(!pointValid || point != size)) {
+        glPointSize(size);
+        point = size;
+        pointValid = true;
+    }
+}
+
+void RenderState::lineWidth(float width) {
+    if (track(!lineValid || line != width)) {
+        glLineWidth(width);
+        line = width;
+        lineValid = true;
+    }
+}
+
+void RenderState::uniform1i(GLint location, int value) {
+    if (location < 0 || !programValid) return;
+
+    std::pair<GLuint, GLint> key(program, location);
+    std::map<std::pair<GLuint, GLint>, int>::iterator it = uniforms.find(key);
+
+    if (track(it == uniforms.end() || it->second != value)) {
+        glUniform1i(location, value);
+        uniforms[key] = value;
+    }
+}
+
+void RenderState::uniform1ui(GLint location, GLuint value) {
+    if (location < 0 || !programValid) return;
+
+    std::pair<GLuint, GLint> key(program, location);
+    std::map<std::pair<GLuint, GLint>, GLuint>::iterator it = uintUniforms.find(key);
+
+    if (track(it == uintUniforms.end() || it->second != value)) {
+        glUniform1ui(location, value);
+        uintUniforms[key] = value;
+    }
+}
+
+void RenderState::uniform1f(GLint location, float value) {
+    if (location < 0 || !programValid) return;
+
+    std::pair<GLuint, GLint> key(program, location);
+    std::map<std::pair<GLuint, GLint>, float>::iterator it = floatUniforms.find(key);
+
+    if (track(it == floatUniforms.end() || it->second != value)) {
+        glUniform1f(location, value);
+        floatUniforms[key] = value;
+    }
+}
+
+void RenderState::uniform3f(GLint location, glm::vec3 value) {
+    if (location < 0 || !programValid) return;
+
+    std::pair<GLuint, GLint> key(program, location);
+    std::map<std::pair<GLuint, GLint>, glm::vec3>::iterator it = vec3Uniforms.find(key);
+
+    if (track(it == vec3Uniforms.end() || it->second != value)) {
+        glUniform3f(location, value.x, value.y, value.z);
+        vec3Uniforms[key] = value;
+    }
+}
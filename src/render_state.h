@@ -0,0 +1,93 @@
+#pragma once
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <map>
+#include <utility>
+
+/// @brief Shadow copy of the GL state touched by Model. Every setter compares the requested value
+///        with the cached one and calls GL only on change, counting issued and elided calls.
+///        GL state belongs to the context, so one instance should be shared by everything
+///        that draws into that context.
+class RenderState {
+    public:
+        RenderState();
+
+        /// @brief Forgets every cached value, the next call of each setter reaches GL.
+        ///        Use after code outside this tracker changed GL state.
+        void invalidate();
+
+        /// @brief glUseProgram
+        void useProgram(GLuint program);
+
+        /// @brief glBindVertexArray
+        void bindVertexArray(GLuint vao);
+
+        /// @brief Must be called before glDeleteVertexArrays, GL resets the binding of a deleted VAO
+        ///        and the name may be handed out again by glGenVertexArrays
+        void vertexArrayDeleted(GLuint vao);
+
+        /// @brief Must be called before glDeleteProgram: forgets the cached uniforms of the program,
+        ///        a program created later may get the same name
+        void programDeleted(GLuint program);
+
+        /// @brief glPolygonMode(GL_FRONT_AND_BACK, mode)
+        void polygonMode(GLenum mode);
+
+        /// @brief glEnable / glDisable(GL_CULL_FACE)
+        void cullFace(bool enabled);
+
+        /// @brief glCullFace
+        void cullFaceMode(GLenum mode);
+
+        /// @brief glEnable / glDisable of primitive restart at index 0xFFFFFFFF (GL_UNSIGNED_INT):
+        ///        GL_PRIMITIVE_RESTART_FIXED_INDEX on GL 4.3, GL_PRIMITIVE_RESTART + glPrimitiveRestartIndex below
+        void primitiveRestart(bool enabled);
+
+        /// @brief glPointSize
+        void pointSize(float size);
+
+        /// @brief glLineWidth
+        void lineWidth(float width);
+
+        /// @brief glUniform1i on the current program; location comes from link time, -1 is ignored
+        void uniform1i(GLint location, int value);
+
+        /// @brief glUniform1ui, the same as uniform1i
+        void uniform1ui(GLint location, GLuint value);
+
+        /// @brief glUniform1f, the same as uniform1i
+        void uniform1f(GLint location, float value);
+
+        /// @brief glUniform3f, the same as uniform1i
+        void uniform3f(GLint location, glm::vec3 value);
+
+        /// @brief GL calls that reached the driver since the last resetCounters
+        long long getIssuedCalls() const { return issuedCalls; }
+
+        /// @brief GL calls skipped because the value was already set
+        long long getElidedCalls() const { return elidedCalls; }
+
+        void resetCounters();
+
+    private:
+        /// @brief Updates the counters, returns changed
+        bool track(bool changed);
+
+        GLuint program;
+        GLuint vao;
+        GLenum polygon;
+        int cullEnabled;   // -1 unknown, 0 off, 1 on
+        int restartEnabled; // the same
+        GLenum cullMode;
+        float point;
+        float line;
+        bool programValid, vaoValid, polygonValid, cullModeValid, pointValid, lineValid;
+
+        std::map<std::pair<GLuint, GLint>, int> uniforms; // (program, location) -> value
+        std::map<std::pair<GLuint, GLint>, GLuint> uintUniforms;
+        std::map<std::pair<GLuint, GLint>, float> floatUniforms;
+        std::map<std::pair<GLuint, GLint>, glm::vec3> vec3Uniforms;
+
+        long long issuedCalls;
+        long long elidedCalls;
+};
@@ -0,0 +1,292 @@
+#include <scene.h>
+#include <vertex_format.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// indexed by VariantBits, the same programs as Model::initialize
+static const std::vector<std::string> VARIANT_DEFINES = {"FLAT_SHADING", "POINT_AA"};
+
+// layout (location = 1) and (location = 2) in vertex_shader.glsl
+static const GLint VIEW_LOCATION = 1;
+static const GLint COLOR_SEED_LOCATION = 2;
+
+static const size_t VERTEX_STRIDE = 24; // VertexFormat::FLOAT with colors
+
+static bool isPoints(GLenum primitive, GLenum polygonMode) {
+    return primitive == GL_POINTS || polygonMode == GL_POINT;
+}
+
+static bool isLines(GLenum primitive, GLenum polygonMode) {
+    return primitive == GL_LINES || primitive == GL_LINE_STRIP || primitive == GL_LINE_LOOP ||
+           polygonMode == GL_LINE;
+}
+
+// the polygon mode only applies to triangles, other primitives share the GL_FILL batches
+static GLenum polygonModeOf(const Scene::Style& style) {
+    bool triangles = style.primitive == GL_TRIANGLES || style.primitive == GL_TRIANGLE_STRIP ||
+                     style.primitive == GL_TRIANGLE_FAN;
+    return triangles ? style.polygonMode : GL_FILL;
+}
+
+Scene::Scene(RenderState& state, size_t vertices, size_t indices)
+    : state(state), variants(state), vertexAllocator(std::max<size_t>(vertices, 1)), indexAllocator(std::max<size_t>(indices, 1)) {
+    vao = 0; vbo = 0; ebo = 0;
+    vboBytes = 0;
+    eboBytes = 0;
+    grows = 0;
+    shapeCount = 0;
+    batchesDirty = false;
+}
+
+Scene::~Scene() {
+    if (ebo != 0) glDeleteBuffers(1, &ebo);
+    if (vbo != 0) glDeleteBuffers(1, &vbo);
+    if (vao != 0) {
+        state.vertexArrayDeleted(vao);
+        glDeleteVertexArrays(1, &vao);
+    }
+}
+
+void Scene::initialize(const char* vertexPath, const char* fragmentPath, ProgramCache* cache) {
+    variants.compile(vertexPath, fragmentPath, VARIANT_DEFINES, cache);
+
+    vboBytes = vertexAllocator.getCapacity() * VERTEX_STRIDE;
+    eboBytes = indexAllocator.getCapacity() * sizeof(uint32_t);
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glGenBuffers(1, &ebo);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+    glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)vboBytes, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+    glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)eboBytes, nullptr, GL_DYNAMIC_DRAW);
+    setupVertexArray();
+}
+
+void Scene::setupVertexArray() {
+    state.bindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    VertexFormat::setAttributes(VertexFormat::FLOAT);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    state.bindVertexArray(0);
+}
+
+void Scene::growBuffer(GLuint& buffer, size_t& capacityBytes, size_t neededBytes) {
+    size_t bytes = std::max<size_t>(capacityBytes, 1);
+    while (bytes < neededBytes) bytes *= 2;
+
+    // the old contents are copied on the GPU, nothing is read back
+    GLuint grown = 0;
+    glGenBuffers(1, &grown);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+    glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)bytes, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)capacityBytes);
+    glDeleteBuffers(1, &buffer);
+
+    buffer = grown;
+    capacityBytes = bytes;
+    grows++;
+}
+
+void Scene::allocate(Shape& shape) {
+    shape.firstVertex = vertexAllocator.allocate(shape.vertexCount);
+    if (shape.firstVertex == BufferAllocator::INVALID) {
+        // doubling: the free tail merges with the new space, so the block fits afterwards
+        size_t needed = vertexAllocator.getCapacity() + shape.vertexCount;
+        growBuffer(vbo, vboBytes, needed * VERTEX_STRIDE);
+        vertexAllocator.grow(vboBytes / VERTEX_STRIDE);
+        shape.firstVertex = vertexAllocator.allocate(shape.vertexCount);
+        setupVertexArray();
+    }
+
+    shape.firstIndex = 0;
+    if (shape.indexCount == 0) return;
+    shape.firstIndex = indexAllocator.allocate(shape.indexCount);
+    if (shape.firstIndex == BufferAllocator::INVALID) {
+        size_t needed = indexAllocator.getCapacity() + shape.indexCount;
+        growBuffer(ebo, eboBytes, needed * sizeof(uint32_t));
+        indexAllocator.grow(eboBytes / sizeof(uint32_t));
+        shape.firstIndex = indexAllocator.allocate(shape.indexCount);
+        setupVertexArray();
+    }
+}
+
+Scene::ShapeId Scene::add(const Style& style, const float* positions, const float* colors, size_t count,
+                          const uint32_t* indices, size_t indexCount) {
+    if (vao == 0) {
+        std::cout << "Scene: add before initialize" << std::endl;
+        return INVALID_SHAPE;
+    }
+    if (count == 0 || (indices != nullptr && indexCount == 0)) return INVALID_SHAPE;
+
+    Shape shape;
+    shape.style = style;
+    shape.vertexCount = count;
+    shape.indexCount = indices != nullptr ? indexCount : 0;
+    shape.alive = true;
+    allocate(shape);
+
+    // GL_COPY_WRITE_BUFFER leaves the element buffer of whatever VAO is bound untouched
+    scratch.resize(count * VERTEX_STRIDE);
+    VertexFormat::pack(VertexFormat::FLOAT, positions, colors, count, scratch.data());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)(shape.firstVertex * VERTEX_STRIDE),
+                    (GLsizeiptr)scratch.size(), scratch.data());
+    if (shape.indexCount > 0) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)(shape.firstIndex * sizeof(uint32_t)),
+                        (GLsizeiptr)(shape.indexCount * sizeof(uint32_t)), indices);
+    }
+
+    ShapeId id;
+    if (!freeIds.empty()) {
+        id = freeIds.back();
+        freeIds.pop_back();
+        shapes[id] = shape;
+    } else {
+        id = (ShapeId)shapes.size();
+        shapes.push_back(shape);
+    }
+    shapeCount++;
+    batchesDirty = true;
+    return id;
+}
+
+void Scene::remove(ShapeId shape) {
+    if (shape >= shapes.size() || !shapes[shape].alive) return;
+
+    Shape& removed = shapes[shape];
+    vertexAllocator.free(removed.firstVertex);
+    if (removed.indexCount > 0) indexAllocator.free(removed.firstIndex);
+    removed.alive = false;
+    freeIds.push_back(shape);
+    shapeCount--;
+    batchesDirty = true;
+}
+
+void Scene::setStyle(ShapeId shape, const Style& style) {
+    if (shape >= shapes.size() || !shapes[shape].alive) return;
+    shapes[shape].style = style;
+    batchesDirty = true;
+}
+
+void Scene::clear() {
+    shapes.clear();
+    freeIds.clear();
+    shapeCount = 0;
+    vertexAllocator.reset();
+    indexAllocator.reset();
+    batches.clear();
+    batchesDirty = false;
+}
+
+int Scene::variantOf(const Style& style) const {
+    int variant = 0;
+    if (style.flatShading) variant |= FLAT_VARIANT;
+    // point AA only changes points, as in Model::currentVariant
+    if (style.smoothPoints && isPoints(style.primitive, polygonModeOf(style))) variant |= POINT_AA_VARIANT;
+    return variant;
+}
+
+float Scene::sizeOf(const Style& style) const {
+    if (isPoints(style.primitive, polygonModeOf(style))) return style.pointSize;
+    if (isLines(style.primitive, polygonModeOf(style))) return style.lineWidth;
+    return 0.0f;
+}
+
+uint64_t Scene::keyOf(const Style& style, bool indexed) const {
+    GLenum polygonMode = polygonModeOf(style);
+    uint32_t sizeBits = 0;
+    float size = sizeOf(style);
+    std::memcpy(&sizeBits, &size, sizeof(sizeBits)); // positive floats order like their bits
+
+    // most expensive change first: program, then fixed-function state, then the draw itself
+    return (uint64_t)variantOf(style) << 46 | (uint64_t)(polygonMode - GL_POINT) << 44 |
+           (uint64_t)sizeBits << 12 | (uint64_t)(style.primitive & 0xFF) << 1 | (indexed ? 1 : 0);
+}
+
+void Scene::rebuildBatches() {
+    std::vector<std::pair<uint64_t, ShapeId>> order;
+    order.reserve(shapeCount);
+    for (ShapeId id = 0; id < shapes.size(); ++id) {
+        if (shapes[id].alive) order.emplace_back(keyOf(shapes[id].style, shapes[id].indexCount > 0), id);
+    }
+    // by key, then by position in the buffer
+    std::sort(order.begin(), order.end(), [this](const std::pair<uint64_t, ShapeId>& a,
+                                                 const std::pair<uint64_t, ShapeId>& b) {
+        if (a.first != b.first) return a.first < b.first;
+        return shapes[a.second].firstVertex < shapes[b.second].firstVertex;
+    });
+
+    batches.clear();
+    for (const std::pair<uint64_t, ShapeId>& entry : order) {
+        const Shape& shape = shapes[entry.second];
+        if (batches.empty() || batches.back().key != entry.first) {
+            Batch batch;
+            batch.key = entry.first;
+            batch.primitive = shape.style.primitive;
+            batch.polygonMode = polygonModeOf(shape.style);
+            batch.variant = variantOf(shape.style);
+            batch.size = sizeOf(shape.style);
+            batch.indexed = shape.indexCount > 0;
+            batches.push_back(std::move(batch));
+        }
+
+        Batch& batch = batches.back();
+        batch.firsts.push_back((GLint)shape.firstVertex);
+        if (batch.indexed) {
+            batch.counts.push_back((GLsizei)shape.indexCount);
+            batch.offsets.push_back((const void*)(shape.firstIndex * sizeof(uint32_t)));
+        } else {
+            batch.counts.push_back((GLsizei)shape.vertexCount);
+        }
+    }
+    batchesDirty = false;
+}
+
+int Scene::draw(glm::vec3 view) {
+    if (batchesDirty) rebuildBatches();
+    if (batches.empty()) return 0;
+
+    state.bindVertexArray(vao);
+    state.cullFace(false);
+    state.primitiveRestart(false);
+
+    for (const Batch& batch : batches) {
+        state.useProgram(variants.get(batch.variant));
+        state.uniform3f(VIEW_LOCATION, view);
+        state.uniform1i(COLOR_SEED_LOCATION, 0);
+        state.polygonMode(batch.polygonMode);
+        if (isPoints(batch.primitive, batch.polygonMode)) {
+            state.pointSize(batch.size);
+        } else if (isLines(batch.primitive, batch.polygonMode)) {
+            state.lineWidth(batch.size);
+        }
+
+        if (batch.indexed) {
+            // indices count from the first vertex of their shape
+            glMultiDrawElementsBaseVertex(batch.primitive, batch.counts.data(), GL_UNSIGNED_INT,
+                                          batch.offsets.data(), (GLsizei)batch.counts.size(), batch.firsts.data());
+        } else {
+            glMultiDrawArrays(batch.primitive, batch.firsts.data(), batch.counts.data(),
+                              (GLsizei)batch.counts.size());
+        }
+    }
+    return (int)batches.size();
+}
+
+Scene::Stats Scene::getStats() const {
+    Stats stats;
+    stats.shapes = shapeCount;
+    stats.vertexBytes = vertexAllocator.getUsed() * VERTEX_STRIDE;
+    stats.vertexCapacityBytes = vboBytes;
+    stats.indexBytes = indexAllocator.getUsed() * sizeof(uint32_t);
+    stats.indexCapacityBytes = eboBytes;
+    stats.freeBlocks = vertexAllocator.getFreeBlocks() + indexAllocator.getFreeBlocks();
+    stats.vertexFragmentation = vertexAllocator.getFragmentation();
+    stats.indexFragmentation = indexAllocator.getFragmentation();
+    stats.grows = grows;
+    stats.batches = batches.size();
+    return stats;
+}
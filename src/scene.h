@@ -0,0 +1,138 @@
+#pragma once
+#include <GL/glew.h>
+#include <buffer_allocator.h>
+#include <render_state.h>
+#include <shader_variants.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ProgramCache;
+
+/// @brief Many independent shapes in one vertex buffer, one index buffer and one VAO. Each shape gets
+///        a block of both buffers from a BufferAllocator; when a block does not fit, the buffer doubles
+///        and the old contents are copied on the GPU. Shapes are grouped by their state (program
+///        variant, primitive, polygon mode, point size / line width, indexed or not) and every group
+///        is one glMultiDrawArrays or glMultiDrawElementsBaseVertex, so the draw calls per frame
+///        follow the number of distinct states, not the number of shapes.
+///        Vertices are VertexFormat::FLOAT with colors; drawn with vertex_shader.glsl like Model.
+class Scene {
+    public:
+        typedef uint32_t ShapeId;
+        static constexpr ShapeId INVALID_SHAPE = UINT32_MAX;
+
+        /// @brief Per-shape rendering state, what Model keeps once per task
+        struct Style {
+            GLenum primitive = GL_TRIANGLES; // any glDrawArrays mode, strips and fans stay per shape
+            GLenum polygonMode = GL_FILL;
+            bool flatShading = true;
+            bool smoothPoints = true;        // POINT_AA variant for points
+            float pointSize = 24.0f;
+            float lineWidth = 8.0f;
+        };
+
+        struct Stats {
+            size_t shapes = 0;
+            size_t vertexBytes = 0;          // in use
+            size_t vertexCapacityBytes = 0;
+            size_t indexBytes = 0;
+            size_t indexCapacityBytes = 0;
+            size_t freeBlocks = 0;           // holes of both buffers
+            double vertexFragmentation = 0.0; // see BufferAllocator::getFragmentation
+            double indexFragmentation = 0.0;
+            size_t grows = 0;                // buffer reallocations since construction
+            size_t batches = 0;              // draw calls of the last draw
+        };
+
+        /// @param state Tracker of the context the scene is drawn in
+        /// @param vertices Initial vertex capacity
+        /// @param indices Initial index capacity
+        Scene(RenderState& state, size_t vertices = 1 << 16, size_t indices = 1 << 16);
+        ~Scene();
+
+        Scene(const Scene&) = delete;
+        Scene& operator=(const Scene&) = delete;
+
+        /// @brief Starts compiling the program variants, needs a current GL context
+        void initialize(const char* vertexPath, const char* fragmentPath, ProgramCache* cache = nullptr);
+
+        /// @brief Uploads a shape into the shared buffers. GL thread only.
+        /// @param positions x, y, z per vertex
+        /// @param colors r, g, b per vertex, nullptr for white
+        /// @param indices Optional, relative to the shape's first vertex
+        /// @return Id for setStyle/remove, INVALID_SHAPE for an empty shape
+        ShapeId add(const Style& style, const float* positions, const float* colors, size_t count,
+                    const uint32_t* indices = nullptr, size_t indexCount = 0);
+
+        /// @brief Frees the shape's blocks for later shapes, the id may be handed out again
+        void remove(ShapeId shape);
+
+        void setStyle(ShapeId shape, const Style& style);
+
+        /// @brief Removes every shape, keeps the buffers
+        void clear();
+
+        /// @brief Draws every shape
+        /// @param view Center x, y and zoom, as u_view of vertex_shader.glsl
+        /// @return Number of draw calls
+        int draw(glm::vec3 view);
+
+        Stats getStats() const;
+
+        size_t getShapeCount() const { return shapeCount; }
+
+    private:
+        /// @brief Bits of a ShaderVariants index, as in Model
+        enum VariantBits {
+            FLAT_VARIANT = 1,     // FLAT_SHADING
+            POINT_AA_VARIANT = 2  // POINT_AA
+        };
+
+        struct Shape {
+            Style style;
+            size_t firstVertex, vertexCount;
+            size_t firstIndex, indexCount; // indexCount 0 - drawn with glDrawArrays
+            bool alive;
+        };
+
+        /// @brief Shapes drawn with one call, sorted by their first vertex
+        struct Batch {
+            uint64_t key;
+            GLenum primitive;
+            GLenum polygonMode;
+            int variant;
+            float size;                    // point size or line width, 0 if neither applies
+            bool indexed;
+            std::vector<GLint> firsts;     // first vertex, or base vertex when indexed
+            std::vector<GLsizei> counts;
+            std::vector<const void*> offsets; // indexed: byte offset of the first index
+        };
+
+        int variantOf(const Style& style) const;
+        float sizeOf(const Style& style) const;
+        uint64_t keyOf(const Style& style, bool indexed) const;
+
+        /// @brief Reserves space in both buffers, growing them as needed
+        void allocate(Shape& shape);
+        /// @brief Doubles the buffer until it holds neededBytes, the VAO must be set up again after
+        void growBuffer(GLuint& buffer, size_t& capacityBytes, size_t neededBytes);
+        void setupVertexArray();
+        void rebuildBatches();
+
+        RenderState& state;
+        ShaderVariants variants;
+        GLuint vao, vbo, ebo;
+        size_t vboBytes, eboBytes;
+        BufferAllocator vertexAllocator;
+        BufferAllocator indexAllocator;
+        size_t grows;
+
+        std::vector<Shape> shapes;
+        std::vector<ShapeId> freeIds;
+        size_t shapeCount;
+
+        std::vector<Batch> batches;
+        bool batchesDirty;
+        std::vector<char> scratch; // packed vertices of the shape being added
+};
@@ -0,0 +1,168 @@
+#include <shader_variants.h>
+#include <functions.h>
+#include <program_cache.h>
+
+/// @brief Inserts the defines right after "#version ..." (it has to stay the first line)
+///        and restores line numbers for compiler messages with #line
+static std::string injectDefines(const std::string& source, const std::vector<std::string>& defines, int variant,
+                                 const std::string& stageDefines) {
+    size_t versionEnd = 0;
+    int versionLine = 0;
+    if (source.compare(0, 8, "#version") == 0) {
+        versionEnd = source.find('\n');
+        versionEnd = versionEnd == std::string::npos ? source.size() : versionEnd + 1;
+        versionLine = 1;
+    }
+
+    std::string header = stageDefines;
+    for (size_t k = 0; k < defines.size(); ++k) {
+        if (variant & (1 << k)) header += "#define " + defines[k] + "\n";
+    }
+    header += "#line " + std::to_string(versionLine + 1) + "\n";
+
+    std::string result = source.substr(0, versionEnd);
+    if (versionEnd > 0 && result.back() != '\n') result += '\n';
+    return result + header + source.substr(versionEnd);
+}
+
+static void printShaderLog(GLuint shader, const char* stage) {
+    GLint compiled = GL_FALSE;
+    int infoLogLength = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLogLength);
+    if (compiled != GL_TRUE && infoLogLength > 0) {
+        std::vector<char> errorMessage(infoLogLength + 1, '\0');
+        glGetShaderInfoLog(shader, infoLogLength, NULL, errorMessage.data());
+        std::cout << "ERROR::SHADER::" << stage << "::COMPILATION_FAILED\n" << errorMessage.data() << std::endl;
+    }
+}
+
+ShaderVariants::ShaderVariants(RenderState& state) : state(state) {
+    cache = nullptr;
+}
+
+ShaderVariants::~ShaderVariants() {
+    release();
+}
+
+void ShaderVariants::release() {
+    for (Variant& variant : variants) {
+        if (variant.vertexShader != 0) glDeleteShader(variant.vertexShader);
+        if (variant.fragmentShader != 0) glDeleteShader(variant.fragmentShader);
+        if (variant.geometryShader != 0) glDeleteShader(variant.geometryShader);
+        if (variant.program != 0) {
+            state.programDeleted(variant.program);
+            glDeleteProgram(variant.program);
+        }
+    }
+    variants.clear();
+}
+
+void ShaderVariants::compile(const char* vertexPath, const char* fragmentPath,
+                             const std::vector<std::string>& defines, ProgramCache* programCache,
+                             const char* geometryPath, const char* stageDefine) {
+    release();
+    cache = programCache;
+
+    bool geometryStage = geometryPath != nullptr;
+    std::string vertexCode = readShaderFile(vertexPath);
+    std::string fragmentCode = readShaderFile(fragmentPath);
+    std::string geometryCode = geometryStage ? readShaderFile(geometryPath) : std::string();
+
+    std::string stageDefines = geometryStage ? "#define GEOMETRY_STAGE\n" : "";
+    if (stageDefine) stageDefines += "#define " + std::string(stageDefine) + "\n";
+
+    if (GLEW_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu); // as many as the driver wants
+    }
+
+    variants.resize((size_t)1 << defines.size());
+    for (size_t i = 0; i < variants.size(); ++i) {
+        Variant& variant = variants[i];
+        variant.vertexCode = injectDefines(vertexCode, defines, (int)i, stageDefines);
+        variant.fragmentCode = injectDefines(fragmentCode, defines, (int)i, stageDefines);
+        if (geometryStage) variant.geometryCode = injectDefines(geometryCode, defines, (int)i, stageDefines);
+        variant.vertexShader = 0;
+        variant.fragmentShader = 0;
+        variant.geometryShader = 0;
+        variant.checked = false;
+
+        variant.program = cache ? cache->find(variant.vertexCode, variant.fragmentCode, variant.geometryCode) : 0;
+        if (variant.program != 0) {
+            variant.checked = true; // restored binaries are already linked
+            variant.vertexCode.clear();
+            variant.fragmentCode.clear();
+            variant.geometryCode.clear();
+            continue;
+        }
+
+        // no status queries here: any of them would wait for the compiler
+        const char* vertexSource = variant.vertexCode.c_str();
+        const char* fragmentSource = variant.fragmentCode.c_str();
+
+        variant.vertexShader = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(variant.vertexShader, 1, &vertexSource, NULL);
+        glCompileShader(variant.vertexShader);
+
+        variant.fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(variant.fragmentShader, 1, &fragmentSource, NULL);
+        glCompileShader(variant.fragmentShader);
+
+        if (geometryStage) {
+            const char* geometrySource = variant.geometryCode.c_str();
+            variant.geometryShader = glCreateShader(GL_GEOMETRY_SHADER);
+            glShaderSource(variant.geometryShader, 1, &geometrySource, NULL);
+            glCompileShader(variant.geometryShader);
+        }
+
+        variant.program = glCreateProgram();
+        if (cache) {
+            glProgramParameteri(variant.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+        glAttachShader(variant.program, variant.vertexShader);
+        glAttachShader(variant.program, variant.fragmentShader);
+        if (variant.geometryShader != 0) glAttachShader(variant.program, variant.geometryShader);
+        glLinkProgram(variant.program);
+    }
+}
+
+bool ShaderVariants::isReady(int index) const {
+    if (index < 0 || index >= (int)variants.size()) return false;
+
+    const Variant& variant = variants[index];
+    if (variant.checked || !GLEW_KHR_parallel_shader_compile) return true;
+
+    GLint done = GL_FALSE;
+    glGetProgramiv(variant.program, GL_COMPLETION_STATUS_KHR, &done);
+    return done == GL_TRUE;
+}
+
+GLuint ShaderVariants::get(int index) {
+    if (index < 0 || index >= (int)variants.size()) return 0;
+
+    Variant& variant = variants[index];
+    if (variant.checked) return variant.program;
+    variant.checked = true;
+
+    if (checkProgramLinked(variant.program)) {
+        if (cache) cache->store(variant.vertexCode, variant.fragmentCode, variant.program, variant.geometryCode);
+    } else {
+        printShaderLog(variant.vertexShader, "VERTEX");
+        printShaderLog(variant.fragmentShader, "FRAGMENT");
+        if (variant.geometryShader != 0) printShaderLog(variant.geometryShader, "GEOMETRY");
+        state.programDeleted(variant.program);
+        glDeleteProgram(variant.program);
+        variant.program = 0;
+    }
+
+    glDeleteShader(variant.vertexShader);
+    glDeleteShader(variant.fragmentShader);
+    if (variant.geometryShader != 0) glDeleteShader(variant.geometryShader);
+    variant.vertexShader = 0;
+    variant.fragmentShader = 0;
+    variant.geometryShader = 0;
+    variant.vertexCode.clear();
+    variant.fragmentCode.clear();
+    variant.geometryCode.clear();
+    return variant.program;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <GL/glew.h>
+#include <render_state.h>
+#include <string>
+#include <vector>
+
+class ProgramCache;
+
+/// @brief Specialized permutations of one vertex + fragment shader pair, optionally with a geometry
+///        shader. Variant i is compiled with "#define defines[k]" for every bit k set in i, inserted
+///        after the #version line of every stage.
+///        All variants are submitted at once and nothing waits for the compiler until a variant
+///        is first used: with GL_KHR_parallel_shader_compile the driver builds them on its own threads.
+class ShaderVariants {
+    public:
+        /// @param state Tracker the programs are used through, their cached uniforms are dropped on release
+        ShaderVariants(RenderState& state);
+        ~ShaderVariants();
+
+        /// @brief Starts compiling 2^defines.size() programs, needs a current GL context
+        /// @param vertexPath File path to the vertex shader source
+        /// @param fragmentPath File path to the fragment shader source
+        /// @param defines Macro names, bit k of the variant index enables defines[k]
+        /// @param cache Optional: variants found on disk are not compiled, new ones are stored once linked
+        /// @param geometryPath Optional geometry shader; every stage then also sees GEOMETRY_STAGE defined
+        /// @param stageDefine Optional macro defined in every stage of every variant (e.g. THICK_LINE)
+        void compile(const char* vertexPath, const char* fragmentPath,
+                     const std::vector<std::string>& defines, ProgramCache* cache = nullptr,
+                     const char* geometryPath = nullptr, const char* stageDefine = nullptr);
+
+        /// @brief Number of variants, 0 before compile
+        size_t size() const { return variants.size(); }
+
+        /// @brief true once the variant can be used without blocking (always true without
+        ///        GL_KHR_parallel_shader_compile)
+        bool isReady(int variant) const;
+
+        /// @brief Program of the variant, waits for the compiler on first use
+        /// @return Linked program, 0 if it failed to compile or link
+        GLuint get(int variant);
+
+        /// @brief Deletes every program
+        void release();
+
+    private:
+        struct Variant {
+            GLuint program;
+            GLuint vertexShader, fragmentShader, geometryShader; // kept until checked for the error log
+            bool checked;
+            std::string vertexCode, fragmentCode, geometryCode; // for the cache, dropped once stored
+        };
+
+        RenderState& state;
+        std::vector<Variant> variants;
+        ProgramCache* cache;
+};
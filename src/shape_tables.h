@@ -0,0 +1,292 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Geometry of the fixed-shape tasks computed by the compiler: regular polygons, outlines
+///        triangulated by the same ear clipping as Triangulator and expanded into triangle lists or
+///        indexed vertices the way Model::appendTriangles does. Positions are x, y, z like the arena of
+///        GeometryBuilder, so a task switch copies them out of read-only data in one memcpy.
+namespace ShapeTables {
+
+struct Point {
+    float x, y;
+};
+
+/// @brief Indices into a point table, counter-clockwise unless the outline was clockwise
+struct Triangle {
+    int a, b, c;
+};
+
+/// @brief N vertices as x, y, 0
+template <size_t N>
+struct Vertices {
+    static constexpr size_t count = N;
+    std::array<float, N * 3> positions{};
+};
+
+/// @brief Indexed triangles where every triangle has a last vertex of its own (flat shading takes the
+///        color of the last vertex): the points, then copies of shared last corners
+template <size_t P, size_t T>
+struct IndexedTriangles {
+    std::array<float, (P + T) * 3> positions{};
+    size_t vertices = 0;
+    std::array<uint32_t, T * 3> indices{};
+};
+
+/// @brief Non-template view of a TriangleShape for Model::appendTriangles
+struct TriangleView {
+    const float* list;              // T * 3 vertices, GL_TRIANGLES without indices
+    size_t listVertices;
+    const float* indexedPositions;  // for indexed drawing or Stripifier
+    size_t indexedVertices;
+    const uint32_t* indices;
+    size_t indexCount;
+};
+
+/// @brief A triangulated shape in both layouts Model draws
+template <size_t P, size_t T>
+struct TriangleShape {
+    Vertices<T * 3> list;
+    IndexedTriangles<P, T> indexed;
+
+    constexpr TriangleView view() const {
+        return {list.positions.data(), list.count, indexed.positions.data(), indexed.vertices,
+                indexed.indices.data(), indexed.indices.size()};
+    }
+};
+
+namespace detail {
+
+constexpr double PI = 3.14159265358979323846;
+
+/// @brief Taylor series after reducing x to [-pi, pi], exact to a few ulp of double: the float
+///        corners are the correctly rounded ones
+constexpr double sine(double x) {
+    while (x > PI) x -= 2.0 * PI;
+    while (x < -PI) x += 2.0 * PI;
+    double term = x, sum = x;
+    for (int n = 1; n < 20; ++n) {
+        term *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double cosine(double x) {
+    while (x > PI) x -= 2.0 * PI;
+    while (x < -PI) x += 2.0 * PI;
+    double term = 1.0, sum = 1.0;
+    for (int n = 1; n < 20; ++n) {
+        term *= -x * x / ((2.0 * n - 1.0) * (2.0 * n));
+        sum += term;
+    }
+    return sum;
+}
+
+/// @brief > 0 if a, b, c turn left, in double like Triangulator
+constexpr double orient(Point a, Point b, Point c) {
+    double abx = (double)b.x - a.x, aby = (double)b.y - a.y;
+    double bcx = (double)c.x - b.x, bcy = (double)c.y - b.y;
+    return abx * bcy - aby * bcx;
+}
+
+constexpr bool same(Point a, Point b) {
+    return a.x == b.x && a.y == b.y;
+}
+
+template <size_t N>
+constexpr void setVertex(std::array<float, N>& positions, size_t i, Point p) {
+    positions[i * 3] = p.x;
+    positions[i * 3 + 1] = p.y;
+    positions[i * 3 + 2] = 0.0f;
+}
+
+} // namespace detail
+
+/// @brief Corners of a regular N-gon at the origin, corner i at angle 2*pi*i/N as NgonGenerator::corners
+template <int N>
+struct RegularPolygon {
+    static_assert(N >= 3, "a polygon has at least 3 corners");
+
+    static constexpr Point corner(int i, float radius) {
+        double angle = 2.0 * detail::PI * (i % N) / N;
+        return {(float)(radius * detail::cosine(angle)), (float)(radius * detail::sine(angle))};
+    }
+
+    /// @brief The corners, GL_POINTS (Task1)
+    static constexpr Vertices<N> corners(float radius) {
+        Vertices<N> result;
+        for (int i = 0; i < N; ++i) detail::setVertex(result.positions, i, corner(i, radius));
+        return result;
+    }
+
+    /// @brief Segment i from corner i to corner i + 1, GL_LINES (Task2)
+    static constexpr Vertices<2 * N> lines(float radius) {
+        Vertices<2 * N> result;
+        for (int i = 0; i < 2 * N; ++i) detail::setVertex(result.positions, i, corner(i / 2 + i % 2, radius));
+        return result;
+    }
+
+    /// @brief The corners with the first one repeated at the end, GL_TRIANGLE_FAN (Task6)
+    static constexpr Vertices<N + 1> fan(float radius) {
+        Vertices<N + 1> result;
+        for (int i = 0; i <= N; ++i) detail::setVertex(result.positions, i, corner(i, radius));
+        return result;
+    }
+};
+
+/// @brief The points as vertices, in order
+template <size_t N>
+constexpr Vertices<N> vertices(const std::array<Point, N>& points) {
+    Vertices<N> result;
+    for (size_t i = 0; i < N; ++i) detail::setVertex(result.positions, i, points[i]);
+    return result;
+}
+
+/// @brief Triangulator::triangulate(points, outline) with ear clipping, the same triangles in the same order
+/// @param outline Indices into points, in order, either winding, not degenerate
+template <size_t N, size_t M>
+constexpr std::array<Triangle, M - 2> earClipping(const std::array<Point, N>& points,
+                                                  const std::array<int, M>& outline) {
+    static_assert(M >= 3, "an outline has at least 3 corners");
+    const int n = (int)M;
+
+    double area = 0.0;
+    for (int i = 0; i < n; ++i) {
+        Point a = points[outline[i]], b = points[outline[(i + 1) % n]];
+        area += (double)a.x * b.y - (double)b.x * a.y;
+    }
+    bool clockwise = area < 0.0;
+
+    // counter-clockwise copy
+    std::array<Point, M> P{};
+    std::array<int, M> id{};
+    std::array<int, M> prev{}, next{};
+    for (int i = 0; i < n; ++i) {
+        id[i] = outline[clockwise ? n - 1 - i : i];
+        P[i] = points[id[i]];
+        prev[i] = (i + n - 1) % n;
+        next[i] = (i + 1) % n;
+    }
+
+    std::array<Triangle, M - 2> triangles{};
+    size_t emitted = 0;
+    auto emit = [&](int a, int b, int c) {
+        if (detail::orient(P[a], P[b], P[c]) < 0.0) {
+            int swap = b;
+            b = c;
+            c = swap;
+        }
+        // triangulate() flips clockwise outlines back
+        triangles[emitted++] = clockwise ? Triangle{id[a], id[c], id[b]} : Triangle{id[a], id[b], id[c]};
+    };
+
+    int remaining = n;
+    int v = 0;
+    int sinceLastEar = 0;
+    while (remaining > 3) {
+        int a = prev[v], c = next[v];
+        bool ear = detail::orient(P[a], P[v], P[c]) > 0.0;
+
+        for (int p = next[c]; ear && p != a; p = next[p]) {
+            if (detail::orient(P[prev[p]], P[p], P[next[p]]) > 0.0) continue;
+            if (detail::same(P[p], P[a]) || detail::same(P[p], P[v]) || detail::same(P[p], P[c])) continue;
+            if (detail::orient(P[a], P[v], P[p]) >= 0.0 && detail::orient(P[v], P[c], P[p]) >= 0.0 &&
+                detail::orient(P[c], P[a], P[p]) >= 0.0) {
+                ear = false;
+            }
+        }
+
+        if (ear || sinceLastEar > remaining) {
+            emit(a, v, c);
+            next[a] = c;
+            prev[c] = a;
+            --remaining;
+            sinceLastEar = 0;
+            v = a;
+        } else {
+            v = c;
+            ++sinceLastEar;
+        }
+    }
+    emit(prev[v], v, next[v]);
+    return triangles;
+}
+
+/// @brief The outline 0, 1, ..., N - 1
+template <size_t N>
+constexpr std::array<int, N> sequence() {
+    std::array<int, N> result{};
+    for (size_t i = 0; i < N; ++i) result[i] = (int)i;
+    return result;
+}
+
+/// @brief Both layouts of Model::appendTriangles: three vertices per triangle, and the points indexed
+///        with a last corner of its own per triangle (a copy of it if every corner is taken)
+template <size_t P, size_t T>
+constexpr TriangleShape<P, T> triangleShape(const std::array<Point, P>& points,
+                                            const std::array<Triangle, T>& triangles) {
+    TriangleShape<P, T> shape;
+    for (size_t t = 0; t < T; ++t) {
+        detail::setVertex(shape.list.positions, t * 3, points[triangles[t].a]);
+        detail::setVertex(shape.list.positions, t * 3 + 1, points[triangles[t].b]);
+        detail::setVertex(shape.list.positions, t * 3 + 2, points[triangles[t].c]);
+    }
+
+    IndexedTriangles<P, T>& indexed = shape.indexed;
+    for (size_t i = 0; i < P; ++i) detail::setVertex(indexed.positions, i, points[i]);
+    indexed.vertices = P;
+
+    std::array<int, P> owner{};
+    std::array<int, T> lastCorner{};
+    for (size_t i = 0; i < P; ++i) owner[i] = -1;
+    for (size_t t = 0; t < T; ++t) lastCorner[t] = -1;
+
+    auto corner = [&](size_t t, int k) {
+        const Triangle& tri = triangles[t];
+        return k == 0 ? tri.a : k == 1 ? tri.b : tri.c;
+    };
+
+    for (size_t t = 0; t < T; ++t) {
+        for (int k = 2; k >= 0 && lastCorner[t] < 0; --k) {
+            if (owner[corner(t, k)] < 0) {
+                owner[corner(t, k)] = (int)t;
+                lastCorner[t] = k;
+            }
+        }
+
+        // all corners taken: try to move one of the owners to another free corner of its own
+        for (int k = 2; k >= 0 && lastCorner[t] < 0; --k) {
+            int other = owner[corner(t, k)];
+            for (int k2 = 2; k2 >= 0; --k2) {
+                if (owner[corner(other, k2)] < 0) {
+                    owner[corner(other, k2)] = other;
+                    lastCorner[other] = k2;
+                    owner[corner(t, k)] = (int)t;
+                    lastCorner[t] = k;
+                    break;
+                }
+            }
+        }
+    }
+
+    for (size_t t = 0; t < T; ++t) {
+        int last = lastCorner[t];
+        if (last < 0) {
+            detail::setVertex(indexed.positions, indexed.vertices, points[triangles[t].c]);
+            indexed.indices[t * 3] = (uint32_t)triangles[t].a;
+            indexed.indices[t * 3 + 1] = (uint32_t)triangles[t].b;
+            indexed.indices[t * 3 + 2] = (uint32_t)indexed.vertices++;
+            continue;
+        }
+
+        // cyclic rotation keeps the winding, so culling in Task8b is unaffected
+        indexed.indices[t * 3] = (uint32_t)corner(t, (last + 1) % 3);
+        indexed.indices[t * 3 + 1] = (uint32_t)corner(t, (last + 2) % 3);
+        indexed.indices[t * 3 + 2] = (uint32_t)corner(t, last);
+    }
+    return shape;
+}
+
+} // namespace ShapeTables
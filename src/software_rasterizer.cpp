@@ -0,0 +1,626 @@
+#include <software_rasterizer.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define RASTER_X86 1
+#include <immintrin.h>
+#endif
+
+// below this a draw is set up by one thread, splitting it costs more than it saves
+static const size_t MIN_PRIMITIVES_PER_THREAD = 1024;
+
+static const uint32_t RESTART_INDEX = 0xFFFFFFFFu;
+
+// GL places vertices on a sub-pixel grid, so does the rasterizer: differences of snapped
+// coordinates are exact, which keeps the edge functions of neighbouring triangles opposite
+static const float SUBPIXELS = 256.0f;
+
+/// @brief lowbias32, the same hash as NgonGenerator::randomColors and vertex_shader.glsl
+static inline uint32_t hash32(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+static glm::vec3 vertexColor(const SoftwareRasterizer::State& state, const float* colors, uint32_t vertex) {
+    if (state.colorSeed != 0) {
+        uint32_t h = hash32(state.colorSeed ^ hash32(vertex));
+        return glm::vec3((float)(h & 0xFFu), (float)((h >> 8) & 0xFFu), (float)((h >> 16) & 0xFFu)) / 255.0f;
+    }
+    return glm::vec3(colors[vertex * 3], colors[vertex * 3 + 1], colors[vertex * 3 + 2]);
+}
+
+static inline uint32_t toUnorm8(float value) {
+    return (uint32_t)std::nearbyint(std::min(1.0f, std::max(0.0f, value)) * 255.0f);
+}
+
+static inline uint32_t packColor(float r, float g, float b, float a) {
+    return toUnorm8(r) | toUnorm8(g) << 8 | toUnorm8(b) << 16 | toUnorm8(a) << 24;
+}
+
+/// @brief 1 - smoothstep(0.5 - fwidth(dist), 0.5, dist) of fragment_shader.glsl, dist in point sizes
+///        from the center and its change per pixel taken as 1 / size
+static inline float pointAlpha(float pixels, float size) {
+    float edgeWidth = 1.0f / size;
+    float distance = pixels * edgeWidth;
+    float t = std::min(1.0f, std::max(0.0f, (distance - (0.5f - edgeWidth)) / edgeWidth));
+    return 1.0f - t * t * (3.0f - (t + t));
+}
+
+SoftwareRasterizer::SoftwareRasterizer(int threads) : pool(threads) {
+    width = 0;
+    height = 0;
+    tilesX = 0;
+    tilesY = 0;
+    verticesPerPrimitive = 1;
+    threadBins.resize(pool.getThreads());
+}
+
+void SoftwareRasterizer::resize(int width, int height) {
+    this->width = std::max(0, width);
+    this->height = std::max(0, height);
+    tilesX = (this->width + TILE_SIZE - 1) / TILE_SIZE;
+    tilesY = (this->height + TILE_SIZE - 1) / TILE_SIZE;
+    pixels.resize((size_t)this->width * this->height);
+    for (Bins& bins : threadBins) {
+        bins.tiles.resize((size_t)tilesX * tilesY);
+    }
+}
+
+void SoftwareRasterizer::clear(glm::vec4 color) {
+    uint32_t value = packColor(color.r, color.g, color.b, color.a);
+    int threads = pool.getThreads();
+    pool.run([&](int thread) {
+        size_t begin = pixels.size() * thread / threads;
+        size_t end = pixels.size() * (thread + 1) / threads;
+        std::fill(pixels.begin() + begin, pixels.begin() + end, value);
+    });
+}
+
+void SoftwareRasterizer::assemble(GLenum mode, size_t first, size_t count, const uint32_t* indices) {
+    assembled.clear();
+    switch (mode) {
+        case GL_POINTS: verticesPerPrimitive = 1; break;
+        case GL_LINES:
+        case GL_LINE_STRIP:
+        case GL_LINE_LOOP: verticesPerPrimitive = 2; break;
+        default: verticesPerPrimitive = 3; break;
+    }
+
+    std::vector<uint32_t>& out = assembled;
+    size_t runStart = 0;
+    while (runStart < count) {
+        // a run ends at a restart index, arrays are one run
+        size_t runEnd = count;
+        if (indices) {
+            runEnd = runStart;
+            while (runEnd < count && indices[first + runEnd] != RESTART_INDEX) runEnd++;
+        }
+
+        size_t n = runEnd - runStart;
+        auto vertex = [&](size_t i) {
+            size_t at = first + runStart + i;
+            return indices ? indices[at] : (uint32_t)at;
+        };
+
+        switch (mode) {
+            case GL_POINTS:
+                for (size_t i = 0; i < n; ++i) out.push_back(vertex(i));
+                break;
+            case GL_LINES:
+                for (size_t i = 0; i + 2 <= n; i += 2) {
+                    out.push_back(vertex(i));
+                    out.push_back(vertex(i + 1));
+                }
+                break;
+            case GL_LINE_STRIP:
+            case GL_LINE_LOOP:
+                for (size_t i = 0; i + 1 < n; ++i) {
+                    out.push_back(vertex(i));
+                    out.push_back(vertex(i + 1));
+                }
+                if (mode == GL_LINE_LOOP && n >= 2) {
+                    out.push_back(vertex(n - 1));
+                    out.push_back(vertex(0));
+                }
+                break;
+            case GL_TRIANGLES:
+                for (size_t i = 0; i + 3 <= n; i += 3) {
+                    out.push_back(vertex(i));
+                    out.push_back(vertex(i + 1));
+                    out.push_back(vertex(i + 2));
+                }
+                break;
+            case GL_TRIANGLE_STRIP:
+                // odd triangles swap their first two corners: same winding, i + 2 stays provoking
+                for (size_t i = 0; i + 3 <= n; ++i) {
+                    out.push_back(vertex(i % 2 ? i + 1 : i));
+                    out.push_back(vertex(i % 2 ? i : i + 1));
+                    out.push_back(vertex(i + 2));
+                }
+                break;
+            case GL_TRIANGLE_FAN:
+                for (size_t i = 1; i + 2 <= n; ++i) {
+                    out.push_back(vertex(0));
+                    out.push_back(vertex(i));
+                    out.push_back(vertex(i + 1));
+                }
+                break;
+        }
+        runStart = runEnd + 1;
+    }
+}
+
+void SoftwareRasterizer::draw(GLenum mode, const State& state, const float* positions, const float* colors,
+                              size_t first, size_t count, const uint32_t* indices) {
+    if (count == 0 || pixels.empty()) return;
+    assemble(mode, first, count, indices);
+    size_t primitives = assembled.size() / verticesPerPrimitive;
+    if (primitives == 0) return;
+
+    int threads = pool.getThreads();
+    int shares = (int)std::min<size_t>((size_t)threads,
+                                       (primitives + MIN_PRIMITIVES_PER_THREAD - 1) / MIN_PRIMITIVES_PER_THREAD);
+    for (int i = 0; i < shares; ++i) {
+        Bins& bins = threadBins[i];
+        bins.primitives.clear();
+        for (std::vector<uint32_t>& tile : bins.tiles) tile.clear();
+        bins.stats = Stats();
+    }
+
+    // contiguous shares: reading the tiles share by share keeps the submission order
+    if (shares == 1) {
+        setup(state, positions, colors, 0, primitives, threadBins[0]);
+    } else {
+        pool.run([&](int thread) {
+            if (thread >= shares) return;
+            size_t begin = primitives * thread / shares;
+            size_t end = primitives * (thread + 1) / shares;
+            setup(state, positions, colors, begin, end, threadBins[thread]);
+        });
+    }
+
+    std::atomic<int> nextTile(0);
+    std::vector<size_t> written(threads, 0);
+    int tiles = tilesX * tilesY;
+    pool.run([&](int thread) {
+        size_t covered = 0;
+        for (int tile = nextTile++; tile < tiles; tile = nextTile++) {
+            for (int share = 0; share < shares; ++share) {
+                const Bins& bins = threadBins[share];
+                for (uint32_t index : bins.tiles[tile]) {
+                    covered += rasterize(bins.primitives[index], tile % tilesX, tile / tilesX);
+                }
+            }
+        }
+        written[thread] = covered;
+    });
+
+    for (int i = 0; i < shares; ++i) {
+        const Stats& s = threadBins[i].stats;
+        stats.triangles += s.triangles;
+        stats.lines += s.lines;
+        stats.points += s.points;
+        stats.culled += s.culled;
+    }
+    for (size_t covered : written) stats.pixels += covered;
+}
+
+// a triangle clipped by the 4 viewport sides
+static const int MAX_CLIPPED = 7;
+
+/// @brief Sutherland-Hodgman clip of a triangle to [0, width] x [0, height], colors interpolated
+///        along the cut edges and new corners snapped like vertices. edges[k] tells whether the edge
+///        from corner k to the next one is a part of the triangle's, false for those along a side.
+/// @return Corners in `polygon`, 0 if nothing is left
+static int clipToViewport(const glm::vec2* corners, const glm::vec3* colors, float width, float height,
+                          glm::vec2* polygon, glm::vec3* polygonColors, bool* edges) {
+    glm::vec2 buffer[MAX_CLIPPED];
+    glm::vec3 bufferColors[MAX_CLIPPED];
+    bool bufferEdges[MAX_CLIPPED];
+    int count = 3;
+    std::copy(corners, corners + 3, polygon);
+    std::copy(colors, colors + 3, polygonColors);
+    std::fill(edges, edges + 3, true);
+
+    for (int side = 0; side < 4 && count > 0; ++side) {
+        int axis = side / 2;
+        float limit = side % 2 == 0 ? 0.0f : (axis == 0 ? width : height);
+        float direction = side % 2 == 0 ? 1.0f : -1.0f; // distance inside is positive
+
+        std::copy(polygon, polygon + count, buffer);
+        std::copy(polygonColors, polygonColors + count, bufferColors);
+        std::copy(edges, edges + count, bufferEdges);
+        int clipped = 0;
+        for (int k = 0; k < count; ++k) {
+            int next = (k + 1) % count;
+            float d0 = (buffer[k][axis] - limit) * direction;
+            float d1 = (buffer[next][axis] - limit) * direction;
+            if (d0 >= 0.0f) {
+                polygon[clipped] = buffer[k];
+                polygonColors[clipped] = bufferColors[k];
+                edges[clipped++] = bufferEdges[k];
+            }
+            if ((d0 >= 0.0f) != (d1 >= 0.0f)) {
+                float t = d0 / (d0 - d1);
+                glm::vec2 p = buffer[k] + (buffer[next] - buffer[k]) * t;
+                p[axis] = limit;
+                polygon[clipped] = glm::vec2(std::nearbyint(p.x * SUBPIXELS), std::nearbyint(p.y * SUBPIXELS)) / SUBPIXELS;
+                polygonColors[clipped] = bufferColors[k] + (bufferColors[next] - bufferColors[k]) * t;
+                edges[clipped++] = d0 < 0.0f && bufferEdges[k]; // leaving, the next edge runs along the side
+            }
+        }
+        count = clipped;
+    }
+    return count;
+}
+
+void SoftwareRasterizer::setup(const State& state, const float* positions, const float* colors,
+                               size_t begin, size_t end, Bins& bins) const {
+    float scaleX = state.view.z * 0.5f * width;
+    float scaleY = state.view.z * 0.5f * height;
+    auto screen = [&](uint32_t vertex) {
+        const float* p = positions + (size_t)vertex * 3;
+        float x = (p[0] - state.view.x) * scaleX + 0.5f * width;
+        float y = (p[1] - state.view.y) * scaleY + 0.5f * height;
+        return glm::vec2(std::nearbyint(x * SUBPIXELS), std::nearbyint(y * SUBPIXELS)) / SUBPIXELS;
+    };
+
+    for (size_t i = begin; i < end; ++i) {
+        const uint32_t* vertices = assembled.data() + i * verticesPerPrimitive;
+
+        if (verticesPerPrimitive == 1) {
+            setupPoint(state, screen(vertices[0]), vertexColor(state, colors, vertices[0]), bins);
+            continue;
+        }
+
+        if (verticesPerPrimitive == 2) {
+            glm::vec3 endColor = vertexColor(state, colors, vertices[1]);
+            glm::vec3 startColor = state.flatShading ? endColor : vertexColor(state, colors, vertices[0]);
+            setupLine(state, screen(vertices[0]), screen(vertices[1]), startColor, endColor, bins);
+            continue;
+        }
+
+        glm::vec2 corners[3] = {screen(vertices[0]), screen(vertices[1]), screen(vertices[2])};
+        glm::vec2 e1 = corners[1] - corners[0];
+        glm::vec2 e2 = corners[2] - corners[0];
+        float area = e1.x * e2.y - e1.y * e2.x;
+        bool front = area > 0.0f;
+        if (area == 0.0f || (state.cullFace == GL_BACK && !front) || (state.cullFace == GL_FRONT && front)) {
+            bins.stats.culled++;
+            continue;
+        }
+
+        glm::vec3 cornerColors[3];
+        cornerColors[2] = vertexColor(state, colors, vertices[2]);
+        for (int k = 0; k < 2; ++k) {
+            cornerColors[k] = state.flatShading ? cornerColors[2] : vertexColor(state, colors, vertices[k]);
+        }
+
+        if (state.polygonMode == GL_FILL) {
+            setupTriangle(corners, cornerColors, bins);
+            continue;
+        }
+
+        // GL clips before the polygon mode applies: corners made by the clip are drawn, edges along
+        // the viewport are not, and a corner is drawn only if the edge starting there is
+        glm::vec2 polygon[MAX_CLIPPED];
+        glm::vec3 polygonColors[MAX_CLIPPED];
+        bool edges[MAX_CLIPPED];
+        int count = clipToViewport(corners, cornerColors, (float)width, (float)height, polygon, polygonColors, edges);
+        for (int k = 0; k < count; ++k) {
+            if (!edges[k]) continue;
+            if (state.polygonMode == GL_LINE) {
+                int next = (k + 1) % count;
+                setupLine(state, polygon[k], polygon[next], polygonColors[k], polygonColors[next], bins);
+            } else {
+                setupPoint(state, polygon[k], polygonColors[k], bins);
+            }
+        }
+    }
+}
+
+/// @brief Edge k from -> to of a counter-clockwise polygon, positive on its left (inside).
+///        Pixel centers exactly on an edge belong to it if it faces right or up: of the two opposite
+///        edges of neighbouring triangles exactly one owns them. Both measure from the same corner,
+///        so their values are exact negations of each other.
+static void setEdge(float* a, float* b, float* x0, float* y0, float* bias, int k,
+                    glm::vec2 from, glm::vec2 to, glm::vec2 origin) {
+    a[k] = from.y - to.y;
+    b[k] = to.x - from.x;
+    x0[k] = origin.x;
+    y0[k] = origin.y;
+    bool owner = a[k] > 0.0f || (a[k] == 0.0f && b[k] > 0.0f);
+    bias[k] = owner ? 0.0f : std::numeric_limits<float>::denorm_min();
+}
+
+static glm::vec2 lowerCorner(glm::vec2 p, glm::vec2 q) {
+    return (p.x < q.x || (p.x == q.x && p.y < q.y)) ? p : q;
+}
+
+void SoftwareRasterizer::setupTriangle(const glm::vec2* corners, const glm::vec3* colors, Bins& bins) const {
+    glm::vec2 p[3] = {corners[0], corners[1], corners[2]};
+    glm::vec3 c[3] = {colors[0], colors[1], colors[2]};
+    glm::vec2 e1 = p[1] - p[0];
+    glm::vec2 e2 = p[2] - p[0];
+    float area = e1.x * e2.y - e1.y * e2.x;
+    if (area < 0.0f) {
+        // clockwise: covered the same way once turned counter-clockwise
+        std::swap(p[1], p[2]);
+        std::swap(c[1], c[2]);
+        area = -area;
+        e1 = p[1] - p[0];
+        e2 = p[2] - p[0];
+    }
+
+    Primitive primitive;
+    primitive.edges = 3;
+    for (int k = 0; k < 3; ++k) {
+        glm::vec2 from = p[k], to = p[(k + 1) % 3];
+        setEdge(primitive.a, primitive.b, primitive.x0, primitive.y0, primitive.bias, k, from, to,
+                lowerCorner(from, to));
+    }
+
+    primitive.colorX = p[0].x;
+    primitive.colorY = p[0].y;
+    for (int i = 0; i < 3; ++i) {
+        float d1 = c[1][i] - c[0][i];
+        float d2 = c[2][i] - c[0][i];
+        primitive.color[i] = c[0][i];
+        primitive.colorDx[i] = (d1 * e2.y - d2 * e1.y) / area;
+        primitive.colorDy[i] = (d2 * e1.x - d1 * e2.x) / area;
+    }
+    primitive.radius = 0.0f;
+
+    bins.stats.triangles++;
+    bin(primitive, std::min(p[0].x, std::min(p[1].x, p[2].x)), std::min(p[0].y, std::min(p[1].y, p[2].y)),
+        std::max(p[0].x, std::max(p[1].x, p[2].x)), std::max(p[0].y, std::max(p[1].y, p[2].y)), bins);
+}
+
+void SoftwareRasterizer::setupLine(const State& state, glm::vec2 start, glm::vec2 end, glm::vec3 startColor,
+                                   glm::vec3 endColor, Bins& bins) const {
+    glm::vec2 direction = end - start;
+    if (direction.x == 0.0f && direction.y == 0.0f) return;
+
+    // clipped to the viewport first as by GL, the end rules below apply at the cut
+    float enter = 0.0f, leave = 1.0f;
+    for (int axis = 0; axis < 2; ++axis) {
+        float size = axis == 0 ? (float)width : (float)height;
+        if (direction[axis] == 0.0f) {
+            if (start[axis] < 0.0f || start[axis] > size) return;
+            continue;
+        }
+        float t0 = -start[axis] / direction[axis];
+        float t1 = (size - start[axis]) / direction[axis];
+        enter = std::max(enter, std::min(t0, t1));
+        leave = std::min(leave, std::max(t0, t1));
+    }
+    if (enter >= leave) return;
+    if (enter > 0.0f || leave < 1.0f) {
+        auto snap = [](glm::vec2 p) {
+            return glm::vec2(std::nearbyint(p.x * SUBPIXELS), std::nearbyint(p.y * SUBPIXELS)) / SUBPIXELS;
+        };
+        glm::vec3 colorChange = endColor - startColor;
+        glm::vec2 clippedStart = snap(start + direction * enter);
+        end = snap(start + direction * leave);
+        start = clippedStart;
+        endColor = startColor + colorChange * leave;
+        startColor += colorChange * enter;
+        direction = end - start;
+        if (direction.x == 0.0f && direction.y == 0.0f) return;
+    }
+
+    // non-antialiased wide lines are parallelograms: lineWidth pixels across the minor axis,
+    // ends perpendicular to the major one; the color changes along the major axis only
+    bool xMajor = std::fabs(direction.x) >= std::fabs(direction.y);
+    int major = xMajor ? 0 : 1;
+    int minor = 1 - major;
+
+    // the columns (rows of a y-major line) are those a thin line fills by the diamond-exit rule:
+    // the start one if the line starts on or before its center or inside its pixel's diamond, the
+    // end one if the line passes its center and does not end inside the diamond; a strip through a
+    // center fills it once
+    auto inDiamond = [](glm::vec2 p) {
+        return std::fabs(p.x - std::floor(p.x) - 0.5f) + std::fabs(p.y - std::floor(p.y) - 0.5f) < 0.5f;
+    };
+    float first = start[major], last = end[major];
+    bool forward = last > first;
+    float firstCenter = std::floor(first) + 0.5f, lastCenter = std::floor(last) + 0.5f;
+    bool drawFirst = (forward ? first <= firstCenter : first >= firstCenter) || inDiamond(start);
+    bool drawLast = (forward ? last > lastCenter : last < lastCenter) && !inDiamond(end);
+    float firstCap = std::floor(first) + (drawFirst == forward ? 0.0f : 1.0f);
+    float lastCap = std::floor(last) + (drawLast == forward ? 1.0f : 0.0f);
+    if (forward ? lastCap <= firstCap : lastCap >= firstCap) return;
+
+    float slope = direction[minor] / direction[major];
+    glm::vec2 from, to;
+    from[major] = firstCap;
+    from[minor] = start[minor] + (firstCap - first) * slope;
+    to[major] = lastCap;
+    to[minor] = start[minor] + (lastCap - first) * slope;
+
+    float half = std::max(1.0f, state.lineWidth) * 0.5f;
+    glm::vec2 side = xMajor ? glm::vec2(0.0f, half) : glm::vec2(-half, 0.0f);
+    if (!forward) side = -side; // counter-clockwise corners
+    glm::vec2 corners[4] = {from - side, to - side, to + side, from + side};
+
+    Primitive primitive;
+    primitive.edges = 4;
+    for (int k = 0; k < 4; ++k) {
+        glm::vec2 from = corners[k], to = corners[(k + 1) % 4];
+        setEdge(primitive.a, primitive.b, primitive.x0, primitive.y0, primitive.bias, k, from, to,
+                lowerCorner(from, to));
+    }
+
+    primitive.colorX = start.x;
+    primitive.colorY = start.y;
+    for (int i = 0; i < 3; ++i) {
+        float change = (endColor[i] - startColor[i]) / direction[major];
+        primitive.color[i] = startColor[i];
+        primitive.colorDx[i] = xMajor ? change : 0.0f;
+        primitive.colorDy[i] = xMajor ? 0.0f : change;
+    }
+    primitive.radius = 0.0f;
+
+    float minX = corners[0].x, minY = corners[0].y, maxX = minX, maxY = minY;
+    for (int k = 1; k < 4; ++k) {
+        minX = std::min(minX, corners[k].x);
+        minY = std::min(minY, corners[k].y);
+        maxX = std::max(maxX, corners[k].x);
+        maxY = std::max(maxY, corners[k].y);
+    }
+    bins.stats.lines++;
+    bin(primitive, minX, minY, maxX, maxY, bins);
+}
+
+void SoftwareRasterizer::setupPoint(const State& state, glm::vec2 center, glm::vec3 color, Bins& bins) const {
+    float size = std::max(1.0f, state.pointSize);
+    float half = size * 0.5f;
+    glm::vec2 corners[4] = {center + glm::vec2(-half, -half), center + glm::vec2(half, -half),
+                            center + glm::vec2(half, half), center + glm::vec2(-half, half)};
+
+    Primitive primitive;
+    primitive.edges = 4;
+    for (int k = 0; k < 4; ++k) {
+        glm::vec2 from = corners[k], to = corners[(k + 1) % 4];
+        setEdge(primitive.a, primitive.b, primitive.x0, primitive.y0, primitive.bias, k, from, to,
+                lowerCorner(from, to));
+    }
+
+    primitive.colorX = center.x;
+    primitive.colorY = center.y;
+    for (int i = 0; i < 3; ++i) {
+        primitive.color[i] = color[i];
+        primitive.colorDx[i] = 0.0f;
+        primitive.colorDy[i] = 0.0f;
+    }
+    primitive.centerX = center.x;
+    primitive.centerY = center.y;
+    primitive.radius = state.roundPoints ? half : 0.0f;
+    primitive.pointSize = size;
+
+    bins.stats.points++;
+    bin(primitive, corners[0].x, corners[0].y, corners[2].x, corners[2].y, bins);
+}
+
+void SoftwareRasterizer::bin(Primitive& primitive, float minX, float minY, float maxX, float maxY,
+                             Bins& bins) const {
+    // pixels whose center may be inside, clamped in float first: off-screen corners can be huge
+    primitive.minX = (int)std::max(0.0f, std::floor(minX));
+    primitive.minY = (int)std::max(0.0f, std::floor(minY));
+    primitive.maxX = (int)std::min((float)width, std::ceil(maxX));
+    primitive.maxY = (int)std::min((float)height, std::ceil(maxY));
+    if (primitive.minX >= primitive.maxX || primitive.minY >= primitive.maxY) return;
+
+    uint32_t index = (uint32_t)bins.primitives.size();
+    bins.primitives.push_back(primitive);
+    for (int ty = primitive.minY / TILE_SIZE; ty <= (primitive.maxY - 1) / TILE_SIZE; ++ty) {
+        for (int tx = primitive.minX / TILE_SIZE; tx <= (primitive.maxX - 1) / TILE_SIZE; ++tx) {
+            bins.tiles[(size_t)ty * tilesX + tx].push_back(index);
+        }
+    }
+}
+
+size_t SoftwareRasterizer::rasterize(const Primitive& p, int tileX, int tileY) {
+    int startX = std::max(p.minX, tileX * TILE_SIZE);
+    int endX = std::min(p.maxX, (tileX + 1) * TILE_SIZE);
+    int startY = std::max(p.minY, tileY * TILE_SIZE);
+    int endY = std::min(p.maxY, (tileY + 1) * TILE_SIZE);
+    bool round = p.radius > 0.0f;
+    float radius2 = p.radius * p.radius;
+    size_t written = 0;
+
+    for (int y = startY; y < endY; ++y) {
+        float py = (float)y + 0.5f;
+        uint32_t* row = pixels.data() + (size_t)y * width;
+
+        float rowTerm[4];
+        for (int k = 0; k < p.edges; ++k) rowTerm[k] = p.b[k] * (py - p.y0[k]);
+        float rowColor[3];
+        for (int i = 0; i < 3; ++i) rowColor[i] = p.color[i] + p.colorDy[i] * (py - p.colorY);
+        float dy = py - p.centerY;
+
+        int x = startX;
+#ifdef RASTER_X86
+        const __m128 lanes = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 scale = _mm_set1_ps(255.0f);
+        for (; x + 4 <= endX; x += 4) {
+            __m128 px = _mm_add_ps(_mm_set1_ps((float)x), lanes);
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (int k = 0; k < p.edges; ++k) {
+                // the same operations as the scalar tail, so the result is bit-identical
+                __m128 e = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.a[k]), _mm_sub_ps(px, _mm_set1_ps(p.x0[k]))),
+                                      _mm_set1_ps(rowTerm[k]));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(e, _mm_set1_ps(p.bias[k])));
+            }
+
+            __m128 alpha = one;
+            if (round) {
+                __m128 dx = _mm_sub_ps(px, _mm_set1_ps(p.centerX));
+                __m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_set1_ps(dy * dy));
+                inside = _mm_and_ps(inside, _mm_cmplt_ps(d2, _mm_set1_ps(radius2)));
+
+                __m128 edgeWidth = _mm_set1_ps(1.0f / p.pointSize);
+                __m128 distance = _mm_mul_ps(_mm_sqrt_ps(d2), edgeWidth);
+                __m128 t = _mm_div_ps(_mm_sub_ps(distance, _mm_sub_ps(_mm_set1_ps(0.5f), edgeWidth)), edgeWidth);
+                t = _mm_min_ps(one, _mm_max_ps(zero, t));
+                __m128 s = _mm_mul_ps(_mm_mul_ps(t, t), _mm_sub_ps(_mm_set1_ps(3.0f), _mm_add_ps(t, t)));
+                alpha = _mm_sub_ps(one, s);
+            }
+
+            int mask = _mm_movemask_ps(inside);
+            if (mask == 0) continue;
+
+            __m128 offset = _mm_sub_ps(px, _mm_set1_ps(p.colorX));
+            __m128i channels[4];
+            for (int i = 0; i < 3; ++i) {
+                __m128 c = _mm_add_ps(_mm_set1_ps(rowColor[i]), _mm_mul_ps(_mm_set1_ps(p.colorDx[i]), offset));
+                c = _mm_min_ps(one, _mm_max_ps(zero, c));
+                channels[i] = _mm_cvtps_epi32(_mm_mul_ps(c, scale));
+            }
+            channels[3] = _mm_cvtps_epi32(_mm_mul_ps(alpha, scale));
+            __m128i color = _mm_or_si128(_mm_or_si128(channels[0], _mm_slli_epi32(channels[1], 8)),
+                                         _mm_or_si128(_mm_slli_epi32(channels[2], 16), _mm_slli_epi32(channels[3], 24)));
+
+            __m128i* out = (__m128i*)(row + x);
+            if (mask != 0xF) {
+                __m128i keep = _mm_castps_si128(inside);
+                color = _mm_or_si128(_mm_and_si128(keep, color), _mm_andnot_si128(keep, _mm_loadu_si128(out)));
+            }
+            _mm_storeu_si128(out, color);
+            written += (size_t)__builtin_popcount(mask);
+        }
+#endif
+        // scalar: the tail, or everything without SSE2
+        for (; x < endX; ++x) {
+            float px = (float)x + 0.5f;
+            bool inside = true;
+            for (int k = 0; k < p.edges; ++k) {
+                float e = p.a[k] * (px - p.x0[k]) + rowTerm[k];
+                inside = inside && e >= p.bias[k];
+            }
+            float alpha = 1.0f;
+            if (round) {
+                float dx = px - p.centerX;
+                float d2 = dx * dx + dy * dy;
+                inside = inside && d2 < radius2;
+                alpha = pointAlpha(std::sqrt(d2), p.pointSize);
+            }
+            if (!inside) continue;
+
+            float offset = px - p.colorX;
+            row[x] = packColor(rowColor[0] + p.colorDx[0] * offset, rowColor[1] + p.colorDx[1] * offset,
+                               rowColor[2] + p.colorDx[2] * offset, alpha);
+            written++;
+        }
+    }
+    return written;
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <GL/glew.h>
+#include <worker_pool.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// @brief CPU rasterizer for the primitives Model draws, for machines without a GPU (see
+///        Model::setSoftwareRasterizer). Needs no GL context, GLenum only names the modes.
+///        A draw is assembled into points, lines and triangles, set up and binned into 64x64 tiles
+///        by every thread on its own share of the primitives, then the tiles are rasterized in
+///        parallel, each by one thread in submission order. Coverage is tested with edge functions
+///        on 4 pixels at once (SSE2), the edge shared by two triangles covers its pixels exactly once.
+class SoftwareRasterizer {
+    public:
+        static const int TILE_SIZE = 64;
+
+        /// @brief Fixed-function state and uniforms of a draw, with the meaning they have in
+        ///        vertex_shader.glsl and fragment_shader.glsl
+        struct State {
+            glm::vec3 view = glm::vec3(0.0f, 0.0f, 1.0f); // u_view: center x, y and zoom
+            float pointSize = 1.0f;
+            float lineWidth = 1.0f;
+            bool flatShading = false;     // FLAT_SHADING: color of the provoking (last) vertex
+            bool roundPoints = false;     // POINT_AA: points cut to a disc, soft edge in alpha
+            GLenum polygonMode = GL_FILL; // GL_POINT, GL_LINE: triangles drawn as corners or edges
+            GLenum cullFace = GL_NONE;    // GL_BACK or GL_FRONT, counter-clockwise triangles face front
+            uint32_t colorSeed = 0;       // u_colorSeed: 0 - the colors array, else hashed from the vertex index
+        };
+
+        /// @brief Work done since the last resetStats
+        struct Stats {
+            size_t triangles = 0; // rasterized, culled ones not counted
+            size_t lines = 0;     // including triangle edges in GL_LINE mode
+            size_t points = 0;
+            size_t culled = 0;    // triangles dropped by cullFace or for having no area
+            size_t pixels = 0;    // written
+        };
+
+        /// @param threads Threads rasterizing, 0 - std::thread::hardware_concurrency
+        SoftwareRasterizer(int threads = 0);
+
+        /// @brief Resizes the color buffer, its contents are undefined until clear
+        void resize(int width, int height);
+
+        void clear(glm::vec4 color);
+
+        /// @brief Draws like glDrawArrays / glDrawElements, with primitive restart at 0xFFFFFFFF
+        /// @param mode GL_POINTS, GL_LINES, GL_LINE_STRIP, GL_LINE_LOOP, GL_TRIANGLES, GL_TRIANGLE_STRIP
+        ///        or GL_TRIANGLE_FAN
+        /// @param positions x, y, z per vertex, z is ignored (no depth test, as in Model)
+        /// @param colors r, g, b per vertex, unused if state.colorSeed != 0
+        /// @param first First vertex, or first index with indices
+        /// @param count Number of vertices or indices
+        /// @param indices nullptr to draw vertices first .. first + count - 1
+        void draw(GLenum mode, const State& state, const float* positions, const float* colors,
+                  size_t first, size_t count, const uint32_t* indices = nullptr);
+
+        /// @brief RGBA8 pixels, rows from the bottom up as returned by glReadPixels
+        const uint32_t* getPixels() const { return pixels.data(); }
+
+        int getWidth() const { return width; }
+        int getHeight() const { return height; }
+        int getThreads() const { return pool.getThreads(); }
+
+        const Stats& getStats() const { return stats; }
+        void resetStats() { stats = Stats(); }
+
+    private:
+        /// @brief Set-up primitive: pixel centers with E >= bias for every edge are covered,
+        ///        E = a * (x - x0) + b * (y - y0)
+        struct Primitive {
+            float a[4], b[4], x0[4], y0[4], bias[4];
+            int edges;
+            float colorX, colorY; // origin of the color planes
+            float color[3], colorDx[3], colorDy[3];
+            float centerX, centerY, radius; // round points, radius 0 otherwise
+            float pointSize;
+            int minX, minY, maxX, maxY; // pixels, max exclusive, inside the color buffer
+        };
+
+        /// @brief Per-thread setup output: primitives of its share and their index per tile
+        struct Bins {
+            std::vector<Primitive> primitives;
+            std::vector<std::vector<uint32_t>> tiles;
+            Stats stats;
+        };
+
+        /// @brief Expands mode, restarts, strips, fans and loops into vertex indices of independent
+        ///        primitives, each ending with its provoking vertex
+        void assemble(GLenum mode, size_t first, size_t count, const uint32_t* indices);
+
+        /// @brief Sets up and bins primitives [begin, end) of `assembled`
+        void setup(const State& state, const float* positions, const float* colors, size_t begin, size_t end,
+                   Bins& bins) const;
+
+        void setupTriangle(const glm::vec2* corners, const glm::vec3* colors, Bins& bins) const;
+        void setupLine(const State& state, glm::vec2 start, glm::vec2 end, glm::vec3 startColor, glm::vec3 endColor,
+                       Bins& bins) const;
+        void setupPoint(const State& state, glm::vec2 center, glm::vec3 color, Bins& bins) const;
+
+        /// @brief Clamps the box to the color buffer, drops empty primitives, files the rest in their tiles
+        void bin(Primitive& primitive, float minX, float minY, float maxX, float maxY, Bins& bins) const;
+
+        /// @brief Writes the pixels of the primitive inside one tile
+        /// @return Pixels written
+        size_t rasterize(const Primitive& primitive, int tileX, int tileY);
+
+        WorkerPool pool;
+        int width, height;
+        int tilesX, tilesY;
+        std::vector<uint32_t> pixels;
+        std::vector<uint32_t> assembled;
+        int verticesPerPrimitive;
+        std::vector<Bins> threadBins;
+        Stats stats;
+};
@@ -0,0 +1,90 @@
+#include <spatial_grid.h>
+#include <algorithm>
+#include <cmath>
+
+SpatialGrid::SpatialGrid() {
+    clear();
+}
+
+void SpatialGrid::clear() {
+    bounds.clear();
+    cellStart.assign(1, 0);
+    cellItems.clear();
+    origin = glm::vec2(0.0f);
+    cellSize = glm::vec2(1.0f);
+    columns = 0;
+    rows = 0;
+}
+
+void SpatialGrid::cellRange(glm::vec4 rect, int& x0, int& y0, int& x1, int& y1) const {
+    x0 = (int)std::floor((rect.x - origin.x) / cellSize.x);
+    y0 = (int)std::floor((rect.y - origin.y) / cellSize.y);
+    x1 = (int)std::floor((rect.z - origin.x) / cellSize.x);
+    y1 = (int)std::floor((rect.w - origin.y) / cellSize.y);
+    x0 = std::max(0, std::min(columns - 1, x0));
+    y0 = std::max(0, std::min(rows - 1, y0));
+    x1 = std::max(0, std::min(columns - 1, x1));
+    y1 = std::max(0, std::min(rows - 1, y1));
+}
+
+void SpatialGrid::build(const std::vector<glm::vec4>& items) {
+    clear();
+    if (items.empty()) return;
+    bounds = items;
+
+    glm::vec2 lo(bounds[0].x, bounds[0].y);
+    glm::vec2 hi(bounds[0].z, bounds[0].w);
+    for (const glm::vec4& b : bounds) {
+        lo = glm::min(lo, glm::vec2(b.x, b.y));
+        hi = glm::max(hi, glm::vec2(b.z, b.w));
+    }
+
+    // about one item per cell for items of similar size, capped so the offsets stay small
+    int side = std::max(1, std::min(1024, (int)std::ceil(std::sqrt((double)bounds.size()))));
+    columns = side;
+    rows = side;
+    origin = lo;
+    cellSize = glm::max((hi - lo) / (float)side, glm::vec2(1e-6f));
+
+    // counting sort into the cells: count, prefix sum, fill
+    cellStart.assign((size_t)columns * rows + 1, 0);
+    int x0, y0, x1, y1;
+    for (const glm::vec4& b : bounds) {
+        cellRange(b, x0, y0, x1, y1);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) cellStart[(size_t)y * columns + x + 1]++;
+        }
+    }
+    for (size_t i = 1; i < cellStart.size(); ++i) cellStart[i] += cellStart[i - 1];
+
+    cellItems.resize(cellStart.back());
+    std::vector<uint32_t> cursor(cellStart.begin(), cellStart.end() - 1);
+    for (size_t i = 0; i < bounds.size(); ++i) {
+        cellRange(bounds[i], x0, y0, x1, y1);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) cellItems[cursor[(size_t)y * columns + x]++] = (uint32_t)i;
+        }
+    }
+}
+
+void SpatialGrid::query(glm::vec4 rect, std::vector<uint32_t>& out) const {
+    out.clear();
+    if (bounds.empty()) return;
+
+    int x0, y0, x1, y1;
+    cellRange(rect, x0, y0, x1, y1);
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+            size_t cell = (size_t)y * columns + x;
+            for (uint32_t k = cellStart[cell]; k < cellStart[cell + 1]; ++k) {
+                const glm::vec4& b = bounds[cellItems[k]];
+                // the clamped range also lists edge cells for a rect outside the grid, test exactly
+                if (b.x <= rect.z && b.z >= rect.x && b.y <= rect.w && b.w >= rect.y) out.push_back(cellItems[k]);
+            }
+        }
+    }
+
+    // an item spanning several cells was found once per cell; ascending keeps the draw order of the file
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// @brief Uniform grid over axis-aligned rectangles (minX, minY, maxX, maxY). An item is listed in
+///        every cell its rectangle touches, the lists are stored back to back (one array of items,
+///        one of offsets per cell), so a query reads a few contiguous ranges and allocates nothing
+///        once its output vector has grown. Built once when the geometry is loaded.
+class SpatialGrid {
+    public:
+        SpatialGrid();
+
+        /// @brief Replaces the grid with one over `bounds`, about sqrt(items) cells per axis
+        void build(const std::vector<glm::vec4>& bounds);
+
+        void clear();
+
+        /// @brief Items whose rectangle intersects `rect` (touching edges count), ascending
+        void query(glm::vec4 rect, std::vector<uint32_t>& out) const;
+
+        size_t size() const { return bounds.size(); }
+        int getColumns() const { return columns; }
+        int getRows() const { return rows; }
+
+    private:
+        /// @brief Cell range covered by a rectangle, clamped to the grid
+        void cellRange(glm::vec4 rect, int& x0, int& y0, int& x1, int& y1) const;
+
+        std::vector<glm::vec4> bounds;
+        std::vector<uint32_t> cellStart; // columns * rows + 1 offsets into cellItems
+        std::vector<uint32_t> cellItems;
+        glm::vec2 origin;
+        glm::vec2 cellSize;
+        int columns, rows;
+};
@@ -0,0 +1,94 @@
+#include <staging_buffer.h>
+
+StagingBuffer::StagingBuffer(int regions) {
+    buffer = 0;
+    data = nullptr;
+    regionSize = 0;
+    fences.assign(regions < 1 ? 1 : regions, (GLsync)0);
+}
+
+StagingBuffer::~StagingBuffer() {
+    release();
+}
+
+void StagingBuffer::release() {
+    for (GLsync& fence : fences) {
+        if (fence) glDeleteSync(fence);
+        fence = 0;
+    }
+    if (buffer != 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glUnmapBuffer(GL_COPY_READ_BUFFER);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glDeleteBuffers(1, &buffer);
+    }
+    buffer = 0;
+    data = nullptr;
+    fallback.clear();
+    regionSize = 0;
+}
+
+void StagingBuffer::reserve(size_t bytes) {
+    if (bytes <= regionSize) return;
+
+    // buffer storage is immutable, growing means a new buffer once the old one is no longer read
+    for (GLsync& fence : fences) {
+        if (fence) glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+    }
+    release();
+
+    size_t size = 1 << 16;
+    while (size < bytes) size *= 2;
+    regionSize = size;
+
+    if (GLEW_ARB_buffer_storage) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glBufferStorage(GL_COPY_READ_BUFFER, regionSize * fences.size(), nullptr, flags);
+        data = (char*)glMapBufferRange(GL_COPY_READ_BUFFER, 0, regionSize * fences.size(), flags);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        if (data != nullptr) return;
+
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+
+    fallback.resize(regionSize * fences.size());
+    data = fallback.data();
+}
+
+bool StagingBuffer::isRegionFree(int region) {
+    GLsync& fence = fences[region];
+    if (!fence) return true;
+
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) return false;
+
+    glDeleteSync(fence);
+    fence = 0;
+    return true;
+}
+
+void StagingBuffer::copy(int region, size_t offset, GLuint destination, size_t size) {
+    if (size == 0) return;
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, destination);
+    if (buffer != 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                            region * regionSize + offset, 0, size);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    } else {
+        glBufferSubData(GL_COPY_WRITE_BUFFER, 0, size, regionData(region) + offset);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void StagingBuffer::fence(int region) {
+    // the fallback copies synchronously, nothing to wait for
+    if (buffer == 0) return;
+
+    if (fences[region]) glDeleteSync(fences[region]);
+    fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstddef>
+#include <vector>
+
+/// @brief Upload memory split into regions used in turn. With GL_ARB_buffer_storage it is one buffer
+///        mapped once (persistent + coherent): any thread may write into a free region without GL
+///        calls, and the GL thread copies it into the destination buffers on the GPU. A fence after
+///        each copy tells when the region may be written again. Without the extension regions are
+///        plain CPU memory uploaded with glBufferSubData.
+class StagingBuffer {
+    public:
+        /// @param regions Number of regions, 2 to write one while the other is being copied
+        StagingBuffer(int regions = 2);
+        ~StagingBuffer();
+
+        /// @brief Grows every region to at least `bytes`, GL thread only. Waits for the copies
+        ///        still in flight, none of the regions may be in use by another thread.
+        void reserve(size_t bytes);
+
+        /// @brief Capacity of one region in bytes, 0 before reserve
+        size_t getRegionSize() const { return regionSize; }
+
+        int getRegions() const { return (int)fences.size(); }
+
+        /// @brief true with a persistently mapped buffer, false for the glBufferSubData fallback
+        bool isPersistent() const { return buffer != 0; }
+
+        /// @brief true once the GPU finished every copy from the region, never waits. GL thread only.
+        bool isRegionFree(int region);
+
+        /// @brief Writable memory of the region, valid until the next reserve
+        char* regionData(int region) { return data + region * regionSize; }
+
+        /// @brief Copies bytes of the region to the start of the destination buffer, GL thread only
+        /// @param region Region holding the data
+        /// @param offset Byte offset inside the region
+        /// @param destination Buffer object with at least `size` bytes
+        /// @param size Bytes to copy
+        void copy(int region, size_t offset, GLuint destination, size_t size);
+
+        /// @brief Marks the end of the copies from the region, isRegionFree turns true when the GPU gets there
+        void fence(int region);
+
+    private:
+        void release();
+
+        GLuint buffer;
+        char* data;                // mapped pointer, or fallback.data()
+        std::vector<char> fallback;
+        size_t regionSize;
+        std::vector<GLsync> fences; // one per region, 0 - nothing in flight
+};
@@ -0,0 +1,383 @@
+#include <stripifier.h>
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+typedef std::unordered_map<uint64_t, int> EdgeMap;
+
+static inline uint64_t edgeKey(uint32_t from, uint32_t to) {
+    return ((uint64_t)from << 32) | to;
+}
+
+/// @brief Directed edge a -> b of every triangle -> that triangle (the first one for non-manifold edges)
+static void buildEdgeMap(const std::vector<uint32_t>& list, EdgeMap& edges) {
+    size_t triangleCount = list.size() / 3;
+    edges.reserve(triangleCount * 3);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        for (int k = 0; k < 3; ++k) {
+            edges.emplace(edgeKey(list[t * 3 + k], list[t * 3 + (k + 1) % 3]), (int)t);
+        }
+    }
+}
+
+/// @brief Third corner of triangle t given two of them
+static inline uint32_t thirdCorner(const std::vector<uint32_t>& list, int t, uint32_t a, uint32_t b) {
+    for (int k = 0; k < 3; ++k) {
+        uint32_t v = list[t * 3 + k];
+        if (v != a && v != b) return v;
+    }
+    return list[t * 3];
+}
+
+static inline int findTriangle(const EdgeMap& edges, uint32_t from, uint32_t to) {
+    EdgeMap::const_iterator it = edges.find(edgeKey(from, to));
+    return it == edges.end() ? -1 : it->second;
+}
+
+/// @brief Vertex count needed to index every corner
+static size_t vertexCountOf(const std::vector<uint32_t>& list) {
+    uint32_t maxIndex = 0;
+    for (uint32_t index : list) maxIndex = std::max(maxIndex, index);
+    return list.empty() ? 0 : (size_t)maxIndex + 1;
+}
+
+Stripifier::Stripifier(int cacheSize) : cacheSize(std::max(4, cacheSize)) {
+}
+
+const char* Stripifier::topologyName(Topology topology) {
+    switch (topology) {
+        case LIST: return "list";
+        case STRIP: return "strip";
+        case FAN: return "fan";
+    }
+    return "unknown";
+}
+
+// ---------------------------------------------------------------- vertex cache reorder
+
+/*
+    Tom Forsyth, "Linear-Speed Vertex Cache Optimisation": every vertex scores by its position in a
+    simulated LRU cache and by how many triangles still use it, the next triangle is the best scoring
+    one among those touching the cache.
+*/
+static float vertexScore(int cachePosition, int valence, int cacheSize) {
+    if (valence == 0) return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            score = 0.75f; // the last triangle's corners, no bonus for being used again at once
+        } else {
+            float scaler = 1.0f - (float)(cachePosition - 3) / (float)(cacheSize - 3);
+            score = std::pow(scaler, 1.5f);
+        }
+    }
+    return score + 2.0f / std::sqrt((float)valence);
+}
+
+void Stripifier::reorderForCache(std::vector<uint32_t>& list) const {
+    int triangleCount = (int)(list.size() / 3);
+    if (triangleCount < 2) return;
+    size_t vertexCount = vertexCountOf(list);
+
+    // triangles of every vertex (CSR), the first valence[v] entries are the ones not emitted yet
+    std::vector<int> offset(vertexCount + 1, 0);
+    for (uint32_t index : list) offset[index + 1]++;
+    for (size_t v = 0; v < vertexCount; ++v) offset[v + 1] += offset[v];
+
+    std::vector<int> vertexTriangles(offset[vertexCount]);
+    std::vector<int> valence(vertexCount, 0);
+    for (int t = 0; t < triangleCount; ++t) {
+        for (int k = 0; k < 3; ++k) {
+            uint32_t v = list[t * 3 + k];
+            vertexTriangles[offset[v] + valence[v]++] = t;
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> score(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) score[v] = vertexScore(-1, valence[v], cacheSize);
+
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<char> emitted(triangleCount, 0);
+    int best = 0;
+    for (int t = 0; t < triangleCount; ++t) {
+        triangleScore[t] = score[list[t * 3]] + score[list[t * 3 + 1]] + score[list[t * 3 + 2]];
+        if (triangleScore[t] > triangleScore[best]) best = t;
+    }
+
+    std::vector<uint32_t> result;
+    result.reserve(list.size());
+    std::vector<uint32_t> cache, nextCache;
+    int cursor = 0;
+
+    for (int i = 0; i < triangleCount; ++i) {
+        if (best < 0) {
+            // nothing in the cache touches a remaining triangle: continue with the next one in order
+            while (emitted[cursor]) ++cursor;
+            best = cursor;
+        }
+
+        emitted[best] = 1;
+        uint32_t corners[3] = {list[best * 3], list[best * 3 + 1], list[best * 3 + 2]};
+        result.insert(result.end(), corners, corners + 3);
+
+        for (uint32_t v : corners) {
+            int* begin = &vertexTriangles[offset[v]];
+            int* end = begin + valence[v];
+            int* found = std::find(begin, end, best);
+            if (found != end) {
+                std::swap(*found, *(end - 1));
+                --valence[v];
+            }
+        }
+
+        // LRU: the corners go to the front, the cache keeps 3 extra entries for the ones pushed out
+        nextCache.assign(corners, corners + 3);
+        for (uint32_t v : cache) {
+            if (v != corners[0] && v != corners[1] && v != corners[2]) nextCache.push_back(v);
+        }
+
+        best = -1;
+        float bestScore = -1.0f;
+        for (size_t p = 0; p < nextCache.size(); ++p) {
+            uint32_t v = nextCache[p];
+            cachePosition[v] = p < (size_t)cacheSize ? (int)p : -1;
+            score[v] = vertexScore(cachePosition[v], valence[v], cacheSize);
+        }
+        for (size_t p = 0; p < nextCache.size(); ++p) {
+            uint32_t v = nextCache[p];
+            for (int j = 0; j < valence[v]; ++j) {
+                int t = vertexTriangles[offset[v] + j];
+                triangleScore[t] = score[list[t * 3]] + score[list[t * 3 + 1]] + score[list[t * 3 + 2]];
+                if (triangleScore[t] > bestScore) {
+                    bestScore = triangleScore[t];
+                    best = t;
+                }
+            }
+        }
+
+        if (nextCache.size() > (size_t)cacheSize + 3) nextCache.resize(cacheSize + 3);
+        cache.swap(nextCache);
+    }
+
+    list.swap(result);
+}
+
+// ---------------------------------------------------------------- strips
+
+/// @brief Appends to strip the triangles that continue it, marking them with mark
+/// @param keepProvoking Only continue with triangles whose new vertex is their last corner in the list
+/// @return Number of triangles in the strip including the first one
+static int extendStrip(const std::vector<uint32_t>& list, const EdgeMap& edges, const std::vector<char>& used,
+                       std::vector<int>& mark, int markValue, bool keepProvoking, std::vector<uint32_t>& strip) {
+    int triangles = 1;
+    for (;;) {
+        // triangle k of a strip is (v[k], v[k+1], v[k+2]) for even k, (v[k+1], v[k], v[k+2]) for odd k
+        size_t k = strip.size() - 2;
+        uint32_t a = strip[k], b = strip[k + 1];
+        int next = (k % 2 == 0) ? findTriangle(edges, a, b) : findTriangle(edges, b, a);
+        if (next < 0 || used[next] || mark[next] == markValue) break;
+
+        // the new vertex is the provoking one of the strip triangle
+        uint32_t v = thirdCorner(list, next, a, b);
+        if (keepProvoking && v != list[next * 3 + 2]) break;
+
+        mark[next] = markValue;
+        strip.push_back(v);
+        ++triangles;
+    }
+    return triangles;
+}
+
+void Stripifier::toStrips(const std::vector<uint32_t>& list, std::vector<uint32_t>& strips, bool keepProvoking) const {
+    strips.clear();
+    int triangleCount = (int)(list.size() / 3);
+
+    EdgeMap edges;
+    buildEdgeMap(list, edges);
+
+    // start with the triangles that have the fewest neighbours, they are the hardest to reach later
+    std::vector<int> neighbours(triangleCount, 0);
+    for (int t = 0; t < triangleCount; ++t) {
+        for (int k = 0; k < 3; ++k) {
+            if (findTriangle(edges, list[t * 3 + (k + 1) % 3], list[t * 3 + k]) >= 0) ++neighbours[t];
+        }
+    }
+    std::vector<int> order(triangleCount);
+    for (int t = 0; t < triangleCount; ++t) order[t] = t;
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return neighbours[a] < neighbours[b]; });
+
+    std::vector<char> used(triangleCount, 0);
+    std::vector<int> mark(triangleCount, -1);
+    std::vector<uint32_t> strip, bestStrip;
+    int markValue = 0;
+
+    for (int start : order) {
+        if (used[start]) continue;
+
+        // try all three rotations of the first triangle, keep the longest strip;
+        // only the source order keeps the last corner provoking
+        int bestLength = 0;
+        int rotations = keepProvoking ? 1 : 3;
+        for (int r = 0; r < rotations; ++r, ++markValue) {
+            strip.clear();
+            for (int k = 0; k < 3; ++k) strip.push_back(list[start * 3 + (r + k) % 3]);
+            mark[start] = markValue;
+
+            int length = extendStrip(list, edges, used, mark, markValue, keepProvoking, strip);
+            if (length > bestLength) {
+                bestLength = length;
+                bestStrip.swap(strip);
+            }
+        }
+
+        // replay the winner to mark its triangles
+        used[start] = 1;
+        for (size_t k = 0; k + 3 < bestStrip.size(); ++k) {
+            uint32_t a = bestStrip[k + 1], b = bestStrip[k + 2];
+            used[(k % 2 == 0) ? findTriangle(edges, b, a) : findTriangle(edges, a, b)] = 1;
+        }
+
+        if (!strips.empty()) strips.push_back(RESTART_INDEX);
+        strips.insert(strips.end(), bestStrip.begin(), bestStrip.end());
+    }
+}
+
+// ---------------------------------------------------------------- fans
+
+void Stripifier::toFans(const std::vector<uint32_t>& list, std::vector<uint32_t>& fans, bool keepProvoking) const {
+    fans.clear();
+    int triangleCount = (int)(list.size() / 3);
+    size_t vertexCount = vertexCountOf(list);
+
+    EdgeMap edges;
+    buildEdgeMap(list, edges);
+
+    std::vector<int> remaining(vertexCount, 0);
+    for (uint32_t index : list) remaining[index]++;
+
+    std::vector<char> used(triangleCount, 0);
+    std::vector<uint32_t> rim;
+
+    auto take = [&](int t) {
+        used[t] = 1;
+        for (int k = 0; k < 3; ++k) remaining[list[t * 3 + k]]--;
+    };
+
+    for (int t = 0; t < triangleCount; ++t) {
+        if (used[t]) continue;
+
+        // the center is the corner with the most triangles left around it; the provoking rim[i + 1]
+        // is the last corner of the first triangle only around its first corner
+        int c = 0;
+        for (int k = 1; k < 3 && !keepProvoking; ++k) {
+            if (remaining[list[t * 3 + k]] > remaining[list[t * 3 + c]]) c = k;
+        }
+        uint32_t center = list[t * 3 + c];
+        uint32_t first = list[t * 3 + (c + 1) % 3];
+        uint32_t last = list[t * 3 + (c + 2) % 3];
+        take(t);
+
+        // fan triangle i is (center, rim[i], rim[i + 1]): forward through edge center -> last,
+        // backward through edge first -> center
+        rim.assign(1, last);
+        for (;;) {
+            int next = findTriangle(edges, center, rim.back());
+            if (next < 0 || used[next]) break;
+            uint32_t v = thirdCorner(list, next, center, rim.back());
+            if (keepProvoking && v != list[next * 3 + 2]) break;
+            take(next);
+            rim.push_back(v);
+        }
+        std::vector<uint32_t> front(1, first);
+        for (;;) {
+            int previous = findTriangle(edges, front.back(), center);
+            if (previous < 0 || used[previous]) break;
+            // the provoking vertex of a triangle added in front is the rim vertex it shares
+            if (keepProvoking && front.back() != list[previous * 3 + 2]) break;
+            take(previous);
+            front.push_back(thirdCorner(list, previous, center, front.back()));
+        }
+
+        if (!fans.empty()) fans.push_back(RESTART_INDEX);
+        fans.push_back(center);
+        fans.insert(fans.end(), front.rbegin(), front.rend());
+        fans.insert(fans.end(), rim.begin(), rim.end());
+    }
+}
+
+// ---------------------------------------------------------------- report
+
+double Stripifier::acmr(const std::vector<uint32_t>& indices, Topology topology) const {
+    size_t vertexCount = 0;
+    for (uint32_t index : indices) {
+        if (index != RESTART_INDEX) vertexCount = std::max(vertexCount, (size_t)index + 1);
+    }
+
+    // FIFO: a vertex stays cached until cacheSize other vertices were loaded after it
+    std::vector<long long> loadedAt(vertexCount, -1);
+    long long misses = 0;
+    size_t triangles = 0;
+    size_t run = 0;
+
+    for (size_t i = 0; i <= indices.size(); ++i) {
+        if (i == indices.size() || indices[i] == RESTART_INDEX) {
+            if (topology != LIST && run >= 3) triangles += run - 2;
+            run = 0;
+            if (i == indices.size()) break;
+            continue;
+        }
+
+        ++run;
+        uint32_t v = indices[i];
+        if (loadedAt[v] < 0 || misses - loadedAt[v] >= cacheSize) {
+            loadedAt[v] = misses++;
+        }
+    }
+    if (topology == LIST) triangles = indices.size() / 3;
+
+    return triangles == 0 ? 0.0 : (double)misses / triangles;
+}
+
+Stripifier::Topology Stripifier::optimize(std::vector<uint32_t>& indices, Report* report, bool keepProvoking) const {
+    std::vector<uint32_t> list = indices;
+    size_t triangles = list.size() / 3;
+    double acmrBefore = report ? acmr(list, LIST) : 0.0;
+
+    reorderForCache(list);
+
+    std::vector<uint32_t> strips, fans;
+    toStrips(list, strips, keepProvoking);
+    toFans(list, fans, keepProvoking);
+
+    Topology chosen = LIST;
+    if (strips.size() < list.size()) chosen = STRIP;
+    if (fans.size() < list.size() && fans.size() < strips.size()) chosen = FAN;
+
+    if (report) {
+        auto verticesPerTriangle = [&](const std::vector<uint32_t>& data) {
+            size_t submitted = data.size() - std::count(data.begin(), data.end(), RESTART_INDEX);
+            return triangles == 0 ? 0.0 : (double)submitted / triangles;
+        };
+
+        report->triangles = triangles;
+        report->listIndices = list.size();
+        report->stripIndices = strips.size();
+        report->fanIndices = fans.size();
+        report->listVerticesPerTriangle = verticesPerTriangle(list);
+        report->stripVerticesPerTriangle = verticesPerTriangle(strips);
+        report->fanVerticesPerTriangle = verticesPerTriangle(fans);
+        report->acmrBefore = acmrBefore;
+        report->listAcmr = acmr(list, LIST);
+        report->stripAcmr = acmr(strips, STRIP);
+        report->fanAcmr = acmr(fans, FAN);
+        report->chosen = chosen;
+        report->provokingKept = keepProvoking;
+    }
+
+    if (chosen == STRIP) indices.swap(strips);
+    else if (chosen == FAN) indices.swap(fans);
+    else indices.swap(list);
+    return chosen;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// @brief Converts indexed triangle lists into triangle strips or fans joined with primitive restart,
+///        reorders lists for the post-transform vertex cache (Forsyth's linear-speed algorithm)
+///        and picks the topology with the fewest indices. Winding is kept in every topology,
+///        so face culling gives the same result as for the source list.
+///        The provoking vertex is not: with GL_LAST_VERTEX_CONVENTION triangle i of a strip or fan
+///        takes its flat color from vertex i + 2, which is any corner of the source triangle. For flat
+///        shading pass keepProvoking, strips and fans then only take triangles whose last list corner
+///        lands there, so they are shorter but every triangle keeps its color.
+class Stripifier {
+    public:
+        enum Topology {
+            LIST,   // GL_TRIANGLES
+            STRIP,  // GL_TRIANGLE_STRIP + primitive restart
+            FAN     // GL_TRIANGLE_FAN + primitive restart
+        };
+
+        /// @brief Separates strips/fans, GL_PRIMITIVE_RESTART_FIXED_INDEX value for GL_UNSIGNED_INT
+        static constexpr uint32_t RESTART_INDEX = 0xFFFFFFFFu;
+
+        /// @brief Vertices submitted per triangle and post-transform cache misses per triangle (ACMR)
+        ///        of every topology for one mesh
+        struct Report {
+            size_t triangles;
+            size_t listIndices, stripIndices, fanIndices;  // restart indices included
+            double listVerticesPerTriangle, stripVerticesPerTriangle, fanVerticesPerTriangle; // restarts excluded
+            double acmrBefore;                 // source list
+            double listAcmr, stripAcmr, fanAcmr; // after the cache reorder / conversion
+            Topology chosen;
+            bool provokingKept;                // built with keepProvoking
+        };
+
+        /// @param cacheSize Post-transform cache size used by the reorder pass and the ACMR simulation
+        Stripifier(int cacheSize = 32);
+
+        /// @brief Reorders the triangles of a list (3 indices each) for the vertex cache, the corners
+        ///        of every triangle keep their order
+        void reorderForCache(std::vector<uint32_t>& list) const;
+
+        /// @brief Greedy strips, each one continued while the next triangle keeps the strip winding
+        /// @param keepProvoking Every triangle keeps its last list corner as the provoking vertex
+        void toStrips(const std::vector<uint32_t>& list, std::vector<uint32_t>& strips, bool keepProvoking = false) const;
+
+        /// @brief Greedy fans around the corner shared by the most remaining triangles
+        /// @param keepProvoking Every triangle keeps its last list corner as the provoking vertex
+        void toFans(const std::vector<uint32_t>& list, std::vector<uint32_t>& fans, bool keepProvoking = false) const;
+
+        /// @brief Cache misses per triangle of indices drawn as topology, FIFO cache of cacheSize
+        double acmr(const std::vector<uint32_t>& indices, Topology topology) const;
+
+        /// @brief Reorders the list, builds strips and fans and replaces indices with the smallest
+        ///        (ties keep the list)
+        /// @param indices Triangle list in, chosen topology out
+        /// @param report Optional, filled with the numbers of every topology
+        /// @param keepProvoking Flat shading: strips and fans keep the provoking vertex of every triangle
+        /// @return Topology now stored in indices
+        Topology optimize(std::vector<uint32_t>& indices, Report* report = nullptr, bool keepProvoking = false) const;
+
+        static const char* topologyName(Topology topology);
+
+    private:
+        int cacheSize;
+};
@@ -0,0 +1,407 @@
+#include <task_generator.h>
+#include <task_shapes.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+/*
+    Fixed shapes of the tasks, computed by the compiler (see shape_tables.h, the triangulated
+    outlines are in task_shapes.h): a task switch copies them into the arena, nothing is
+    triangulated or allocated at run time.
+*/
+
+// the n-gon of Task1/Task2/Task6 when one is drawn, larger counts go through ngonLayout
+static constexpr int TASK_NGON_SIDES = 7;
+static constexpr float TASK_NGON_RADIUS = 0.5f;
+static constexpr auto TASK_NGON_POINTS = ShapeTables::RegularPolygon<TASK_NGON_SIDES>::corners(TASK_NGON_RADIUS);
+static constexpr auto TASK_NGON_LINES = ShapeTables::RegularPolygon<TASK_NGON_SIDES>::lines(TASK_NGON_RADIUS);
+static constexpr auto TASK_NGON_FAN = ShapeTables::RegularPolygon<TASK_NGON_SIDES>::fan(TASK_NGON_RADIUS);
+
+static constexpr auto TASK3_STRIP = ShapeTables::vertices<7>({{
+    {-0.85f, 0.48f},   // 1
+    {-0.623f, -0.26f}, // 2
+    {-0.349f, 0.12f},  // 3
+    {0.075f, 0.12f},   // 4
+    {-0.05f, 0.6f},    // 5
+    {0.740f, 0.6f},    // 6
+    {0.130f, -0.454f}  // 7
+}});
+
+static constexpr auto TASK4_LOOP = ShapeTables::vertices(TASK4_POINTS);
+
+static constexpr auto TASK5_TRIANGLES = ShapeTables::triangleShape(
+    TASK4_POINTS, ShapeTables::earClipping(TASK4_POINTS, TASK4_OUTLINE));
+
+static constexpr auto TASK5_STRIP = ShapeTables::vertices<8>({{
+    {0.7f, 0.8f},        // 2
+    {-0.7f, 0.8f},       // 1
+    {0.2f, 0.5f},        // 3
+    {-0.1358f,0.2985f},  // 4
+    {0.2f, 0.0f},        // 5
+    {-0.6f, -0.4f},      // 6
+    {0.6f, 0.0f},        // 7
+    {0.6f, -0.4f},       // 8
+}});
+
+// two fans, the second one starts at vertex TASK5_SECOND_FAN
+static constexpr int TASK5_SECOND_FAN = 5;
+static constexpr auto TASK5_FANS = ShapeTables::vertices<9>({{
+    {0.2f, 0.0f}, {0.6f, 0.0f}, {0.6f, -0.4f},
+    {-0.6f, -0.4f}, {-0.1358f, 0.2985f},
+    {-0.7f, 0.8f}, {0.7f, 0.8f}, {0.2f, 0.5f}, {0.2f, 0.0f}
+}});
+
+// Task8 draws the Task7 shape too
+static constexpr auto TASK7_TRIANGLES = ShapeTables::triangleShape(
+    TASK7_POINTS, ShapeTables::earClipping(TASK7_POINTS, TASK7_OUTLINE));
+
+static constexpr auto TASK8B_TRIANGLES = ShapeTables::triangleShape(TASK7_POINTS, std::array<ShapeTables::Triangle, 7>{{
+    {0, 1, 2},
+    {0, 2, 7},
+    {7, 3, 2},
+    {3, 5, 6},
+    {3, 6, 7},
+    {1, 2, 8},
+    {2, 8, 4},
+}});
+
+TaskGenerator::Settings::Settings() {
+    indexedGeometry = false;
+    optimizeTopology = false;
+    flatMode = true;
+    ngonCount = 1;
+    gpuColors = false;
+    colorSeedBase = 1;
+}
+
+TaskGenerator::TaskGenerator() {
+    variant = 0;
+    primitive = GL_POINTS;
+    rasterMode = GL_FILL;
+    colorSeed = 0;
+    topologyReport = Stripifier::Report();
+}
+
+int TaskGenerator::variantCount(int task) {
+    if (task == 5) return 3;
+    if (task == 8) return 2;
+    return 1;
+}
+
+// one engine per thread, tasks are also generated on the build thread (Model::setAsyncBuild)
+static std::mt19937& randomEngine() {
+    thread_local std::random_device rd;
+    thread_local std::mt19937 gen(rd());
+    return gen;
+}
+
+static glm::vec3 getRandomColor() {
+    thread_local std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+    std::mt19937& gen = randomEngine();
+
+    return glm::vec3(dis(gen), dis(gen), dis(gen));
+}
+
+/// @brief One draw of the engine behind getRandomColor, seeds NgonGenerator::randomColors
+static unsigned int getRandomSeed() {
+    return randomEngine()();
+}
+
+glm::vec3 TaskGenerator::vertexColor() {
+    return colorSeed != 0 ? glm::vec3(1.0f) : getRandomColor();
+}
+
+void TaskGenerator::generate(int task, int variant, const Settings& settings) {
+    this->settings = settings;
+    this->variant = variant;
+
+    topologyReport = Stripifier::Report();
+    // a seed per task, not per run: the same colors every time; Task1 is white anyway
+    colorSeed = 0;
+    if (settings.gpuColors && task != 1) {
+        colorSeed = std::max(1u, (settings.colorSeedBase + (unsigned int)task) * 0x9E3779B9u);
+    }
+
+    switch (task) {
+        case 1:
+            Task1(7, 0.5f);
+            break;
+        case 2:
+            Task2(7, 0.5f);
+            break;
+        case 3:
+            Task3();
+            break;
+        case 4:
+            Task4();
+            break;
+        case 5:
+            Task5();
+            break;
+        case 6:
+            Task6(7, 0.5f);
+            break;
+        case 7:
+            Task7();
+            break;
+        case 8:
+            Task8();
+            break;
+        case 9:
+            Task8b();
+            break;
+    }
+
+    if (settings.optimizeTopology && primitive == GL_TRIANGLES && !indices.empty()) {
+        applyTopology();
+    }
+}
+
+void TaskGenerator::swapArrays(GeometryBuilder& geometry, std::vector<GLuint>& indices, std::vector<int>& fanOffsets) {
+    std::swap(geometry, this->geometry);
+    std::swap(indices, this->indices);
+    std::swap(fanOffsets, this->fanOffsets);
+}
+
+void TaskGenerator::applyTopology() {
+    // flat colors come from the provoking vertex, strips and fans must keep it per triangle
+    Stripifier::Topology topology = stripifier.optimize(indices, &topologyReport, settings.flatMode);
+    if (topology == Stripifier::STRIP) primitive = GL_TRIANGLE_STRIP;
+    else if (topology == Stripifier::FAN) primitive = GL_TRIANGLE_FAN;
+
+    const Stripifier::Report& r = topologyReport;
+    std::cout << "Topology: " << r.triangles << " triangles, vertices/triangle list " << r.listVerticesPerTriangle
+              << " strip " << r.stripVerticesPerTriangle << " fan " << r.fanVerticesPerTriangle
+              << ", ACMR " << r.acmrBefore << " -> " << r.listAcmr
+              << " -> " << Stripifier::topologyName(topology) << std::endl;
+}
+
+void TaskGenerator::ngonLayout(int count, int instance, float radius, glm::vec2& center, float& scaledRadius) {
+    int columns = (int)std::ceil(std::sqrt((double)count));
+    float cell = 2.0f / columns;
+
+    center.x = -1.0f + cell * (instance % columns + 0.5f);
+    center.y = 1.0f - cell * (instance / columns + 0.5f);
+    scaledRadius = radius * cell * 0.5f;
+}
+
+void TaskGenerator::appendVertices(const float* positions, size_t count) {
+    size_t first = geometry.append(positions, count);
+    for (size_t i = first; i < geometry.size(); ++i) {
+        glm::vec3 color = vertexColor();
+        float* c = geometry.colors(i);
+        c[0] = color.r;
+        c[1] = color.g;
+        c[2] = color.b;
+    }
+}
+
+void TaskGenerator::appendTriangles(const ShapeTables::TriangleView& shape) {
+    if (!settings.indexedGeometry && !settings.optimizeTopology) {
+        appendVertices(shape.list, shape.listVertices);
+        return;
+    }
+
+    GLuint base = (GLuint)geometry.size();
+    appendVertices(shape.indexedPositions, shape.indexedVertices);
+    for (size_t i = 0; i < shape.indexCount; ++i) {
+        indices.push_back(base + shape.indices[i]);
+    }
+}
+
+bool TaskGenerator::isFixedNgon(int n, float radius) const {
+    return settings.ngonCount == 1 && n == TASK_NGON_SIDES && radius == TASK_NGON_RADIUS;
+}
+
+void TaskGenerator::Task1(int n, float radius) {
+    fanOffsets.clear();
+    indices.clear();
+    geometry.clear();
+
+    if (isFixedNgon(n, radius)) {
+        geometry.append(TASK_NGON_POINTS.positions.data(), TASK_NGON_POINTS.count);
+    } else {
+        // pre-sized: the generator writes in place, possibly from several threads
+        geometry.append((size_t)settings.ngonCount * n);
+        for (int k = 0; k < settings.ngonCount; ++k) {
+            glm::vec2 center;
+            float r;
+            ngonLayout(settings.ngonCount, k, radius, center, r);
+
+            ngonGenerator.corners(geometry.positions((size_t)k * n), 3, 0, n, n, center, r);
+        }
+    }
+    std::fill(geometry.colors(), geometry.colors(geometry.size()), 1.0f);
+
+    primitive = GL_POINTS;
+    rasterMode = GL_FILL;
+}
+
+void TaskGenerator::Task2(int n, float radius) {
+    fanOffsets.clear();
+    indices.clear();
+    geometry.clear();
+
+    if (isFixedNgon(n, radius)) {
+        geometry.append(TASK_NGON_LINES.positions.data(), TASK_NGON_LINES.count);
+    } else {
+        geometry.append((size_t)settings.ngonCount * n * 2);
+        for (int k = 0; k < settings.ngonCount; ++k) {
+            glm::vec2 center;
+            float r;
+            ngonLayout(settings.ngonCount, k, radius, center, r);
+
+            // segment i is corner i -> corner i + 1: even vertices start at corner 0, odd ones at corner 1
+            float* polygon = geometry.positions((size_t)k * n * 2);
+            ngonGenerator.corners(polygon, 6, 0, n, n, center, r);
+            ngonGenerator.corners(polygon + 3, 6, 1, n, n, center, r);
+        }
+    }
+
+    if (colorSeed == 0) ngonGenerator.randomColors(geometry.colors(), geometry.size(), getRandomSeed());
+
+    primitive = GL_LINES;
+    rasterMode = GL_FILL;
+}
+
+void TaskGenerator::Task3() {
+    fanOffsets.clear();
+    geometry.clear();
+    indices.clear();
+
+    appendVertices(TASK3_STRIP.positions.data(), TASK3_STRIP.count);
+
+    primitive = GL_LINE_STRIP;
+    rasterMode = GL_FILL;
+}
+
+void TaskGenerator::Task4() {
+    fanOffsets.clear();
+    geometry.clear();
+    indices.clear();
+
+    appendVertices(TASK4_LOOP.positions.data(), TASK4_LOOP.count);
+
+    primitive = GL_LINE_LOOP;
+    rasterMode = GL_FILL;
+}
+
+void TaskGenerator::Task5() {
+    fanOffsets.clear();
+    geometry.clear();
+    indices.clear();
+
+    switch (variant) {
+        case 0: // GL_TRIANGLES
+        {
+            appendTriangles(TASK5_TRIANGLES.view());
+            int vertexCount = geometry.size();
+
+            primitive = GL_TRIANGLES;
+            std::cout << "GL_TRIANGLES("
+                      << vertexCount << " vertex)" << std::endl;
+            break;
+        }
+
+        case 1: // GL_TRIANGLE_STRIP
+        {
+            appendVertices(TASK5_STRIP.positions.data(), TASK5_STRIP.count);
+
+            primitive = GL_TRIANGLE_STRIP;
+            std::cout << "GL_TRIANGLE_STRIP ("
+                    << TASK5_STRIP.count << " vertex)" << std::endl;
+            break;
+        }
+
+        case 2: // GL_TRIANGLE_FAN
+        {
+            fanOffsets.push_back(0);
+            fanOffsets.push_back(TASK5_SECOND_FAN);
+
+            appendVertices(TASK5_FANS.positions.data(), TASK5_FANS.count);
+
+            primitive = GL_TRIANGLE_FAN;
+
+            std::cout << "GL_TRIANGLE_FAN (" << TASK5_FANS.count << " vertex)" << std::endl;
+            break;
+        }
+    }
+
+    rasterMode = GL_FILL;
+}
+
+void TaskGenerator::Task6(int n, float radius) {
+    fanOffsets.clear();
+    indices.clear();
+    geometry.clear();
+
+    if (isFixedNgon(n, radius)) {
+        geometry.append(TASK_NGON_FAN.positions.data(), TASK_NGON_FAN.count);
+    } else {
+        // n + 1 corners per fan: the first one is repeated to close the polygon
+        geometry.append((size_t)settings.ngonCount * (n + 1));
+        for (int k = 0; k < settings.ngonCount; ++k) {
+            glm::vec2 center;
+            float r;
+            ngonLayout(settings.ngonCount, k, radius, center, r);
+
+            // one fan per polygon, drawn through Model's rangeBatch when there are several
+            if (settings.ngonCount > 1) fanOffsets.push_back(k * (n + 1));
+
+            ngonGenerator.corners(geometry.positions((size_t)k * (n + 1)), 3, 0, n + 1, n, center, r);
+        }
+    }
+
+    if (colorSeed == 0) ngonGenerator.randomColors(geometry.colors(), geometry.size(), getRandomSeed());
+
+    primitive = GL_TRIANGLE_FAN;
+    rasterMode = GL_FILL;
+}
+
+void TaskGenerator::Task7() {
+    fanOffsets.clear();
+    geometry.clear();
+    indices.clear();
+
+    appendTriangles(TASK7_TRIANGLES.view());
+
+    primitive = GL_TRIANGLES;
+    rasterMode = GL_FILL;
+}
+
+void TaskGenerator::Task8() {
+    fanOffsets.clear();
+    geometry.clear();
+    indices.clear();
+
+    // the shape of Task7
+    appendTriangles(TASK7_TRIANGLES.view());
+
+    primitive = GL_TRIANGLES;
+
+    switch (variant) {
+        case 0:
+            rasterMode = GL_POINT;
+            std::cout << "8A::GL_POINT" << std::endl;
+            break;
+
+        case 1:
+            rasterMode = GL_LINE;
+            std::cout << "8C::GL_LINE" << std::endl;
+            break;
+    }
+}
+
+void TaskGenerator::Task8b() {
+    fanOffsets.clear();
+    geometry.clear();
+    indices.clear();
+
+    appendTriangles(TASK8B_TRIANGLES.view());
+
+    primitive = GL_TRIANGLES;
+    rasterMode = GL_FILL;
+
+    std::cout << "8B::GL_FILL_AND_GL_LINE" << std::endl;
+}
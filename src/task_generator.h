@@ -0,0 +1,113 @@
+#pragma once
+#include <GL/glew.h>
+#include <vector>
+#include <geometry_builder.h>
+#include <ngon_generator.h>
+#include <shape_tables.h>
+#include <stripifier.h>
+
+/// @brief CPU geometry of the tasks 1..9, no GL calls. Model generates the current task with one on
+///        the GL thread and the async build with another on the worker, both from the same Settings,
+///        then takes the arrays over with swapArrays and uploads them.
+class TaskGenerator {
+    public:
+        /// @brief The Model settings a generated task depends on, handed over as one value so that
+        ///        an async build is generated exactly like a synchronous one
+        struct Settings {
+            Settings();
+
+            bool indexedGeometry;       // Model::setIndexedGeometry
+            bool optimizeTopology;      // Model::setTopologyOptimization
+            bool flatMode;              // strips/fans keep the provoking vertex of every triangle
+            int ngonCount;              // Model::setNgonCount
+            bool gpuColors;             // Model::setGpuColors
+            unsigned int colorSeedBase;
+        };
+
+        TaskGenerator();
+
+        /// @brief Number of variants a task cycles through: the Task5 layouts (TRIANGLES, TRIANGLE_STRIP,
+        ///        TRIANGLE_FAN), the Task8 raster modes (GL_POINT, GL_LINE), 1 for the other tasks
+        static int variantCount(int task);
+
+        /// @brief Replaces the geometry with the given task, the memory of the previous one is reused
+        /// @param task Task number 1..9
+        /// @param variant 0 .. variantCount(task) - 1
+        void generate(int task, int variant, const Settings& settings);
+
+        const GeometryBuilder& getGeometry() const { return geometry; }
+
+        /// @brief Indices of the triangles, empty if the task is drawn without an EBO
+        const std::vector<GLuint>& getIndices() const { return indices; }
+
+        /// @brief First vertex of every fan when a TRIANGLE_FAN task draws more than one
+        const std::vector<int>& getFanOffsets() const { return fanOffsets; }
+
+        /// @brief GL_POINTS .. GL_TRIANGLE_FAN, a strip or fan after the topology optimization
+        GLenum getPrimitive() const { return primitive; }
+
+        /// @brief glPolygonMode of the task
+        GLenum getRasterMode() const { return rasterMode; }
+
+        /// @brief u_colorSeed of the task, 0 - the colors are in the geometry
+        unsigned int getColorSeed() const { return colorSeed; }
+
+        /// @brief Numbers of the triangle list converted by optimizeTopology, all zero otherwise
+        const Stripifier::Report& getTopologyReport() const { return topologyReport; }
+
+        /// @brief Hands the generated arrays to the caller and keeps the caller's ones for the next
+        ///        generate, nothing is copied or allocated
+        void swapArrays(GeometryBuilder& geometry, std::vector<GLuint>& indices, std::vector<int>& fanOffsets);
+
+        /// @brief Grid cell of the k-th of `count` n-gons laid out on a square grid (Model::setNgonCount)
+        /// @param instance Polygon index
+        /// @param radius Radius of a single polygon covering the whole view
+        /// @param center Output center
+        /// @param scaledRadius Output radius fitted to the cell
+        static void ngonLayout(int count, int instance, float radius, glm::vec2& center, float& scaledRadius);
+
+    private:
+        void Task1(int n, float radius);
+        void Task2(int n, float radius);
+        void Task3();
+        void Task4();
+        void Task5();
+        void Task6(int n, float radius);
+        void Task7();
+        void Task8();
+        void Task8b();
+
+        /// @brief Replaces the triangle list in indices with the stripifier's choice, sets primitive
+        void applyTopology();
+
+        /// @brief Appends fixed positions (ShapeTables) with a vertexColor each
+        void appendVertices(const float* positions, size_t count);
+
+        /// @brief Appends a triangulated fixed shape. Expanded mode gives every corner its own color.
+        ///        Indexed mode uploads each point once, with every triangle rotated (keeping its winding)
+        ///        so that its provoking (last) vertex is not shared with another triangle, which keeps
+        ///        one flat color per face; ShapeTables::triangleShape prepared both at compile time.
+        void appendTriangles(const ShapeTables::TriangleView& shape);
+
+        /// @brief true if Task1/Task2/Task6 can copy their n-gon from ShapeTables (one n-gon of the
+        ///        size generate uses)
+        bool isFixedNgon(int n, float radius) const;
+
+        /// @brief Color of a generated vertex: a random one, or white without drawing from the engine
+        ///        when the shader derives the colors (colorSeed != 0)
+        glm::vec3 vertexColor();
+
+        Settings settings; // of the task being generated
+        int variant;
+
+        GeometryBuilder geometry;
+        std::vector<GLuint> indices;
+        std::vector<int> fanOffsets;
+        GLenum primitive;
+        GLenum rasterMode;
+        unsigned int colorSeed;
+        Stripifier::Report topologyReport;
+
+        NgonGenerator ngonGenerator;
+        Stripifier stripifier;
+};
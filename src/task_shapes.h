@@ -0,0 +1,36 @@
+#pragma once
+#include <shape_tables.h>
+#include <array>
+
+/*
+    Outlines of the fixed-shape tasks that are triangulated at compile time (ShapeTables::earClipping).
+    Model builds its tables from them, test_shape_tables checks the tables against Triangulator.
+*/
+
+// the outline of Task4, Task5 fills it
+static constexpr std::array<ShapeTables::Point, 8> TASK4_POINTS = {{
+    {-0.7f, 0.8f},     //1 
+    {0.7f, 0.8f},      //2
+    {0.2f, 0.5f},      //3
+    {0.2f, 0.0f},      //4
+    {0.6f, 0.0f},      //5
+    {0.6f, -0.4f},     //6
+    {-0.6f, -0.4f},    //7
+    {-0.1358f,0.2985f},//8
+}};
+static constexpr std::array<int, 8> TASK4_OUTLINE = ShapeTables::sequence<8>();
+
+static constexpr std::array<ShapeTables::Point, 9> TASK7_POINTS = {{
+    {-0.5f, 0.8f},     // 0 - vertex 1
+    {0.7f, 0.7f},      // 1 - vertex 2  
+    {-0.1f, 0.5f},     // 2 - vertex 3
+    {-0.4f, -0.1f},    // 3 - vertex 4
+    {0.4f, -0.5f},     // 4 - vertex 5
+    {0.1f, -0.2f},     // 5 - vertex 6
+    {-0.1f, -0.6f},    // 6 - vertex 7
+    {-0.8f, 0.0f},     // 7 - vertex 8
+    {0.8f, 0.0f},      // 8 - vertex 9
+}};
+
+// outline of the shape through the points above (1-2-9-5-3-4-6-7-8), Task8 draws it too
+static constexpr std::array<int, 9> TASK7_OUTLINE = {0, 1, 8, 4, 2, 3, 5, 6, 7};
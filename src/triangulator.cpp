@@ -0,0 +1,430 @@
+#include <triangulator.h>
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+/*
+    Both methods work on a counter-clockwise copy of the outline in double precision
+    (P[i] is the i-th corner, id[i] its index in the caller's point table) and emit
+    counter-clockwise triangles; triangulate() flips them back for clockwise input.
+*/
+
+static inline double cross(const glm::dvec2& a, const glm::dvec2& b) {
+    return a.x * b.y - a.y * b.x;
+}
+
+/// @brief > 0 if a, b, c turn left
+static inline double orient(const glm::dvec2& a, const glm::dvec2& b, const glm::dvec2& c) {
+    return cross(b - a, c - b);
+}
+
+static void emitTriangle(const std::vector<glm::dvec2>& P, const std::vector<int>& id,
+                         int a, int b, int c, std::vector<glm::ivec3>& triangles) {
+    if (orient(P[a], P[b], P[c]) < 0.0) std::swap(b, c);
+    triangles.push_back(glm::ivec3(id[a], id[b], id[c]));
+}
+
+// ---------------------------------------------------------------- ear clipping
+
+/// @brief p inside or on the border of the counter-clockwise triangle a, b, c
+static inline bool inTriangle(const glm::dvec2& p, const glm::dvec2& a, const glm::dvec2& b, const glm::dvec2& c) {
+    return orient(a, b, p) >= 0.0 && orient(b, c, p) >= 0.0 && orient(c, a, p) >= 0.0;
+}
+
+static void earClipping(const std::vector<glm::dvec2>& P, const std::vector<int>& id,
+                        std::vector<glm::ivec3>& triangles) {
+    int n = (int)P.size();
+    std::vector<int> prev(n), next(n);
+    for (int i = 0; i < n; ++i) {
+        prev[i] = (i + n - 1) % n;
+        next[i] = (i + 1) % n;
+    }
+
+    int remaining = n;
+    int v = 0;
+    int sinceLastEar = 0;
+
+    while (remaining > 3) {
+        int a = prev[v], c = next[v];
+        bool ear = orient(P[a], P[v], P[c]) > 0.0;
+
+        // only non-convex corners can lie inside a convex corner's triangle
+        for (int p = next[c]; ear && p != a; p = next[p]) {
+            if (orient(P[prev[p]], P[p], P[next[p]]) > 0.0) continue;
+            if (P[p] == P[a] || P[p] == P[v] || P[p] == P[c]) continue;
+            if (inTriangle(P[p], P[a], P[v], P[c])) ear = false;
+        }
+
+        // a full lap without an ear only happens on degenerate input: cut anyway to terminate
+        if (ear || sinceLastEar > remaining) {
+            emitTriangle(P, id, a, v, c, triangles);
+            next[a] = c;
+            prev[c] = a;
+            --remaining;
+            sinceLastEar = 0;
+            v = a;
+        } else {
+            v = c;
+            ++sinceLastEar;
+        }
+    }
+
+    emitTriangle(P, id, prev[v], v, next[v], triangles);
+}
+
+// ---------------------------------------------------------------- monotone partition
+
+/// @brief Sweep order: higher y first, equal y - smaller x first
+static inline bool above(const glm::dvec2& a, const glm::dvec2& b) {
+    return a.y > b.y || (a.y == b.y && a.x < b.x);
+}
+
+enum VertexType { START, END, SPLIT, MERGE, REGULAR };
+
+/// @brief Orders the edges crossed by the sweep line from left to right.
+///        Edge e goes from P[e] to P[e + 1]; QUERY stands for the current sweep point.
+struct SweepLess {
+    static constexpr int QUERY = -1;
+
+    const std::vector<glm::dvec2>* P;
+    const glm::dvec2* sweep;
+
+    double xAt(int e) const {
+        if (e == QUERY) return sweep->x;
+        const glm::dvec2& a = (*P)[e];
+        const glm::dvec2& b = (*P)[(e + 1) % P->size()];
+        if (a.y == b.y) return std::max(std::min(a.x, b.x), std::min(sweep->x, std::max(a.x, b.x)));
+        return a.x + (sweep->y - a.y) * (b.x - a.x) / (b.y - a.y);
+    }
+
+    bool operator()(int e1, int e2) const {
+        double x1 = xAt(e1), x2 = xAt(e2);
+        if (x1 != x2) return x1 < x2;
+        return e1 < e2;
+    }
+};
+
+/// @brief Diagonals that split the counter-clockwise polygon P into y-monotone pieces (de Berg et al., ch. 3)
+static void monotoneDiagonals(const std::vector<glm::dvec2>& P, std::vector<std::pair<int, int>>& diagonals) {
+    int n = (int)P.size();
+
+    std::vector<int> order(n);
+    for (int i = 0; i < n; ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return above(P[a], P[b]); });
+
+    std::vector<VertexType> type(n);
+    for (int i = 0; i < n; ++i) {
+        int p = (i + n - 1) % n, q = (i + 1) % n;
+        bool prevBelow = above(P[i], P[p]);
+        bool nextBelow = above(P[i], P[q]);
+        bool reflex = orient(P[p], P[i], P[q]) < 0.0;
+
+        if (prevBelow && nextBelow) type[i] = reflex ? SPLIT : START;
+        else if (!prevBelow && !nextBelow) type[i] = reflex ? MERGE : END;
+        else type[i] = REGULAR;
+    }
+
+    glm::dvec2 sweep;
+    SweepLess less = {&P, &sweep};
+    typedef std::set<int, SweepLess> Status;
+    Status status(less);
+    std::vector<Status::iterator> where(n, status.end());
+    std::vector<int> helper(n, -1);
+
+    auto insertEdge = [&](int e, int v) {
+        where[e] = status.insert(e).first;
+        helper[e] = v;
+    };
+    auto eraseEdge = [&](int e) {
+        if (where[e] == status.end()) return;
+        status.erase(where[e]);
+        where[e] = status.end();
+    };
+    auto fixUp = [&](int v, int e) {
+        if (e >= 0 && helper[e] >= 0 && type[helper[e]] == MERGE) diagonals.push_back({v, helper[e]});
+    };
+    auto leftEdge = [&]() {
+        Status::iterator it = status.lower_bound(SweepLess::QUERY);
+        return it == status.begin() ? -1 : *--it;
+    };
+
+    for (int v : order) {
+        sweep = P[v];
+        int prevEdge = (v + n - 1) % n;
+
+        switch (type[v]) {
+            case START:
+                insertEdge(v, v);
+                break;
+
+            case END:
+                fixUp(v, prevEdge);
+                eraseEdge(prevEdge);
+                break;
+
+            case SPLIT: {
+                int e = leftEdge();
+                if (e >= 0) {
+                    diagonals.push_back({v, helper[e]});
+                    helper[e] = v;
+                }
+                insertEdge(v, v);
+                break;
+            }
+
+            case MERGE: {
+                fixUp(v, prevEdge);
+                eraseEdge(prevEdge);
+                int e = leftEdge();
+                if (e >= 0) {
+                    fixUp(v, e);
+                    helper[e] = v;
+                }
+                break;
+            }
+
+            case REGULAR:
+                if (above(P[prevEdge], P[v])) {
+                    // left chain, the interior is to the right of v
+                    fixUp(v, prevEdge);
+                    eraseEdge(prevEdge);
+                    insertEdge(v, v);
+                } else {
+                    int e = leftEdge();
+                    if (e >= 0) {
+                        fixUp(v, e);
+                        helper[e] = v;
+                    }
+                }
+                break;
+        }
+    }
+}
+
+/// @brief Triangulates one y-monotone counter-clockwise piece given as indices into P
+static void triangulateMonotone(const std::vector<glm::dvec2>& P, const std::vector<int>& id,
+                                const std::vector<int>& face, std::vector<glm::ivec3>& triangles,
+                                std::vector<int>& sorted, std::vector<char>& leftChain, std::vector<int>& stack) {
+    int k = (int)face.size();
+    if (k == 3) {
+        emitTriangle(P, id, face[0], face[1], face[2], triangles);
+        return;
+    }
+
+    int top = 0, bottom = 0;
+    for (int i = 1; i < k; ++i) {
+        if (above(P[face[i]], P[face[top]])) top = i;
+        if (above(P[face[bottom]], P[face[i]])) bottom = i;
+    }
+
+    // counter-clockwise from the top walks down the left chain, clockwise - down the right one
+    sorted.clear();
+    leftChain.clear();
+    sorted.push_back(face[top]);
+    leftChain.push_back(1);
+    int l = (top + 1) % k, r = (top + k - 1) % k;
+    while (l != bottom || r != bottom) {
+        bool takeLeft = r == bottom || (l != bottom && above(P[face[l]], P[face[r]]));
+        if (takeLeft) {
+            sorted.push_back(face[l]);
+            leftChain.push_back(1);
+            l = (l + 1) % k;
+        } else {
+            sorted.push_back(face[r]);
+            leftChain.push_back(0);
+            r = (r + k - 1) % k;
+        }
+    }
+    sorted.push_back(face[bottom]);
+    leftChain.push_back(0);
+
+    stack.clear();
+    stack.push_back(0);
+    stack.push_back(1);
+
+    for (int j = 2; j < k - 1; ++j) {
+        int u = sorted[j];
+        if (leftChain[j] != leftChain[stack.back()]) {
+            // opposite chain: u sees every vertex on the stack
+            while (stack.size() > 1) {
+                int a = stack.back();
+                stack.pop_back();
+                emitTriangle(P, id, u, sorted[a], sorted[stack.back()], triangles);
+            }
+            stack.clear();
+            stack.push_back(j - 1);
+            stack.push_back(j);
+        } else {
+            int last = stack.back();
+            stack.pop_back();
+            while (!stack.empty()) {
+                const glm::dvec2& pu = P[u];
+                const glm::dvec2& pLast = P[sorted[last]];
+                const glm::dvec2& pTop = P[sorted[stack.back()]];
+                bool inside = leftChain[j] ? orient(pTop, pLast, pu) > 0.0 : orient(pu, pLast, pTop) > 0.0;
+                if (!inside) break;
+
+                emitTriangle(P, id, u, sorted[last], sorted[stack.back()], triangles);
+                last = stack.back();
+                stack.pop_back();
+            }
+            stack.push_back(last);
+            stack.push_back(j);
+        }
+    }
+
+    int u = sorted[k - 1];
+    while (stack.size() > 1) {
+        int a = stack.back();
+        stack.pop_back();
+        emitTriangle(P, id, u, sorted[a], sorted[stack.back()], triangles);
+    }
+}
+
+static void monotone(const std::vector<glm::dvec2>& P, const std::vector<int>& id,
+                     std::vector<glm::ivec3>& triangles) {
+    int n = (int)P.size();
+
+    std::vector<std::pair<int, int>> diagonals;
+    monotoneDiagonals(P, diagonals);
+
+    if (diagonals.empty()) {
+        std::vector<int> face(n), sorted, stack;
+        std::vector<char> leftChain;
+        for (int i = 0; i < n; ++i) face[i] = i;
+        triangulateMonotone(P, id, face, triangles, sorted, leftChain, stack);
+        return;
+    }
+
+    // planar graph of outline edges + diagonals, neighbours of every vertex sorted by angle (CSR)
+    std::vector<int> offset(n + 1, 0);
+    for (int i = 0; i < n; ++i) offset[i + 1] += 2;
+    for (const auto& d : diagonals) {
+        offset[d.first + 1]++;
+        offset[d.second + 1]++;
+    }
+    for (int i = 0; i < n; ++i) offset[i + 1] += offset[i];
+
+    std::vector<int> adjacent(offset[n]);
+    std::vector<int> fill(offset.begin(), offset.end() - 1);
+    for (int i = 0; i < n; ++i) {
+        adjacent[fill[i]++] = (i + 1) % n;
+        adjacent[fill[i]++] = (i + n - 1) % n;
+    }
+    for (const auto& d : diagonals) {
+        adjacent[fill[d.first]++] = d.second;
+        adjacent[fill[d.second]++] = d.first;
+    }
+
+    std::vector<double> angle;
+    for (int v = 0; v < n; ++v) {
+        int begin = offset[v], end = offset[v + 1];
+        if (end - begin == 2) continue; // two neighbours are in cyclic order either way
+        angle.resize(end - begin);
+        for (int s = begin; s < end; ++s) {
+            glm::dvec2 d = P[adjacent[s]] - P[v];
+            angle[s - begin] = std::atan2(d.y, d.x);
+        }
+        std::vector<int> slots(end - begin);
+        for (int s = 0; s < end - begin; ++s) slots[s] = s;
+        std::sort(slots.begin(), slots.end(), [&](int a, int b) { return angle[a] < angle[b]; });
+        std::vector<int> sortedAdjacent(end - begin);
+        for (int s = 0; s < end - begin; ++s) sortedAdjacent[s] = adjacent[begin + slots[s]];
+        std::copy(sortedAdjacent.begin(), sortedAdjacent.end(), adjacent.begin() + begin);
+    }
+
+    // walk every face keeping it on the left; the outer face uses the reversed outline edges
+    std::vector<char> used(offset[n], 0);
+    for (int v = 0; v < n; ++v) {
+        for (int s = offset[v]; s < offset[v + 1]; ++s) {
+            if (adjacent[s] == (v + n - 1) % n) used[s] = 1;
+        }
+    }
+
+    std::vector<int> face, sorted, stack;
+    std::vector<char> leftChain;
+
+    for (int v = 0; v < n; ++v) {
+        for (int s = offset[v]; s < offset[v + 1]; ++s) {
+            if (used[s]) continue;
+
+            face.clear();
+            int from = v, slot = s;
+            while (!used[slot]) {
+                used[slot] = 1;
+                face.push_back(from);
+
+                int to = adjacent[slot];
+                int begin = offset[to], degree = offset[to + 1] - begin;
+                int back = 0;
+                while (adjacent[begin + back] != from) ++back;
+
+                // next edge clockwise after the one we came along
+                slot = begin + (back + degree - 1) % degree;
+                from = to;
+            }
+
+            if (face.size() >= 3) triangulateMonotone(P, id, face, triangles, sorted, leftChain, stack);
+        }
+    }
+}
+
+// ---------------------------------------------------------------- Triangulator
+
+Triangulator::Triangulator(Method method) : method(method) {
+}
+
+Triangulator::Method Triangulator::methodFor(size_t vertexCount) const {
+    if (method != AUTO) return method;
+    return vertexCount <= EAR_CLIPPING_MAX_VERTICES ? EAR_CLIPPING : MONOTONE;
+}
+
+const char* Triangulator::methodName(Method method) {
+    switch (method) {
+        case AUTO: return "auto";
+        case EAR_CLIPPING: return "ear_clipping";
+        case MONOTONE: return "monotone";
+    }
+    return "unknown";
+}
+
+bool Triangulator::triangulate(const std::vector<glm::vec2>& outline, std::vector<glm::ivec3>& triangles) const {
+    std::vector<int> order(outline.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = (int)i;
+    return triangulate(outline, order, triangles);
+}
+
+bool Triangulator::triangulate(const std::vector<glm::vec2>& points, const std::vector<int>& outline,
+                               std::vector<glm::ivec3>& triangles) const {
+    triangles.clear();
+    int n = (int)outline.size();
+    if (n < 3) return false;
+
+    double area = 0.0;
+    for (int i = 0; i < n; ++i) {
+        const glm::vec2& a = points[outline[i]];
+        const glm::vec2& b = points[outline[(i + 1) % n]];
+        area += (double)a.x * b.y - (double)b.x * a.y;
+    }
+    if (area == 0.0) return false;
+
+    bool clockwise = area < 0.0;
+    std::vector<glm::dvec2> P(n);
+    std::vector<int> id(n);
+    for (int i = 0; i < n; ++i) {
+        id[i] = outline[clockwise ? n - 1 - i : i];
+        P[i] = glm::dvec2(points[id[i]]);
+    }
+
+    triangles.reserve(n - 2);
+    if (methodFor(n) == EAR_CLIPPING) {
+        earClipping(P, id, triangles);
+    } else {
+        monotone(P, id, triangles);
+    }
+
+    if (clockwise) {
+        for (auto& tri : triangles) std::swap(tri.y, tri.z);
+    }
+    return true;
+}
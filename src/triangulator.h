@@ -0,0 +1,46 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstddef>
+
+/// @brief Triangulates simple polygons (concave allowed, no holes, no self-intersections).
+///        Small outlines use ear clipping, large ones a y-monotone partition (sweep line)
+///        followed by the linear monotone triangulation, O(n log n) overall.
+///        Triangles keep the winding of the outline.
+class Triangulator {
+    public:
+        enum Method {
+            AUTO,          // EAR_CLIPPING up to EAR_CLIPPING_MAX_VERTICES, MONOTONE above
+            EAR_CLIPPING,  // O(n^2), no extra memory besides the linked list
+            MONOTONE       // O(n log n)
+        };
+
+        // ear clipping is faster than the sweep for outlines up to this size (see bench_triangulate)
+        static constexpr size_t EAR_CLIPPING_MAX_VERTICES = 64;
+
+        Triangulator(Method method = AUTO);
+
+        /// @brief Triangulates the polygon outline[0], outline[1], ...
+        /// @param outline Corners in order, either winding
+        /// @param triangles Receives outline.size() - 2 triangles, indices into outline
+        /// @return false for less than 3 corners or a zero-area outline
+        bool triangulate(const std::vector<glm::vec2>& outline, std::vector<glm::ivec3>& triangles) const;
+
+        /// @brief Triangulates the polygon points[outline[0]], points[outline[1]], ...
+        /// @param points Point table, may contain points that are not on the outline
+        /// @param outline Indices into points, in order, either winding
+        /// @param triangles Receives outline.size() - 2 triangles, indices into points
+        /// @return false for less than 3 corners or a zero-area outline
+        bool triangulate(const std::vector<glm::vec2>& points, const std::vector<int>& outline,
+                         std::vector<glm::ivec3>& triangles) const;
+
+        Method getMethod() const { return method; }
+
+        /// @brief Method actually used for an outline of vertexCount corners
+        Method methodFor(size_t vertexCount) const;
+
+        static const char* methodName(Method method);
+
+    private:
+        Method method;
+};
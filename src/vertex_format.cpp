@@ -0,0 +1,203 @@
+#include <vertex_format.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define VERTEX_FORMAT_X86 1
+#include <immintrin.h>
+#endif
+
+// position first, color at byte 4, as set up by setAttributes
+struct CompactVertex {
+    uint16_t position[2];
+    uint8_t color[4];
+};
+
+static uint32_t floatBits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static float bitsFloat(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/// @brief IEEE half with round to nearest even, the same result as F16C
+static uint16_t floatToHalf(float value) {
+    uint32_t f = floatBits(value);
+    uint32_t sign = f & 0x80000000u;
+    f ^= sign;
+
+    uint32_t half;
+    if (f >= (127u + 16u) << 23) {
+        half = f > (255u << 23) ? 0x7E00u : 0x7C00u; // NaN stays NaN, too large becomes infinity
+    } else if (f < (113u << 23)) {
+        // subnormal: adding 0.5 lines the mantissa up so the FPU does the rounding
+        const float magic = bitsFloat(126u << 23);
+        half = floatBits(bitsFloat(f) + magic) - floatBits(magic);
+    } else {
+        uint32_t mantissaOdd = (f >> 13) & 1;
+        f += ((15u - 127u) << 23) + 0xFFFu;
+        f += mantissaOdd;
+        half = f >> 13;
+    }
+    return (uint16_t)(half | (sign >> 16));
+}
+
+/// @brief Rounds half away from zero like lround, without the libm call
+static uint16_t floatToSnorm16(float value) {
+    float scaled = std::min(1.0f, std::max(-1.0f, value)) * 32767.0f;
+    return (uint16_t)(int16_t)(scaled + std::copysign(0.5f, scaled)); // branchless on random data
+}
+
+static uint8_t floatToUnorm8(float value) {
+    return (uint8_t)(std::min(1.0f, std::max(0.0f, value)) * 255.0f + 0.5f);
+}
+
+#ifdef VERTEX_FORMAT_X86
+/// @brief Two vertices per _mm_cvtps_ph, bit-identical to the scalar path
+__attribute__((target("f16c")))
+static size_t packHalfPositionsF16C(const float* vertices, size_t count, CompactVertex* out) {
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128 xy = _mm_setr_ps(vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 3], vertices[i * 3 + 4]);
+        __m128i halves = _mm_cvtps_ph(xy, _MM_FROUND_TO_NEAREST_INT);
+        uint32_t first = (uint32_t)_mm_cvtsi128_si32(halves);
+        uint32_t second = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(halves, 4));
+        memcpy(out[i].position, &first, sizeof(first));
+        memcpy(out[i + 1].position, &second, sizeof(second));
+    }
+    return i;
+}
+#endif
+
+VertexFormat::Format VertexFormat::resolve(Format format, const float* positions, size_t count) {
+    if (format == FLOAT) return FLOAT;
+
+    bool flat = true;
+    bool unit = true;
+    for (size_t i = 0; i < count * 3; i += 3) {
+        flat = flat && positions[i + 2] == 0.0f;
+        unit = unit && std::fabs(positions[i]) <= 1.0f && std::fabs(positions[i + 1]) <= 1.0f;
+    }
+
+    if (!flat) return FLOAT;
+    if (format == HALF) return HALF;
+    return unit ? SNORM16 : FLOAT; // SNORM16 or AUTO
+}
+
+size_t VertexFormat::stride(Format format, bool colors) {
+    if (format == FLOAT || format == AUTO) return (colors ? 6 : 3) * sizeof(float);
+    return colors ? sizeof(CompactVertex) : sizeof(CompactVertex::position);
+}
+
+void VertexFormat::pack(Format format, const float* positions, const float* colors, size_t count,
+                        void* destination) {
+    if (format == FLOAT || format == AUTO) {
+        float* out = (float*)destination;
+        for (size_t i = 0; i < count; ++i) {
+            *out++ = positions[i * 3];
+            *out++ = positions[i * 3 + 1];
+            *out++ = positions[i * 3 + 2];
+
+            if (colors) {
+                *out++ = colors[i * 3];
+                *out++ = colors[i * 3 + 1];
+                *out++ = colors[i * 3 + 2];
+            } else {
+                *out++ = 1.0f; // R
+                *out++ = 1.0f; // G
+                *out++ = 1.0f; // B
+            }
+        }
+        return;
+    }
+
+    CompactVertex* out = (CompactVertex*)destination;
+    size_t first = 0;
+    if (format == HALF) {
+#ifdef VERTEX_FORMAT_X86
+        if (__builtin_cpu_supports("f16c")) first = packHalfPositionsF16C(positions, count, out);
+#endif
+        for (size_t i = first; i < count; ++i) {
+            out[i].position[0] = floatToHalf(positions[i * 3]);
+            out[i].position[1] = floatToHalf(positions[i * 3 + 1]);
+        }
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            out[i].position[0] = floatToSnorm16(positions[i * 3]);
+            out[i].position[1] = floatToSnorm16(positions[i * 3 + 1]);
+        }
+    }
+
+    size_t colored = colors ? count : 0;
+    for (size_t i = 0; i < colored; ++i) {
+        out[i].color[0] = floatToUnorm8(colors[i * 3]);
+        out[i].color[1] = floatToUnorm8(colors[i * 3 + 1]);
+        out[i].color[2] = floatToUnorm8(colors[i * 3 + 2]);
+        out[i].color[3] = 255;
+    }
+    for (size_t i = colored; i < count; ++i) {
+        memset(out[i].color, 255, sizeof(out[i].color)); // white
+    }
+}
+
+void VertexFormat::packPositions(Format format, const float* positions, size_t count, void* destination) {
+    if (format == FLOAT || format == AUTO) {
+        memcpy(destination, positions, count * 3 * sizeof(float));
+        return;
+    }
+
+    uint16_t* out = (uint16_t*)destination;
+    if (format == HALF) {
+        for (size_t i = 0; i < count; ++i) {
+            out[i * 2] = floatToHalf(positions[i * 3]);
+            out[i * 2 + 1] = floatToHalf(positions[i * 3 + 1]);
+        }
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            out[i * 2] = floatToSnorm16(positions[i * 3]);
+            out[i * 2 + 1] = floatToSnorm16(positions[i * 3 + 1]);
+        }
+    }
+}
+
+void VertexFormat::setAttributes(Format format, bool colors) {
+    GLsizei bytes = (GLsizei)stride(format, colors);
+    switch (format) {
+        case HALF:
+            glVertexAttribPointer(0, 2, GL_HALF_FLOAT, GL_FALSE, bytes, (void*)0);
+            glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, bytes, (void*)offsetof(CompactVertex, color));
+            break;
+        case SNORM16:
+            glVertexAttribPointer(0, 2, GL_SHORT, GL_TRUE, bytes, (void*)0);
+            glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, bytes, (void*)offsetof(CompactVertex, color));
+            break;
+        default:
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, bytes, (void*)0);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, bytes, (void*)(3 * sizeof(float)));
+            break;
+    }
+    glEnableVertexAttribArray(0);
+    if (colors) {
+        glEnableVertexAttribArray(1);
+    } else {
+        glDisableVertexAttribArray(1);
+        glVertexAttrib4f(1, 1.0f, 1.0f, 1.0f, 1.0f);
+    }
+}
+
+const char* VertexFormat::formatName(Format format) {
+    switch (format) {
+        case FLOAT: return "float";
+        case HALF: return "half";
+        case SNORM16: return "snorm16";
+        case AUTO: return "auto";
+    }
+    return "unknown";
+}
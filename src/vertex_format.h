@@ -0,0 +1,48 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstddef>
+
+/// @brief Vertex buffer layouts for the x, y, z / r, g, b vectors the tasks generate.
+///        Every task is 2D (z = 0) in normalized device coordinates with colors in [0, 1], so the
+///        compact formats keep two position components and an RGBA8 color: 8 bytes instead of 24.
+///        vertex_shader.glsl is unchanged, GL fills the missing z with 0 and drops the alpha.
+class VertexFormat {
+    public:
+        enum Format {
+            FLOAT,    // 3 x float position + 3 x float color, 24 bytes (the original layout)
+            HALF,     // 2 x half position + RGBA8 color, 8 bytes, ~1/2048 precision near +-1
+            SNORM16,  // 2 x normalized int16 position + RGBA8 color, 8 bytes, 1/32767 precision in [-1, 1]
+            AUTO      // SNORM16 when every position fits, else FLOAT
+        };
+
+        /// @brief The format used for the vertices: AUTO is resolved, and a compact format that cannot
+        ///        represent them (z != 0, or outside [-1, 1] for SNORM16) falls back to FLOAT
+        /// @param positions x, y, z per vertex
+        /// @param count Number of vertices
+        static Format resolve(Format format, const float* positions, size_t count);
+
+        /// @brief Bytes per vertex, format must be resolved
+        /// @param colors false for the layout of packPositions
+        static size_t stride(Format format, bool colors = true);
+
+        /// @brief Writes vertices in the format
+        /// @param format Resolved format
+        /// @param positions x, y, z per vertex
+        /// @param colors r, g, b per vertex, nullptr for white
+        /// @param count Number of vertices
+        /// @param destination stride(format) bytes per vertex, may be a mapped buffer (written sequentially)
+        static void pack(Format format, const float* positions, const float* colors, size_t count,
+                         void* destination);
+
+        /// @brief Writes positions only, the color comes from the shader (Model::setGpuColors):
+        ///        12 bytes per vertex for FLOAT, 4 for the compact formats
+        static void packPositions(Format format, const float* positions, size_t count, void* destination);
+
+        /// @brief glVertexAttribPointer for locations 0 (position) and 1 (color) of the bound VAO,
+        ///        reading the buffer bound to GL_ARRAY_BUFFER from offset 0
+        /// @param colors false for packPositions buffers: location 1 is disabled and reads the current
+        ///        generic value, which is set to white (context state, not stored in the VAO)
+        static void setAttributes(Format format, bool colors = true);
+
+        static const char* formatName(Format format);
+};
@@ -0,0 +1,65 @@
+#include <worker_pool.h>
+#include <algorithm>
+
+WorkerPool::WorkerPool(int threads) {
+    job = nullptr;
+    generation = 0;
+    running = 0;
+    quit = false;
+
+    if (threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    workers.reserve(threads - 1);
+    for (int i = 1; i < threads; ++i) {
+        workers.emplace_back(&WorkerPool::work, this, i);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void WorkerPool::run(const std::function<void(int thread)>& job) {
+    if (workers.empty()) {
+        job(0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->job = &job;
+        running = (int)workers.size();
+        generation++;
+    }
+    wake.notify_all();
+
+    job(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return running == 0; });
+    this->job = nullptr;
+}
+
+void WorkerPool::work(int thread) {
+    unsigned int seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [&] { return quit || generation != seen; });
+        if (quit) return;
+
+        seen = generation;
+        const std::function<void(int)>* current = job;
+        lock.unlock();
+        (*current)(thread);
+        lock.lock();
+
+        // the mutex orders the job's writes before run() returns
+        if (--running == 0) done.notify_one();
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// @brief Fixed set of threads running one job together, for work split every frame (see
+///        SoftwareRasterizer) where starting threads per call would cost more than the work.
+///        run() hands the job to every worker and runs it on the calling thread as well, the job
+///        splits the work itself (e.g. an atomic counter over tiles). Workers sleep between jobs.
+class WorkerPool {
+    public:
+        /// @param threads Threads running a job including the caller, 0 - std::thread::hardware_concurrency
+        WorkerPool(int threads = 0);
+
+        /// @brief Stops the workers, no job may be running
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        /// @brief Calls job(thread) once on each thread, 0 is the caller, and returns when all finished.
+        ///        Everything the job wrote is visible to the caller afterwards.
+        void run(const std::function<void(int thread)>& job);
+
+        int getThreads() const { return (int)workers.size() + 1; }
+
+    private:
+        void work(int thread);
+
+        std::vector<std::thread> workers;
+        const std::function<void(int)>* job;
+        unsigned int generation; // incremented per run, a worker runs each generation once
+        int running;             // workers still in the current job
+        bool quit;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable done;
+};
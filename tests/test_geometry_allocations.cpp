@@ -0,0 +1,60 @@
+#include <iostream>
+#include <string>
+
+#include <model.h>
+#include <software_rasterizer.h>
+
+/*
+    test_geometry_allocations: task switches reuse the GeometryBuilder arena, no OpenGL needed.
+
+    Generates every task through Model's software backend (Task5 / Task8 in all their variants)
+    once to warm the arena up, then regenerates all of them again and fails if the arena was
+    reallocated. Checked for the list, indexed and strip/fan paths.
+*/
+
+// enough n-gons for Task1/Task2/Task6 to outgrow the initial arena
+static const int NGONS = 64;
+
+// Task5 cycles TRIANGLES -> TRIANGLE_STRIP -> TRIANGLE_FAN, Task8 cycles GL_POINT -> GL_LINE
+static const int VARIANTS[] = {1, 1, 1, 1, 3, 1, 1, 2, 1};
+
+static void generateAll(Model& model) {
+    for (int task = 1; task <= 9; ++task) {
+        for (int variant = 0; variant < VARIANTS[task - 1]; ++variant) model.setCurrentTask(task);
+    }
+}
+
+/// @return false if a pass after the warm-up allocated
+static bool check(const std::string& name, bool indexed, bool topology) {
+    SoftwareRasterizer raster(1);
+    raster.resize(64, 64);
+
+    Model model;
+    model.setSoftwareRasterizer(&raster);
+    model.setIndexedGeometry(indexed);
+    model.setTopologyOptimization(topology);
+    model.setNgonCount(NGONS);
+
+    generateAll(model);
+    size_t warm = model.getGeometryAllocations();
+    for (int pass = 0; pass < 3; ++pass) generateAll(model);
+    size_t after = model.getGeometryAllocations();
+
+    std::cerr << name << ": " << warm << " allocations warming up, " << after - warm << " after" << std::endl;
+    return after == warm;
+}
+
+int main() {
+    // Model prints every mode switch to stdout
+    std::streambuf* old = std::cout.rdbuf(nullptr);
+    bool ok = check("list", false, false);
+    ok = check("indexed", true, false) && ok;
+    ok = check("strips/fans", false, true) && ok;
+    std::cout.rdbuf(old);
+
+    if (!ok) {
+        std::cerr << "FAILED: a task switch reallocated the geometry arena" << std::endl;
+        return 1;
+    }
+    return 0;
+}
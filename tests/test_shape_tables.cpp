@@ -0,0 +1,58 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <task_shapes.h>
+#include <triangulator.h>
+
+/*
+    test_shape_tables: the compile-time ear clipping of ShapeTables gives the triangles Triangulator
+    gives at run time, no OpenGL needed.
+
+    Triangulates every task outline of task_shapes.h with both and fails on the first triangle that
+    differs (same corners in the same order, the tables promise the same triangles in the same order).
+*/
+
+/// @return false if the tables and Triangulator disagree on the outline
+template <size_t N, size_t M>
+static bool check(const std::string& name, const std::array<ShapeTables::Point, N>& points,
+                  const std::array<int, M>& outline) {
+    std::array<ShapeTables::Triangle, M - 2> table = ShapeTables::earClipping(points, outline);
+
+    std::vector<glm::vec2> pointList;
+    for (const ShapeTables::Point& p : points) pointList.push_back(glm::vec2(p.x, p.y));
+    std::vector<int> outlineList(outline.begin(), outline.end());
+    std::vector<glm::ivec3> triangles;
+    // the tasks triangulated with the default method before the tables, ear clipping at this size
+    if (!Triangulator().triangulate(pointList, outlineList, triangles)) {
+        std::cerr << name << ": Triangulator rejected the outline" << std::endl;
+        return false;
+    }
+
+    if (triangles.size() != table.size()) {
+        std::cerr << name << ": " << triangles.size() << " triangles, the table has " << table.size() << std::endl;
+        return false;
+    }
+    for (size_t t = 0; t < table.size(); ++t) {
+        const ShapeTables::Triangle& a = table[t];
+        const glm::ivec3& b = triangles[t];
+        if (a.a != b.x || a.b != b.y || a.c != b.z) {
+            std::cerr << name << ": triangle " << t << " is " << a.a << " " << a.b << " " << a.c
+                      << " in the table, " << b.x << " " << b.y << " " << b.z << " from Triangulator" << std::endl;
+            return false;
+        }
+    }
+    std::cerr << name << ": " << table.size() << " triangles match" << std::endl;
+    return true;
+}
+
+int main() {
+    bool ok = check("task5", TASK4_POINTS, TASK4_OUTLINE);
+    ok = check("task7", TASK7_POINTS, TASK7_OUTLINE) && ok;
+
+    if (!ok) {
+        std::cerr << "FAILED: ShapeTables::earClipping no longer matches Triangulator" << std::endl;
+        return 1;
+    }
+    return 0;
+}
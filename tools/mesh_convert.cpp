@@ -0,0 +1,198 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <geometry_builder.h>
+#include <mesh_file.h>
+#include <triangulator.h>
+#include <vertex_format.h>
+
+/*
+    mesh_convert: text polygons -> .mesh (see MeshFile), no GL context needed.
+
+    Input, one corner per line:
+        x y          corner in normalized device coordinates, white
+        x y r g b    corner with a color in [0, 1]
+    An empty line ends a polygon, '#' starts a comment. Polygons are simple (concave allowed,
+    no holes) and triangulated with Triangulator; corners are shared by their triangles.
+
+    Polygons are packed into chunks of at most --chunk-vertices corners (a larger polygon gets
+    a chunk of its own), the unit MeshStream streams a mesh over its memory budget in.
+
+    Usage: mesh_convert input.txt output.mesh [--format float|half|snorm16|auto] [--chunk-vertices N]
+*/
+
+/// @brief Reads the polygons of the input one at a time
+class PolygonReader {
+    public:
+        PolygonReader(const char* path) : input(path), line(0) {}
+
+        bool isOpen() const { return input.is_open(); }
+
+        /// @brief Next polygon with at least one corner
+        /// @return false at the end of the input or on a malformed line (error set)
+        bool next(std::vector<glm::vec2>& points, std::vector<glm::vec3>& colors) {
+            points.clear();
+            colors.clear();
+
+            std::string text;
+            while (std::getline(input, text)) {
+                line++;
+                size_t comment = text.find('#');
+                if (comment != std::string::npos) text.resize(comment);
+
+                float values[5];
+                int count = 0;
+                const char* cursor = text.c_str();
+                char* end = nullptr;
+                while (count < 5) {
+                    float value = strtof(cursor, &end);
+                    if (end == cursor) break;
+                    values[count++] = value;
+                    cursor = end;
+                }
+                while (*cursor == ' ' || *cursor == '\t' || *cursor == '\r') cursor++;
+
+                if (count == 0 && *cursor == '\0') {
+                    if (!points.empty()) return true; // blank line ends the polygon
+                    continue;
+                }
+                if ((count != 2 && count != 5) || *cursor != '\0') {
+                    error = "line " + std::to_string(line) + ": expected \"x y\" or \"x y r g b\"";
+                    return false;
+                }
+
+                points.push_back(glm::vec2(values[0], values[1]));
+                colors.push_back(count == 5 ? glm::vec3(values[2], values[3], values[4]) : glm::vec3(1.0f));
+            }
+            return !points.empty();
+        }
+
+        const std::string& getError() const { return error; }
+
+    private:
+        std::ifstream input;
+        size_t line;
+        std::string error;
+};
+
+/// @brief Writes the collected polygons as one chunk
+static bool flushChunk(MeshWriter& writer, VertexFormat::Format format, const GeometryBuilder& geometry,
+                       const std::vector<uint32_t>& indices, std::vector<char>& packed) {
+    if (geometry.size() == 0) return true;
+    packed.resize(geometry.size() * VertexFormat::stride(format));
+    VertexFormat::pack(format, geometry.positions(), geometry.colors(), geometry.size(), packed.data());
+
+    const float* positions = geometry.positions();
+    glm::vec2 boundsMin(positions[0], positions[1]);
+    glm::vec2 boundsMax = boundsMin;
+    for (size_t i = 1; i < geometry.size(); ++i) {
+        glm::vec2 point(positions[i * 3], positions[i * 3 + 1]);
+        boundsMin = glm::min(boundsMin, point);
+        boundsMax = glm::max(boundsMax, point);
+    }
+    return writer.addChunk(packed.data(), (uint32_t)geometry.size(), indices.data(), (uint32_t)indices.size(),
+                           boundsMin, boundsMax);
+}
+
+int main(int argc, char** argv) {
+    const char* inputPath = nullptr;
+    const char* outputPath = nullptr;
+    VertexFormat::Format format = VertexFormat::AUTO;
+    size_t chunkVertices = 1 << 16;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--format") && hasValue) {
+            const char* name = argv[++i];
+            if (!strcmp(name, "float")) format = VertexFormat::FLOAT;
+            else if (!strcmp(name, "half")) format = VertexFormat::HALF;
+            else if (!strcmp(name, "snorm16")) format = VertexFormat::SNORM16;
+            else format = VertexFormat::AUTO;
+        } else if (!strcmp(argv[i], "--chunk-vertices") && hasValue) {
+            chunkVertices = (size_t)std::max(3L, atol(argv[++i]));
+        } else if (!inputPath) {
+            inputPath = argv[i];
+        } else if (!outputPath) {
+            outputPath = argv[i];
+        } else {
+            inputPath = nullptr;
+            break;
+        }
+    }
+    if (!inputPath || !outputPath) {
+        std::cerr << "Usage: " << argv[0]
+                  << " input.txt output.mesh [--format float|half|snorm16|auto] [--chunk-vertices N]" << std::endl;
+        return 1;
+    }
+
+    std::vector<glm::vec2> points;
+    std::vector<glm::vec3> colors;
+    GeometryBuilder geometry;
+
+    // first pass: one format for the whole file, a compact one only if every polygon fits it
+    VertexFormat::Format resolved = format;
+    if (format != VertexFormat::FLOAT) {
+        PolygonReader reader(inputPath);
+        resolved = format == VertexFormat::AUTO ? VertexFormat::SNORM16 : format;
+        while (resolved != VertexFormat::FLOAT && reader.next(points, colors)) {
+            geometry.clear();
+            for (size_t i = 0; i < points.size(); ++i) geometry.vertex(points[i], colors[i]);
+            if (VertexFormat::resolve(format, geometry.positions(), geometry.size()) == VertexFormat::FLOAT) {
+                resolved = VertexFormat::FLOAT;
+            }
+        }
+    }
+
+    PolygonReader reader(inputPath);
+    if (!reader.isOpen()) {
+        std::cerr << "Could not open " << inputPath << std::endl;
+        return 1;
+    }
+
+    MeshWriter writer;
+    if (!writer.open(outputPath, resolved, GL_TRIANGLES)) return 1;
+
+    Triangulator triangulator;
+    std::vector<glm::ivec3> triangles;
+    std::vector<uint32_t> indices;
+    std::vector<char> packed;
+    size_t polygons = 0, skipped = 0;
+    geometry.clear();
+
+    while (reader.next(points, colors)) {
+        if (!triangulator.triangulate(points, triangles)) {
+            skipped++; // fewer than 3 corners or no area
+            continue;
+        }
+        polygons++;
+
+        if (geometry.size() > 0 && geometry.size() + points.size() > chunkVertices) {
+            if (!flushChunk(writer, resolved, geometry, indices, packed)) return 1;
+            geometry.clear();
+            indices.clear();
+        }
+
+        uint32_t base = (uint32_t)geometry.size();
+        geometry.reserve(points.size());
+        for (size_t i = 0; i < points.size(); ++i) geometry.vertex(points[i], colors[i]);
+        for (const glm::ivec3& triangle : triangles) {
+            indices.push_back(base + triangle.x);
+            indices.push_back(base + triangle.y);
+            indices.push_back(base + triangle.z);
+        }
+    }
+    if (!reader.getError().empty()) {
+        std::cerr << inputPath << ", " << reader.getError() << std::endl;
+        return 1;
+    }
+    if (!flushChunk(writer, resolved, geometry, indices, packed) || !writer.finish()) return 1;
+
+    std::cout << outputPath << ": " << polygons << " polygons (" << skipped << " skipped), "
+              << writer.getVertexCount() << " vertices, " << writer.getIndexCount() / 3 << " triangles, "
+              << VertexFormat::formatName(resolved) << std::endl;
+    return 0;
+}